@@ -85,7 +85,7 @@ LD_FLAGS_COMMON = -L $(LIB_DIR)
 LD_DEBUG_FLAGS =
 LD_RELEASE_FLAGS =
 
-LD_LIBS = -l$(LIB_NAME) -lpthread
+LD_LIBS = -l$(LIB_NAME) -lpthread -lrt
 
 # Full link flags
 ifeq ($(BUILD_CONFIG),release)
@@ -0,0 +1,129 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file append_only_vector.h
+/// @brief Segmented sequence whose elements never move once appended.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Defines a class template for a sequence that is appended to by a single
+/// thread while other threads read elements that have already been made
+/// visible to them by other means (e.g. a release-store / acquire-load of a
+/// published element count). Unlike std::vector, appending never reallocates
+/// or moves existing elements and never changes any state read when accessing
+/// existing elements.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_APPEND_ONLY_VECTOR_H
+# define DIBASE_BLOG_SIES_APPEND_ONLY_VECTOR_H
+# include <cstddef>
+# include <new>
+# include <stdexcept>
+# include <utility>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Append only sequence stored in segments of doubling capacity.
+  ///
+  /// Segment k holds FirstSegmentSize*2^k elements. The table of segment
+  /// pointers has a fixed size so is never reallocated. Only push_back
+  /// modifies the object; element access for indexes that are known to be
+  /// less than the size at some earlier, suitably synchronised, point may
+  /// be made concurrently with push_back.
+  ///
+  /// @param T                  Element type.
+  /// @param FirstSegmentLog2   log2 of number of elements in first segment.
+    template <typename T, unsigned FirstSegmentLog2=4U>
+    class append_only_vector
+    {
+    public:
+      typedef std::size_t size_type;
+
+    private:
+      static size_type const FirstSegmentSize = size_type{1U}<<FirstSegmentLog2;
+      static unsigned const  MaxSegments = sizeof(size_type)*8U
+                                         - FirstSegmentLog2;
+
+      T *       segments[MaxSegments];
+      size_type count;
+
+    /// @brief Helper: 0-based index of most significant set bit of value.
+      static unsigned msb(size_type value)
+      {
+        unsigned bit{0U};
+        while (value>>=1U)
+          {
+            ++bit;
+          }
+        return bit;
+      }
+
+    /// @brief Helper: locate element given its sequence index.
+      T * locate(size_type index) const
+      {
+        auto biased(index + FirstSegmentSize);
+        auto top_bit(msb(biased));
+        return segments[top_bit-FirstSegmentLog2]
+             + (biased - (size_type{1U}<<top_bit));
+      }
+
+    public:
+      append_only_vector()
+      : count{0U}
+      {
+        for (auto & seg : segments)
+          {
+            seg = nullptr;
+          }
+      }
+
+      append_only_vector(append_only_vector const &) = delete;
+      append_only_vector & operator=(append_only_vector const &) = delete;
+      append_only_vector(append_only_vector &&) = delete;
+      append_only_vector & operator=(append_only_vector &&) = delete;
+
+    /// @brief Destructor: destroy all elements and release segments.
+      ~append_only_vector()
+      {
+        for (size_type i{0U}; i!=count; ++i)
+          {
+            locate(i)->~T();
+          }
+        for (auto seg : segments)
+          {
+            ::operator delete(seg);
+          }
+      }
+
+    /// @brief Append element, allocating a new segment if required.
+    /// Must only be called by one thread at a time. Existing elements are
+    /// not moved.
+    /// @param value  Value to move into the new last element.
+      void push_back(T && value)
+      {
+        auto biased(count + FirstSegmentSize);
+        auto top_bit(msb(biased));
+        auto & seg(segments[top_bit-FirstSegmentLog2]);
+        if (seg==nullptr)
+          {
+            seg = static_cast<T*>
+                  (::operator new(sizeof(T)*(size_type{1U}<<top_bit)));
+          }
+        new (seg + (biased - (size_type{1U}<<top_bit))) T(std::move(value));
+        ++count;
+      }
+
+    /// @brief Number of elements appended. Not synchronised - only valid
+    /// on the appending thread.
+      size_type size() const { return count; }
+
+    /// @brief Unchecked element access.
+      T const & operator[](size_type index) const { return *locate(index); }
+      T & operator[](size_type index) { return *locate(index); }
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_APPEND_ONLY_VECTOR_H
@@ -0,0 +1,260 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file occtablebench.cpp
+/// @brief Compares text_info occurrence table policies.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Builds a text_info using each occurrence table policy from the same
+/// corpus - either one chunk per file named on the command line or a random
+/// corpus - and reports for each:
+///   - build time: time to add all the corpus's chunks,
+///   - lookup time: mean time per chunk word, chunk character and corpus
+///     word occurrence query, for a query mix of words present in the
+///     queried chunk and words absent from it,
+///   - memory: bytes allocated for, and still in use by, the text_info once
+///     built, measured by building it a second time using a counting
+///     allocator.
+///
+/// Usage: occtablebench [lookups [file...]]
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "text_info.h"
+#include "occurrence_tables.h"
+#include "rnd_text_info_maker.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+using namespace dibase::blog::sies;
+
+typedef std::chrono::steady_clock clock_type;
+
+auto const DefaultLookups(1000000U);
+auto const RandomTextChunks(1000U);
+auto const MinWordsPerChunk(200U);
+auto const MaxWordsPerChunk(2000U);
+auto const MinWordSize(1U);
+auto const MaxWordSize(9U);
+auto const CorpusLookupDivisor(100U); // corpus queries visit every chunk
+
+/// @brief Bytes allocated by counting_allocators and not yet deallocated.
+std::size_t live_bytes{0U};
+
+/// @brief Heap allocator keeping count of the bytes it has allocated and
+/// not yet deallocated in live_bytes.
+template <typename T>
+struct counting_allocator
+{
+  typedef T value_type;
+
+  counting_allocator() = default;
+
+  template <typename U>
+  counting_allocator(counting_allocator<U> const &) {}
+
+  T * allocate(std::size_t n)
+  {
+    live_bytes += n*sizeof(T);
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T * p, std::size_t n)
+  {
+    live_bytes -= n*sizeof(T);
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(counting_allocator<U> const &) const { return true; }
+
+  template <typename U>
+  bool operator!=(counting_allocator<U> const &) const { return false; }
+};
+
+/// @brief A query against one chunk.
+struct query
+{
+  std::size_t chunk_index;
+  std::string word;
+  char        chr;
+};
+
+std::vector<std::string> read_corpus(std::vector<std::string> const & files)
+{
+  std::vector<std::string> chunks;
+  if (files.empty())
+    {
+      rnd_text_info_maker make_rnd_text_info( RandomTextChunks,RandomTextChunks
+                                            , MinWordsPerChunk,MaxWordsPerChunk
+                                            , MinWordSize,MaxWordSize
+                                            );
+      auto pti(make_rnd_text_info());
+      for (auto i=0U; i!=pti->number_of_chunks(); ++i)
+        {
+          chunks.push_back(pti->chunk_text(i));
+        }
+    }
+  for (auto const & file : files)
+    {
+      std::ifstream in{file.c_str(), std::ios::binary};
+      if (!in)
+        {
+          throw std::runtime_error{"Unable to read " + file};
+        }
+      std::ostringstream chunk;
+      chunk << in.rdbuf();
+      chunks.push_back(chunk.str());
+    }
+  return chunks;
+}
+
+/// @brief Make queries: half for words in the queried chunk, half for words
+/// in some other chunk, which are mostly absent from the queried chunk.
+std::vector<query> make_queries
+( std::vector<std::string> const & chunks
+, unsigned lookups
+)
+{
+  text_info ti;
+  for (auto const & c : chunks)
+    {
+      ti.add_text_chunk(c);
+    }
+  std::vector<std::vector<std::string>> chunk_words(chunks.size());
+  for (std::size_t i{0U}; i!=chunks.size(); ++i)
+    {
+      for (auto const & w : ti.chunk_data(i).word_occ_map)
+        {
+          chunk_words[i].push_back(w.first.str());
+        }
+      if (chunk_words[i].empty())
+        {
+          chunk_words[i].push_back("absent");
+        }
+    }
+  std::minstd_rand rnd;
+  std::uniform_int_distribution<std::size_t> pick_chunk(0U, chunks.size()-1U);
+  std::vector<query> queries;
+  queries.reserve(lookups);
+  for (auto q=0U; q!=lookups; ++q)
+    {
+      auto chunk_index(pick_chunk(rnd));
+      auto const & words(chunk_words[q%2U ? chunk_index : pick_chunk(rnd)]);
+      std::uniform_int_distribution<std::size_t> pick_word(0U, words.size()-1U);
+      auto const & word(words[pick_word(rnd)]);
+      queries.push_back(query{chunk_index, word, word[q%word.size()]});
+    }
+  return queries;
+}
+
+double elapsed_ns(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::nano>(clock_type::now()-start).count();
+}
+
+template <class Tables>
+void run
+( char const * name
+, std::vector<std::string> const & chunks
+, std::vector<query> const & queries
+)
+{
+  typedef basic_text_info<default_counter_widths, std::allocator<char>, Tables>
+                                                              heap_text_info;
+  typedef basic_text_info<default_counter_widths, counting_allocator<char>, Tables>
+                                                              counted_text_info;
+  auto start(clock_type::now());
+  heap_text_info ti;
+  for (auto const & c : chunks)
+    {
+      ti.add_text_chunk(c);
+    }
+  auto build_ms(elapsed_ns(start)/1e6);
+
+  std::uint64_t checksum{0U};
+  start = clock_type::now();
+  for (auto const & q : queries)
+    {
+      checksum += ti.chunk_word_occurrence(q.chunk_index, q.word);
+    }
+  auto chunk_word_ns(elapsed_ns(start)/queries.size());
+
+  start = clock_type::now();
+  for (auto const & q : queries)
+    {
+      checksum += ti.chunk_char_occurrence(q.chunk_index, q.chr);
+    }
+  auto chunk_char_ns(elapsed_ns(start)/queries.size());
+
+  auto corpus_queries(std::max<std::size_t>(1U, queries.size()/CorpusLookupDivisor));
+  start = clock_type::now();
+  for (std::size_t q{0U}; q!=corpus_queries; ++q)
+    {
+      checksum += ti.word_occurrence(queries[q].word);
+    }
+  auto corpus_word_ns(elapsed_ns(start)/corpus_queries);
+
+  std::size_t memory_bytes;
+  {
+    auto before(live_bytes);
+    counted_text_info counted_ti;
+    for (auto const & c : chunks)
+      {
+        counted_ti.add_text_chunk(c);
+      }
+    memory_bytes = live_bytes-before;
+  }
+
+  std::cout << std::left << std::setw(15) << name << std::right << std::fixed
+            << std::setprecision(1)
+            << std::setw(10) << build_ms
+            << std::setw(12) << chunk_word_ns
+            << std::setw(12) << chunk_char_ns
+            << std::setw(14) << corpus_word_ns
+            << std::setw(14) << memory_bytes/1024U
+            << "   (" << checksum << ")\n";
+}
+
+int main(int argc, char * argv[])
+{
+  try
+    {
+      unsigned lookups(argc>1 ? std::atoi(argv[1]) : DefaultLookups);
+      auto chunks(read_corpus(std::vector<std::string>(argv+std::min(argc,2), argv+argc)));
+      if (chunks.empty() || lookups==0U)
+        {
+          std::cerr << "Usage: " << argv[0] << " [lookups [file...]]\n";
+          return 2;
+        }
+      auto queries(make_queries(chunks, lookups));
+      std::uint64_t corpus_size{0U};
+      for (auto const & c : chunks)
+        {
+          corpus_size += c.size();
+        }
+      std::cout << "corpus: " << chunks.size() << " chunks, " << corpus_size
+                << " characters; " << queries.size() << " lookups\n"
+                << "policy           build ms  chunk word  chunk char   corpus word"
+                   "     memory KB\n"
+                << "                             ns/lookup   ns/lookup     ns/lookup"
+                   "\n";
+      run<map_occurrence_tables>("map", chunks, queries);
+      run<sorted_vector_occurrence_tables>("sorted vector", chunks, queries);
+      run<hash_occurrence_tables>("hash", chunks, queries);
+    }
+  catch (std::exception & e)
+    {
+      std::cerr << "occtablebench: " << e.what() << '\n';
+      return 1;
+    }
+}
@@ -0,0 +1,471 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file textqueryd.cpp
+/// @brief Local query daemon serving a published text_registry.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Builds a text_registry - either one chunk per file named on the command
+/// line or a random corpus - publishes it and answers query_protocol requests
+/// received over a Unix domain socket. A single thread runs an epoll driven
+/// event loop: each time a connection is readable every complete request
+/// received is executed and all the responses written back as one batch.
+/// A connection whose client does not read its responses stops being read
+/// from, and its requests stop being executed, while its unsent responses
+/// exceed MaxPendingOutput bytes.
+///
+/// Sending SIGHUP rebuilds the registry on a separate thread, the current
+/// version being served meanwhile, and publishes the new version once built.
+/// If the rebuild fails the failure is logged and the current version is
+/// kept. SIGINT or SIGTERM shut the daemon down.
+///
+/// Usage: textqueryd socket-path [file...]
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "text_registry.h"
+#include "atomic-policies.h"
+#include "publication_holder.h"
+#include "query_protocol.h"
+#include "rnd_text_info_maker.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <future>
+#include <stdexcept>
+#include <cstdint>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace dibase::blog::sies;
+
+typedef text_registry
+        < atomic
+        , std::memory_order_release
+        , std::memory_order_acquire >             text_registry_type;
+typedef publication_holder<text_registry_type>    registry_holder;
+
+auto const RandomTextChunks(1000U);
+auto const RandomWordsPerChunk(500U);
+auto const MinWordSize(2U);
+auto const MaxWordSize(7U);
+auto const ReadBlockSize(64U*1024U);
+auto const MaxEvents(64);
+auto const MaxPendingInput(16U*query_protocol::MaxRequestLength);
+auto const MaxPendingOutput(1024U*1024U);
+
+/// @brief Returns the signals the daemon handles: SIGINT, SIGTERM and
+/// SIGHUP. They are blocked in every thread and received via a signalfd
+/// watched by the event loop, so none can arrive unnoticed just before the
+/// loop waits.
+sigset_t daemon_signals()
+{
+  sigset_t signals;
+  ::sigemptyset(&signals);
+  ::sigaddset(&signals, SIGINT);
+  ::sigaddset(&signals, SIGTERM);
+  ::sigaddset(&signals, SIGHUP);
+  return signals;
+}
+
+std::unique_ptr<text_registry_type const>
+build_registry(std::vector<std::string> const & files)
+{
+  std::unique_ptr<text_registry_type> reg{new text_registry_type};
+  if (files.empty())
+    {
+      rnd_text_info_maker make_rnd_text_info( RandomTextChunks,RandomTextChunks
+                                            , RandomWordsPerChunk,RandomWordsPerChunk
+                                            , MinWordSize,MaxWordSize
+                                            );
+      auto pti(make_rnd_text_info());
+      for (auto i=0U; i!=pti->number_of_chunks(); ++i)
+        {
+          reg->add_text_chunk(pti->chunk_text(i));
+        }
+    }
+  for (auto const & file : files)
+    {
+      std::ifstream in{file.c_str(), std::ios::binary};
+      if (!in)
+        {
+          throw std::runtime_error{"Unable to read " + file};
+        }
+      std::ostringstream chunk;
+      chunk << in.rdbuf();
+      reg->add_text_chunk(chunk.str());
+    }
+  reg->setup_complete();
+  return std::unique_ptr<text_registry_type const>{reg.release()};
+}
+
+/// @brief Per-connection buffered state.
+struct connection
+{
+  std::string input;
+  std::string output;
+  std::size_t output_sent;
+
+  std::uint32_t events;   ///< epoll events currently registered.
+
+  connection() : output_sent{0U}, events{EPOLLIN} {}
+
+/// @brief Returns number of bytes of responses not yet sent.
+  std::size_t pending_output() const { return output.size()-output_sent; }
+
+/// @brief Returns true if more input may be read and requests executed.
+  bool want_read() const
+  {
+    return input.size()<MaxPendingInput && pending_output()<MaxPendingOutput;
+  }
+};
+
+void set_non_blocking(int fd)
+{
+  ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0)|O_NONBLOCK);
+}
+
+/// @brief Execute complete requests in conn.input, appending responses,
+/// until no complete request remains or the pending output is too large.
+/// @returns false if the connection should be closed.
+bool process_requests(connection & conn, text_registry_type const & reg)
+{
+  std::size_t pos{0U};
+  try
+    {
+      query_protocol::request req;
+      std::size_t used;
+      while ( conn.pending_output()<MaxPendingOutput
+           && (used=query_protocol::parse_request( conn.input.data()+pos
+                                                 , conn.input.size()-pos
+                                                 , req
+                                                 ))!=0U
+            )
+        {
+          pos += used;
+          query_protocol::append_response( conn.output
+                                         , query_protocol::execute(reg, req)
+                                         , req.op
+                                         );
+        }
+    }
+  catch (query_protocol_error &)
+    {
+      return false;
+    }
+  conn.input.erase(0U, pos);
+  return true;
+}
+
+/// @brief Write as much pending output as the socket accepts.
+/// @returns false if the connection should be closed.
+bool flush_output(int fd, connection & conn)
+{
+  while (conn.output_sent!=conn.output.size())
+    {
+      auto n(::send( fd, conn.output.data()+conn.output_sent
+                   , conn.output.size()-conn.output_sent, MSG_NOSIGNAL
+                   ));
+      if (n==-1)
+        {
+          return errno==EAGAIN || errno==EWOULDBLOCK || errno==EINTR;
+        }
+      conn.output_sent += n;
+    }
+  conn.output.clear();
+  conn.output_sent = 0U;
+  return true;
+}
+
+/// @brief Read available input, up to MaxPendingInput buffered bytes.
+/// @returns false if the peer closed the connection or on error.
+bool read_input(int fd, connection & conn)
+{
+  char block[ReadBlockSize];
+  while (conn.input.size()<MaxPendingInput)
+    {
+      auto n(::recv(fd, block, sizeof(block), 0));
+      if (n>0)
+        {
+          conn.input.append(block, n);
+        }
+      else if (n==0)
+        {
+          return false;
+        }
+      else
+        {
+          return errno==EAGAIN || errno==EWOULDBLOCK || errno==EINTR;
+        }
+    }
+  return true;
+}
+
+[[noreturn]] void throw_errno(std::string const & what)
+{
+  throw std::runtime_error{what + ": " + std::strerror(errno)};
+}
+
+/// @brief Closes file descriptor on scope exit.
+struct fd_closer
+{
+  int fd;
+  ~fd_closer() { ::close(fd); }
+};
+
+/// @brief Start building a registry on another thread, signalling done_fd,
+/// an eventfd, once the build has finished, successfully or not.
+std::future<std::unique_ptr<text_registry_type const>>
+start_build(std::vector<std::string> const & files, int done_fd)
+{
+  return std::async
+          ( std::launch::async
+          , [&files, done_fd]()
+            {
+              struct done_signaller
+              {
+                int fd;
+                ~done_signaller()
+                {
+                  std::uint64_t one{1U};
+                  if (::write(fd, &one, sizeof(one))==-1)
+                    {
+                      std::clog << "textqueryd: unable to signal reload done: "
+                                << std::strerror(errno) << std::endl;
+                    }
+                }
+              } signaller{done_fd};
+              return build_registry(files);
+            }
+          );
+}
+
+int listen_on(std::string const & path)
+{
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size()>=sizeof(addr.sun_path))
+    {
+      throw std::runtime_error{"Socket path too long: " + path};
+    }
+  std::strcpy(addr.sun_path, path.c_str());
+  int fd{::socket(AF_UNIX, SOCK_STREAM, 0)};
+  ::unlink(path.c_str());
+  if ( fd==-1
+    || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))==-1
+    || ::listen(fd, SOMAXCONN)==-1
+     )
+    {
+      throw std::runtime_error{"Unable to listen on " + path + ": "
+                               + std::strerror(errno)};
+    }
+  set_non_blocking(fd);
+  return fd;
+}
+
+void serve(std::string const & path, std::vector<std::string> const & files)
+{
+  registry_holder holder{1U};
+  holder.publish(build_registry(files));
+  auto rdr(holder.register_reader());
+
+  int listen_fd{listen_on(path)};
+  fd_closer listen_closer{listen_fd};
+  int epoll_fd{::epoll_create1(0)};
+  if (epoll_fd==-1)
+    {
+      throw_errno("epoll_create1");
+    }
+  fd_closer epoll_closer{epoll_fd};
+  int reload_fd{::eventfd(0U, EFD_NONBLOCK)};
+  if (reload_fd==-1)
+    {
+      throw_errno("eventfd");
+    }
+  fd_closer reload_closer{reload_fd};
+  auto signals(daemon_signals());
+  int signal_fd{::signalfd(-1, &signals, SFD_NONBLOCK|SFD_CLOEXEC)};
+  if (signal_fd==-1)
+    {
+      throw_errno("signalfd");
+    }
+  fd_closer signal_closer{signal_fd};
+  epoll_event ev;
+  std::memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  for (int fd : {listen_fd, reload_fd, signal_fd})
+    {
+      ev.data.fd = fd;
+      if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev)==-1)
+        {
+          throw_errno("epoll_ctl");
+        }
+    }
+  std::map<int, connection> connections;
+  auto close_connection([&](int fd)
+                        {
+                          ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                          ::close(fd);
+                          connections.erase(fd);
+                        }
+                       );
+  std::future<std::unique_ptr<text_registry_type const>> rebuild;
+
+  std::clog << "textqueryd: serving " << rdr.pin()->number_of_chunks()
+            << " chunks on " << path << std::endl;
+  epoll_event events[MaxEvents];
+  bool stop_requested{false};
+  bool reload_requested{false};
+  while (!stop_requested)
+    {
+      if (reload_requested && !rebuild.valid())
+        {
+          reload_requested = false;
+          rebuild = start_build(files, reload_fd);
+        }
+      int n{::epoll_wait(epoll_fd, events, MaxEvents, -1)};
+      if (n==-1 && errno!=EINTR)
+        {
+          throw_errno("epoll_wait");
+        }
+      auto guard(rdr.pin());
+      for (int i{0}; i<n; ++i)
+        {
+          int fd{events[i].data.fd};
+          if (fd==listen_fd)
+            {
+              int conn_fd;
+              while ((conn_fd=::accept(listen_fd, nullptr, nullptr))!=-1)
+                {
+                  set_non_blocking(conn_fd);
+                  ev.events = EPOLLIN;
+                  ev.data.fd = conn_fd;
+                  if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn_fd, &ev)==-1)
+                    {
+                      std::clog << "textqueryd: epoll_ctl: "
+                                << std::strerror(errno) << std::endl;
+                      ::close(conn_fd);
+                      continue;
+                    }
+                  connections[conn_fd];
+                }
+              continue;
+            }
+          if (fd==signal_fd)
+            {
+              signalfd_siginfo info;
+              while (::read(signal_fd, &info, sizeof(info))==sizeof(info))
+                {
+                  if (info.ssi_signo==SIGHUP)
+                    {
+                      reload_requested = true;
+                    }
+                  else
+                    {
+                      stop_requested = true;
+                    }
+                }
+              continue;
+            }
+          if (fd==reload_fd)
+            {
+              std::uint64_t count;
+              if (::read(reload_fd, &count, sizeof(count))==-1 || !rebuild.valid())
+                {
+                  continue;
+                }
+              try
+                { // Queries pinned to the current version remain valid.
+                  holder.publish(rebuild.get());
+                  std::clog << "textqueryd: reloaded" << std::endl;
+                }
+              catch (std::exception & e)
+                {
+                  std::clog << "textqueryd: reload failed, still serving"
+                               " previous version: " << e.what() << std::endl;
+                }
+              continue;
+            }
+          auto & conn(connections[fd]);
+          bool open{true};
+          if (events[i].events & (EPOLLIN|EPOLLHUP|EPOLLERR))
+            {
+              open = conn.want_read() ? read_input(fd, conn)
+                                      : (events[i].events & EPOLLIN)!=0U;
+            }
+          open = process_requests(conn, *guard) && open;
+          open = flush_output(fd, conn) && open;
+          if (open && conn.want_read())
+            { // Output drained: execute requests buffered while paused.
+              open = process_requests(conn, *guard) && flush_output(fd, conn);
+            }
+          if ( open && conn.input.size()>=MaxPendingInput
+            && conn.pending_output()<MaxPendingOutput
+             )
+            {
+              open = false; // Input full but holds no complete request.
+            }
+          if (!open)
+            {
+              close_connection(fd);
+              continue;
+            }
+          std::uint32_t wanted{ (conn.want_read() ? EPOLLIN : 0U)
+                              | (conn.output.empty() ? 0U : EPOLLOUT)
+                              };
+          if (wanted!=conn.events)
+            {
+              conn.events = wanted;
+              ev.events = wanted;
+              ev.data.fd = fd;
+              if (::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev)==-1)
+                {
+                  std::clog << "textqueryd: epoll_ctl: "
+                            << std::strerror(errno) << std::endl;
+                  close_connection(fd);
+                }
+            }
+        }
+    }
+  for (auto const & c : connections)
+    {
+      ::close(c.first);
+    }
+  ::unlink(path.c_str());
+}
+
+int main(int argc, char * argv[])
+{
+  if (argc<2)
+    {
+      std::cerr << "Usage: " << argv[0] << " socket-path [file...]\n";
+      return 2;
+    }
+// Blocked before any thread is started so all threads inherit the mask.
+  auto signals(daemon_signals());
+  ::pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  try
+    {
+      serve(argv[1], std::vector<std::string>(argv+2, argv+argc));
+    }
+  catch (std::exception & e)
+    {
+      std::cerr << "textqueryd: " << e.what() << '\n';
+      return 1;
+    }
+}
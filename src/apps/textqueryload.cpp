@@ -0,0 +1,274 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file textqueryload.cpp
+/// @brief Load generator for the textqueryd local query daemon.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Opens a number of connections to a textqueryd socket, each on its own
+/// thread, and on each sends a mix of query_protocol requests keeping up to
+/// pipeline-depth requests outstanding. Reports overall throughput and the
+/// distribution of request latencies (time from a request being sent to its
+/// response being received).
+///
+/// Usage: textqueryload socket-path [connections [requests [pipeline-depth]]]
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "query_protocol.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace dibase::blog::sies;
+
+typedef std::chrono::steady_clock     clock_type;
+typedef std::chrono::nanoseconds      latency_type;
+
+auto const DefaultConnections(4U);
+auto const DefaultRequests(100000U);
+auto const DefaultPipelineDepth(32U);
+auto const ReadBlockSize(64U*1024U);
+
+/// @brief Results of one connection's run.
+struct connection_result
+{
+  std::vector<latency_type::rep>  latencies;
+  unsigned                        errors;
+  std::string                     failure;
+
+  connection_result() : errors{0U} {}
+};
+
+int connect_to(std::string const & path)
+{
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+  int fd{::socket(AF_UNIX, SOCK_STREAM, 0)};
+  if ( fd==-1
+    || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))==-1
+     )
+    {
+      std::string reason{std::strerror(errno)};
+      if (fd!=-1)
+        {
+          ::close(fd);
+        }
+      throw std::runtime_error{"Unable to connect to " + path + ": " + reason};
+    }
+  return fd;
+}
+
+void send_all(int fd, std::string const & data)
+{
+  std::size_t sent{0U};
+  while (sent!=data.size())
+    {
+      auto n(::send(fd, data.data()+sent, data.size()-sent, MSG_NOSIGNAL));
+      if (n==-1 && errno!=EINTR)
+        {
+          throw std::runtime_error{std::string{"send: "} + std::strerror(errno)};
+        }
+      sent += n==-1 ? 0 : n;
+    }
+}
+
+void receive_some(int fd, std::string & input)
+{
+  char block[ReadBlockSize];
+  ssize_t n;
+  while ((n=::recv(fd, block, sizeof(block), 0))==-1 && errno==EINTR)
+    {}
+  if (n<=0)
+    {
+      throw std::runtime_error{"Connection closed by server"};
+    }
+  input.append(block, n);
+}
+
+/// @brief Make a random request from the query mix.
+query_protocol::request random_request
+( std::minstd_rand & rnd
+, std::uint32_t id
+, std::uint64_t number_of_chunks
+)
+{
+  using query_protocol::opcode;
+  static opcode const Mix[] = { opcode::word_occurrence, opcode::word_occurrence
+                              , opcode::char_occurrence, opcode::chunk_word_count
+                              , opcode::chunk_char_occurrence
+                              , opcode::chunk_word_occurrence
+                              , opcode::chunk_text, opcode::word_count
+                              };
+  std::uniform_int_distribution<unsigned> pick_op(0U, sizeof(Mix)/sizeof(Mix[0])-1U);
+  std::uniform_int_distribution<unsigned> pick_letter('a', 'z');
+  std::uniform_int_distribution<std::uint64_t>
+          pick_chunk(0U, number_of_chunks==0U ? 0U : number_of_chunks-1U);
+  query_protocol::request req{id, Mix[pick_op(rnd)], pick_chunk(rnd), '\0', std::string{}};
+  req.chr = static_cast<char>(pick_letter(rnd));
+  req.word.assign(1U+id%3U, req.chr);
+  return req;
+}
+
+void run_connection
+( std::string const & path
+, unsigned seed
+, unsigned requests
+, unsigned depth
+, connection_result & result
+)
+{
+  try
+    {
+      int fd{connect_to(path)};
+      std::string input;
+      std::string output;
+      query_protocol::response resp;
+
+      query_protocol::append_request
+          (output, query_protocol::request{ 0U, query_protocol::opcode::number_of_chunks
+                                          , 0U, '\0', std::string{}
+                                          });
+      send_all(fd, output);
+      std::size_t used;
+      while ((used=query_protocol::parse_response
+                  ( input.data(), input.size()
+                  , query_protocol::opcode::number_of_chunks, resp))==0U)
+        {
+          receive_some(fd, input);
+        }
+      input.erase(0U, used);
+      auto number_of_chunks(resp.count);
+
+      std::minstd_rand rnd{seed};
+      struct outstanding
+      {
+        query_protocol::opcode  op;
+        clock_type::time_point  sent;
+      };
+      std::deque<outstanding> pending;
+      result.latencies.reserve(requests);
+      unsigned sent{0U};
+      while (result.latencies.size()!=requests)
+        {
+          output.clear();
+          auto now(clock_type::now());
+          while (pending.size()<depth && sent!=requests)
+            {
+              auto req(random_request(rnd, ++sent, number_of_chunks));
+              query_protocol::append_request(output, req);
+              pending.push_back(outstanding{req.op, now});
+            }
+          send_all(fd, output);
+          receive_some(fd, input);
+          std::size_t pos{0U};
+          while ( !pending.empty()
+               && (used=query_protocol::parse_response
+                           ( input.data()+pos, input.size()-pos
+                           , pending.front().op, resp))!=0U
+                )
+            {
+              pos += used;
+              result.latencies.push_back
+                  (std::chrono::duration_cast<latency_type>
+                          (clock_type::now()-pending.front().sent).count());
+              if (resp.result!=query_protocol::status::ok)
+                {
+                  ++result.errors;
+                }
+              pending.pop_front();
+            }
+          input.erase(0U, pos);
+        }
+      ::close(fd);
+    }
+  catch (std::exception & e)
+    {
+      result.failure = e.what();
+    }
+}
+
+double percentile_us(std::vector<latency_type::rep> const & sorted, double pc)
+{
+  if (sorted.empty())
+    {
+      return 0.0;
+    }
+  auto idx(static_cast<std::size_t>(pc/100.0*(sorted.size()-1U)));
+  return sorted[idx]/1000.0;
+}
+
+int main(int argc, char * argv[])
+{
+  if (argc<2)
+    {
+      std::cerr << "Usage: " << argv[0]
+                << " socket-path [connections [requests [pipeline-depth]]]\n";
+      return 2;
+    }
+  std::string path{argv[1]};
+  unsigned connections(argc>2 ? std::atoi(argv[2]) : DefaultConnections);
+  unsigned requests(argc>3 ? std::atoi(argv[3]) : DefaultRequests);
+  unsigned depth(argc>4 ? std::atoi(argv[4]) : DefaultPipelineDepth);
+  if (connections==0U || depth==0U)
+    {
+      std::cerr << "textqueryload: connections and depth must be non-zero\n";
+      return 2;
+    }
+
+  std::vector<connection_result> results(connections);
+  auto start(clock_type::now());
+  {
+    std::vector<std::thread> threads;
+    for (auto c=0U; c!=connections; ++c)
+      {
+        threads.push_back(std::thread( run_connection, std::cref(path), c+1U
+                                     , requests, depth, std::ref(results[c])
+                                     ));
+      }
+    for (auto & t : threads)
+      {
+        t.join();
+      }
+  }
+  auto elapsed(std::chrono::duration<double>(clock_type::now()-start).count());
+
+  std::vector<latency_type::rep> latencies;
+  unsigned errors{0U};
+  for (auto const & r : results)
+    {
+      if (!r.failure.empty())
+        {
+          std::cerr << "textqueryload: connection failed: " << r.failure << '\n';
+        }
+      latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+      errors += r.errors;
+    }
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << "requests:    " << latencies.size() << " (" << errors
+                                                   << " error responses)\n"
+            << "elapsed:     " << elapsed << " s\n"
+            << "throughput:  " << (elapsed>0.0 ? latencies.size()/elapsed : 0.0)
+                               << " requests/s\n"
+            << "latency us:  p50 " << percentile_us(latencies, 50.0)
+            << ", p90 " << percentile_us(latencies, 90.0)
+            << ", p99 " << percentile_us(latencies, 99.0)
+            << ", p99.9 " << percentile_us(latencies, 99.9)
+            << ", max " << percentile_us(latencies, 100.0) << '\n';
+  return latencies.size()==requests*connections ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file chunk_staging.cpp
+/// @brief Staging of text chunks by several producer threads during setup.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "chunk_staging.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    chunk_staging::handle::handle(handle && other)
+    : staging{other.staging}
+    , chunks(std::move(other.chunks))
+    {
+      other.staging = nullptr;
+    }
+
+    chunk_staging::handle & chunk_staging::handle::operator=(handle && other)
+    {
+      if (this!=&other)
+        {
+          submit();
+          staging = other.staging;
+          chunks = std::move(other.chunks);
+          other.staging = nullptr;
+        }
+      return *this;
+    }
+
+    chunk_staging::handle::~handle()
+    {
+      submit();
+    }
+
+    void chunk_staging::handle::add_text_chunk
+    ( std::uint64_t sequence_number
+    , std::string text
+    )
+    {
+      if (staging==nullptr)
+        {
+          throw std::logic_error{"chunk_staging::handle: handle submitted"};
+        }
+      chunks.emplace_back(sequence_number, std::move(text));
+    }
+
+    void chunk_staging::handle::submit()
+    {
+      if (staging!=nullptr)
+        {
+          staging->submit(chunks);
+          staging = nullptr;
+        }
+    }
+
+    chunk_staging::handle chunk_staging::open()
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      ++open_handles;
+      return handle{*this};
+    }
+
+    std::size_t chunk_staging::number_open() const
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      return open_handles;
+    }
+
+    std::size_t chunk_staging::number_staged() const
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      std::size_t count{0U};
+      for (auto const & b : submitted)
+        {
+          count += b.size();
+        }
+      return count;
+    }
+
+    void chunk_staging::submit(batch & chunks)
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      --open_handles;
+      if (!chunks.empty())
+        {
+          submitted.push_back(std::move(chunks));
+        }
+      chunks.clear();
+    }
+
+    chunk_staging::batch chunk_staging::take_ordered()
+    {
+      std::vector<batch> batches;
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (open_handles!=0U)
+          {
+            throw std::logic_error{"chunk_staging::take_ordered: handles open"};
+          }
+        batches.swap(submitted);
+      }
+      batch ordered;
+      std::size_t count{0U};
+      for (auto const & b : batches)
+        {
+          count += b.size();
+        }
+      ordered.reserve(count);
+      auto by_sequence_number
+            = [](staged_chunk const & lhs, staged_chunk const & rhs)
+              {
+                return lhs.first<rhs.first;
+              };
+      for (auto & b : batches)
+        {
+        // Producers usually add chunks in sequence order, so merge each
+        // batch in rather than sorting all chunks at once.
+          auto middle(ordered.size());
+          std::move(b.begin(), b.end(), std::back_inserter(ordered));
+          if (!std::is_sorted( ordered.begin()+middle, ordered.end()
+                             , by_sequence_number
+                             )
+             )
+            {
+              std::sort( ordered.begin()+middle, ordered.end()
+                       , by_sequence_number
+                       );
+            }
+          std::inplace_merge( ordered.begin(), ordered.begin()+middle
+                            , ordered.end(), by_sequence_number
+                            );
+        }
+      auto duplicate(std::adjacent_find( ordered.begin(), ordered.end()
+                                       , []( staged_chunk const & lhs
+                                           , staged_chunk const & rhs
+                                           )
+                                         {
+                                           return lhs.first==rhs.first;
+                                         }
+                                       )
+                    );
+      if (duplicate!=ordered.end())
+        {
+          throw std::invalid_argument
+                  {"chunk_staging::take_ordered: duplicate sequence number"};
+        }
+      return ordered;
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
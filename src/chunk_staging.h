@@ -0,0 +1,114 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file chunk_staging.h
+/// @brief Staging of text chunks by several producer threads during setup.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Only an object's creator thread may mutate it during exclusive setup. To
+/// allow several producer threads to supply an object's text chunks, each is
+/// given a staging handle to which it adds sequence numbered chunks. Each
+/// handle fills its own batch, so adding needs no synchronisation. Batches
+/// are handed to the staging area when handles are submitted, and the
+/// creator thread takes all staged chunks in sequence number order to add
+/// them to the object itself.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_CHUNK_STAGING_H
+# define DIBASE_BLOG_SIES_CHUNK_STAGING_H
+# include <string>
+# include <vector>
+# include <utility>
+# include <mutex>
+# include <cstddef>
+# include <cstdint>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Staging area for text chunks added by several producer threads.
+  ///
+  /// Opening handles, submitting them and taking the staged chunks are
+  /// thread safe. Each handle should be used by one thread at a time.
+    class chunk_staging
+    {
+    public:
+    /// @brief A sequence numbered staged text chunk.
+      typedef std::pair<std::uint64_t, std::string> staged_chunk;
+      typedef std::vector<staged_chunk>             batch;
+
+    /// @brief A producer's handle for staging chunks.
+    ///
+    /// Chunks added are held in the handle's own batch until the handle is
+    /// submitted, explicitly or by destruction. Handles may be moved, for
+    /// example to the producer thread using them, but not copied. A handle
+    /// must be submitted or destroyed before its staging area is destroyed.
+      class handle
+      {
+        chunk_staging * staging;
+        batch           chunks;
+
+        friend class chunk_staging;
+        explicit handle(chunk_staging & s) : staging{&s} {}
+
+      public:
+        handle(handle && other);
+        handle & operator=(handle && other);
+        handle(handle const &) = delete;
+        handle & operator=(handle const &) = delete;
+
+      /// @brief Submits the handle if not already submitted.
+        ~handle();
+
+      /// @brief Adds a chunk to the handle's batch.
+      /// @param sequence_number  Position of chunk among all staged chunks.
+      /// @param text             Text of chunk.
+      /// @throws std::logic_error if the handle has been submitted.
+        void add_text_chunk(std::uint64_t sequence_number, std::string text);
+
+      /// @brief Hands the handle's batch to the staging area. Once submitted
+      /// no more chunks may be added. Submitting again does nothing.
+        void submit();
+
+      /// @brief Returns true if the handle has been submitted.
+        bool submitted() const { return staging==nullptr; }
+
+      /// @brief Returns number of chunks in the handle's batch.
+        std::size_t size() const { return chunks.size(); }
+      };
+
+      chunk_staging() : open_handles{0U} {}
+      chunk_staging(chunk_staging const &) = delete;
+      chunk_staging(chunk_staging &&) = delete;
+      chunk_staging & operator=(chunk_staging const &) = delete;
+      chunk_staging & operator=(chunk_staging &&) = delete;
+
+    /// @brief Returns a new, open, handle for staging chunks.
+      handle open();
+
+    /// @brief Returns number of handles opened and not yet submitted.
+      std::size_t number_open() const;
+
+    /// @brief Returns number of chunks in submitted batches.
+      std::size_t number_staged() const;
+
+    /// @brief Removes and returns all staged chunks in ascending sequence
+    /// number order.
+    /// @throws std::logic_error if any handle is still open.
+    /// @throws std::invalid_argument if two staged chunks have the same
+    ///         sequence number. All staged chunks are removed.
+      batch take_ordered();
+
+    private:
+      mutable std::mutex  mutex;    ///< Protects following members.
+      std::size_t         open_handles;
+      std::vector<batch>  submitted;
+
+      void submit(batch & chunks);
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_CHUNK_STAGING_H
@@ -0,0 +1,103 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file chunk_text_cache.cpp
+/// @brief Bounded cache of decompressed chunk text with lock free lookups.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "chunk_text_cache.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    std::size_t const chunk_text_cache::RetireBatch;
+
+    chunk_text_cache::chunk_text_cache(std::size_t number_of_entries)
+    : capacity{number_of_entries}
+    , slots{}
+    , reader_phase{0U}
+    {
+      if (capacity==0U)
+        {
+          throw std::invalid_argument{"chunk_text_cache: zero capacity"};
+        }
+      slots.reset(new slot[capacity]);
+      for (std::size_t i{0U}; i!=capacity; ++i)
+        {
+          slots[i].store(nullptr);
+        }
+      readers[0].store(0U);
+      readers[1].store(0U);
+      retired.reserve(RetireBatch);
+    }
+
+    chunk_text_cache::~chunk_text_cache()
+    {
+      for (std::size_t i{0U}; i!=capacity; ++i)
+        {
+          delete slots[i].load();
+        }
+      for (auto e : retired)
+        {
+          delete e;
+        }
+    }
+
+    bool chunk_text_cache::find(std::uint64_t chunk_index, std::string & text)
+    {
+      read_section section{*this};
+      auto e(slots[chunk_index%capacity].load());
+      if (e==nullptr || e->chunk_index!=chunk_index)
+        {
+          return false;
+        }
+      text = e->text;
+      return true;
+    }
+
+    void chunk_text_cache::insert(std::uint64_t chunk_index, std::string text)
+    {
+      std::unique_ptr<entry> e{new entry{chunk_index, std::move(text)}};
+      std::lock_guard<std::mutex> lock{update_mutex};
+      auto previous(slots[chunk_index%capacity].exchange(e.release()));
+      if (previous!=nullptr)
+        {
+          retired.push_back(previous); // capacity reserved: does not throw
+        }
+      if (retired.size()==RetireBatch)
+        {
+          reclaim_retired();
+        }
+    }
+
+    void chunk_text_cache::reclaim_retired()
+    {
+    // Retired entries are no longer reachable from any slot. A lookup that
+    // loaded one must be counted in one of the reader counts, and must have
+    // done so before the retiring exchange. Switching phase before waiting
+    // on each count means lookups starting during the wait use the other
+    // count and so cannot keep the awaited count from reaching zero.
+      for (int pass{0}; pass!=2; ++pass)
+        {
+          auto phase(reader_phase.load());
+          reader_phase.store(phase^1U);
+          while (readers[phase].load()!=0U)
+            {
+              std::this_thread::yield();
+            }
+        }
+      for (auto e : retired)
+        {
+          delete e;
+        }
+      retired.clear();
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
@@ -0,0 +1,108 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file chunk_text_cache.h
+/// @brief Bounded cache of decompressed chunk text with lock free lookups.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Used by text_info when chunk text is stored compressed so that the text of
+/// frequently requested chunks is not decompressed on each request.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_CHUNK_TEXT_CACHE_H
+# define DIBASE_BLOG_SIES_CHUNK_TEXT_CACHE_H
+# include <atomic>
+# include <memory>
+# include <mutex>
+# include <vector>
+# include <string>
+# include <cstdint>
+# include <cstddef>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Fixed capacity, direct mapped cache of chunk text by chunk index.
+  ///
+  /// Each slot holds an atomic pointer to an immutable entry. Lookups (find)
+  /// take no locks: a lookup registers itself in one of two reader counts,
+  /// loads a slot pointer and copies the entry's text. Insertions serialise on
+  /// a mutex, atomically replace the slot's entry and retire the previous one.
+  /// Retired entries are deleted in batches once every lookup that might
+  /// still be reading them has finished: the current reader count is switched
+  /// and each count in turn is waited on to drain to zero (in the manner of
+  /// sleepable RCU), so new lookups never delay reclamation indefinitely.
+  ///
+  /// At most capacity + RetireBatch entries are held at any time.
+    class chunk_text_cache
+    {
+      struct entry
+      {
+        std::uint64_t chunk_index;
+        std::string   text;
+      };
+
+      typedef std::atomic<entry const *>  slot;
+
+      std::size_t                   capacity;
+      std::unique_ptr<slot[]>       slots;
+      std::atomic<unsigned>         reader_phase;
+      std::atomic<std::size_t>      readers[2];
+      std::mutex                    update_mutex;
+      std::vector<entry const *>    retired;
+
+    /// @brief Count a lookup in the current reader count for its duration.
+      class read_section
+      {
+        std::atomic<std::size_t> & count;
+
+      public:
+        explicit read_section(chunk_text_cache & cache)
+        : count(cache.readers[cache.reader_phase.load()])
+        {
+          ++count;
+        }
+
+        ~read_section() { --count; }
+
+        read_section(read_section const &) = delete;
+        read_section & operator=(read_section const &) = delete;
+      };
+
+    /// @brief Wait for all lookups that started before the call to finish,
+    /// then delete all retired entries. Called with update_mutex locked.
+      void reclaim_retired();
+
+    public:
+    /// @brief Number of retired entries collected before they are reclaimed.
+      static std::size_t const RetireBatch{8U};
+
+    /// @brief Construct an empty cache.
+    /// @param number_of_entries  Maximum number of chunks' text cached.
+    /// @throws std::invalid_argument if number_of_entries is zero.
+      explicit chunk_text_cache(std::size_t number_of_entries);
+
+      ~chunk_text_cache();
+
+      chunk_text_cache(chunk_text_cache const &) = delete;
+      chunk_text_cache & operator=(chunk_text_cache const &) = delete;
+      chunk_text_cache(chunk_text_cache &&) = delete;
+      chunk_text_cache & operator=(chunk_text_cache &&) = delete;
+
+    /// @brief Look up a chunk's text. Takes no locks.
+    /// @param chunk_index  Index of chunk to look up.
+    /// @param text         Set to a copy of the chunk's text if cached.
+    /// @returns true if chunk's text was cached, false if not.
+      bool find(std::uint64_t chunk_index, std::string & text);
+
+    /// @brief Add a chunk's text, replacing any other in the same slot.
+    /// @param chunk_index  Index of chunk text is for.
+    /// @param text         The chunk's text.
+      void insert(std::uint64_t chunk_index, std::string text);
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_CHUNK_TEXT_CACHE_H
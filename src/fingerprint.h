@@ -0,0 +1,104 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file fingerprint.h
+/// @brief Fast 64 bit content fingerprints of text.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Fingerprints are used to find likely identical text cheaply. They are
+/// not cryptographic: equal fingerprints indicate text that is probably, not
+/// certainly, equal, so matches must be verified if certainty is required.
+/// Digests combine a sequence of fingerprints, so sequences of text, such as
+/// all the chunks of a text_info, can be compared with one integer compare.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_FINGERPRINT_H
+# define DIBASE_BLOG_SIES_FINGERPRINT_H
+# include <cstring>
+# include <cstddef>
+# include <cstdint>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace fingerprint_detail
+    {
+      inline std::uint64_t rotl(std::uint64_t v, unsigned bits)
+      {
+        return (v << bits) | (v >> (64U-bits));
+      }
+
+    /// @brief Mixes 8 bytes of text into a fingerprint state.
+      inline std::uint64_t mix(std::uint64_t state, std::uint64_t bytes)
+      {
+        bytes *= 0x87C37B91114253D5ULL;
+        bytes = rotl(bytes, 31U);
+        bytes *= 0x4CF5AD432745937FULL;
+        return rotl(state ^ bytes, 27U)*5U + 0x52DCE729U;
+      }
+
+    /// @brief Final avalanche, so every input bit affects every output bit.
+      inline std::uint64_t finish(std::uint64_t state)
+      {
+        state ^= state >> 33U;
+        state *= 0xFF51AFD7ED558CCDULL;
+        state ^= state >> 33U;
+        state *= 0xC4CEB9FE1A85EC53ULL;
+        return state ^ (state >> 33U);
+      }
+    }
+
+  /// @brief Returns a 64 bit fingerprint of text.
+  ///
+  /// Text is consumed 8 bytes at a time. The size is mixed in, so text and
+  /// the same text followed by zero bytes differ.
+  ///
+  /// @param data   Pointer to first byte of text.
+  /// @param size   Number of bytes of text.
+  /// @returns Fingerprint of the size bytes starting at data.
+    inline std::uint64_t text_fingerprint(char const * data, std::size_t size)
+    {
+      using namespace fingerprint_detail;
+      std::uint64_t state{0x9E3779B97F4A7C15ULL ^ size};
+      std::size_t pos{0U};
+      for (; size-pos>=sizeof(std::uint64_t); pos+=sizeof(std::uint64_t))
+        {
+          std::uint64_t bytes;
+          std::memcpy(&bytes, data+pos, sizeof(bytes));
+          state = mix(state, bytes);
+        }
+      if (pos!=size)
+        {
+          std::uint64_t bytes{0U};
+          std::memcpy(&bytes, data+pos, size-pos);
+          state = mix(state, bytes);
+        }
+      return finish(state);
+    }
+
+  /// @brief Digest of an empty sequence of fingerprints.
+    std::uint64_t const EmptyDigest{0x243F6A8885A308D3ULL};
+
+  /// @brief Returns the digest of a sequence of fingerprints extended by one
+  /// further fingerprint.
+  ///
+  /// Digests depend on the order of fingerprints, so sequences of the same
+  /// text in a different order, or split differently, have different digests.
+  ///
+  /// @param digest       Digest of sequence, EmptyDigest if empty.
+  /// @param fingerprint  Fingerprint appended to the sequence.
+  /// @returns Digest of the extended sequence.
+    inline std::uint64_t combine_fingerprints
+    ( std::uint64_t digest
+    , std::uint64_t fingerprint
+    )
+    {
+      using namespace fingerprint_detail;
+      return finish(mix(digest, fingerprint));
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_FINGERPRINT_H
@@ -0,0 +1,40 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file frozen_text_image.cpp
+/// @brief Read-only text image held in huge page backed memory.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "frozen_text_image.h"
+
+#include <sstream>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    std::string frozen_memory_report::describe() const
+    {
+      std::ostringstream out;
+      out << image_size << " bytes of image in " << mapped_size
+          << " bytes mapped using " << to_string(backing);
+      return out.str();
+    }
+
+    frozen_text_image::frozen_text_image(std::unique_ptr<huge_page_region> r)
+    : region(std::move(r))
+    , image_view{region->data(), region->size()}
+    {
+    }
+
+    frozen_memory_report frozen_text_image::memory_report() const
+    {
+      return frozen_memory_report{ image_view.size(), region->size()
+                                 , region->backing()
+                                 };
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
@@ -0,0 +1,91 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file frozen_text_image.h
+/// @brief Read-only text image held in huge page backed memory.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// A frozen_text_image holds all of a fully setup text_info's data - chunk
+/// text, count tables and word index - as a single text image in a
+/// huge_page_region which is made read-only once written. Large corpora
+/// queried at random by many threads then need far fewer TLB entries than the
+/// same data scattered over standard pages of the heap.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_FROZEN_TEXT_IMAGE_H
+# define DIBASE_BLOG_SIES_FROZEN_TEXT_IMAGE_H
+# include "text_image.h"
+# include "huge_page_region.h"
+# include <memory>
+# include <string>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Memory used by a frozen_text_image.
+    struct frozen_memory_report
+    {
+      std::uint64_t image_size;   ///< Bytes of image data.
+      std::uint64_t mapped_size;  ///< Bytes mapped, a multiple of page size.
+      page_backing  backing;      ///< Pages mapping is backed by.
+
+    /// @brief Returns single line description of report.
+      std::string describe() const;
+    };
+
+  /// @brief Text image of a text_info in a read-only huge_page_region.
+    class frozen_text_image
+    {
+      std::unique_ptr<huge_page_region> region;
+      text_image_view                   image_view;
+
+      explicit frozen_text_image(std::unique_ptr<huge_page_region> r);
+
+    /// @brief Helper: map region for, and write, image of ti.
+      template <class TextInfo>
+      static std::unique_ptr<huge_page_region> write_image
+      ( TextInfo const & ti
+      , page_backing preferred
+      )
+      {
+        basic_text_image_builder<TextInfo> builder{ti};
+        std::unique_ptr<huge_page_region> r{new huge_page_region{ builder.size()
+                                                                , preferred
+                                                                }};
+        builder.write(r->data());
+        r->make_read_only();
+        return r;
+      }
+
+    public:
+    /// @brief Make image of text_info.
+    /// @param ti         Fully setup basic_text_info object.
+    /// @param preferred  Most preferred backing for the image memory; less
+    ///                   preferred backings are used if it is unavailable.
+    /// @throws std::system_error if no memory could be mapped.
+      template <class TextInfo>
+      explicit frozen_text_image
+      ( TextInfo const & ti
+      , page_backing preferred = page_backing::explicit_huge
+      )
+      : frozen_text_image(write_image(ti, preferred))
+      {
+      }
+
+      frozen_text_image(frozen_text_image const &) = delete;
+      frozen_text_image & operator=(frozen_text_image const &) = delete;
+      frozen_text_image(frozen_text_image &&) = delete;
+      frozen_text_image & operator=(frozen_text_image &&) = delete;
+
+    /// @brief Returns view through which the image may be queried.
+      text_image_view const & view() const { return image_view; }
+
+    /// @brief Returns report of memory used and how it is backed.
+      frozen_memory_report memory_report() const;
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_FROZEN_TEXT_IMAGE_H
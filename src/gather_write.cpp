@@ -0,0 +1,61 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file gather_write.cpp
+/// @brief Write scattered memory regions to a file descriptor with writev.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "gather_write.h"
+
+#include <algorithm>
+#include <system_error>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    std::uint64_t gather_write(int fd, iovec * iov, std::size_t count)
+    {
+      std::size_t const max_iov{IOV_MAX};
+      std::uint64_t total{0U};
+      while (count!=0U)
+        {
+          if (iov->iov_len==0U)
+            {
+              ++iov;
+              --count;
+              continue;
+            }
+          auto written(::writev(fd, iov, static_cast<int>(std::min(count, max_iov))));
+          if (written==-1)
+            {
+              if (errno==EINTR)
+                {
+                  continue;
+                }
+              throw std::system_error{errno, std::system_category(), "writev"};
+            }
+          total += written;
+          std::size_t remaining(written);
+          while (count!=0U && remaining>=iov->iov_len)
+            {
+              remaining -= iov->iov_len;
+              ++iov;
+              --count;
+            }
+          if (remaining!=0U)
+            {
+              iov->iov_base = static_cast<char *>(iov->iov_base) + remaining;
+              iov->iov_len -= remaining;
+            }
+        }
+      return total;
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
@@ -0,0 +1,34 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file gather_write.h
+/// @brief Write scattered memory regions to a file descriptor with writev.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_GATHER_WRITE_H
+# define DIBASE_BLOG_SIES_GATHER_WRITE_H
+# include <cstddef>
+# include <cstdint>
+# include <sys/uio.h>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Write all of a sequence of memory regions to a file descriptor.
+  ///
+  /// Uses writev, at most IOV_MAX regions per call, retrying after partial
+  /// writes and interrupted calls until everything has been written. Blocks
+  /// until done so fd should be in blocking mode.
+  /// @param fd     File descriptor to write to.
+  /// @param iov    Regions to write. Entries are modified to track progress.
+  /// @param count  Number of entries in iov.
+  /// @returns Total number of bytes written.
+  /// @throws std::system_error if a write fails.
+    std::uint64_t gather_write(int fd, iovec * iov, std::size_t count);
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_GATHER_WRITE_H
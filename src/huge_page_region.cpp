@@ -0,0 +1,132 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file huge_page_region.cpp
+/// @brief Memory regions backed by huge pages where the system allows.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "huge_page_region.h"
+
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace
+    {
+      std::size_t round_up(std::size_t size, std::size_t multiple)
+      {
+        return (size+multiple-1U)/multiple*multiple;
+      }
+
+    /// @brief True unless transparent huge pages are unsupported or disabled.
+      bool transparent_huge_pages_enabled()
+      {
+        std::ifstream in{"/sys/kernel/mm/transparent_hugepage/enabled"};
+        std::string setting;
+        return std::getline(in, setting)
+            && setting.find("[never]")==std::string::npos;
+      }
+
+      void * map_anonymous(std::size_t length, int extra_flags)
+      {
+        auto addr(::mmap( nullptr, length, PROT_READ|PROT_WRITE
+                        , MAP_PRIVATE|MAP_ANONYMOUS|extra_flags, -1, 0
+                        ));
+        return addr==MAP_FAILED ? nullptr : addr;
+      }
+
+    /// @brief Map length bytes aligned to alignment by over-mapping then
+    /// trimming the unaligned head and excess tail.
+      void * map_aligned(std::size_t length, std::size_t alignment)
+      {
+        auto addr(static_cast<char *>(map_anonymous(length+alignment, 0)));
+        if (addr==nullptr)
+          {
+            throw std::system_error{errno, std::system_category(), "mmap"};
+          }
+        auto start(reinterpret_cast<std::uintptr_t>(addr));
+        auto aligned(reinterpret_cast<char *>(round_up(start, alignment)));
+        if (aligned!=addr)
+          {
+            ::munmap(addr, aligned-addr);
+          }
+        ::munmap(aligned+length, (addr+length+alignment)-(aligned+length));
+        return aligned;
+      }
+    } // namespace
+
+    char const * to_string(page_backing backing)
+    {
+      switch (backing)
+        {
+        case page_backing::explicit_huge:
+          return "explicit huge pages";
+        case page_backing::transparent_huge:
+          return "transparent huge pages";
+        default:
+          return "standard pages";
+        }
+    }
+
+    std::size_t const huge_page_region::HugePageSize;
+
+    huge_page_region::huge_page_region
+    ( std::size_t size
+    , page_backing preferred
+    )
+    : address{nullptr}
+    , length{round_up(size==0U ? 1U : size, HugePageSize)}
+    , backing_used{page_backing::standard}
+    {
+      if (preferred==page_backing::standard)
+        {
+          length = round_up(size==0U ? 1U : size, ::sysconf(_SC_PAGESIZE));
+          address = map_anonymous(length, 0);
+          if (address==nullptr)
+            {
+              throw std::system_error{errno, std::system_category(), "mmap"};
+            }
+          return;
+        }
+      if (preferred==page_backing::explicit_huge)
+        {
+          address = map_anonymous(length, MAP_HUGETLB);
+          if (address!=nullptr)
+            {
+              backing_used = page_backing::explicit_huge;
+              return;
+            }
+        }
+      address = map_aligned(length, HugePageSize);
+      if ( transparent_huge_pages_enabled()
+        && ::madvise(address, length, MADV_HUGEPAGE)==0
+         )
+        {
+          backing_used = page_backing::transparent_huge;
+        }
+    }
+
+    huge_page_region::~huge_page_region()
+    {
+      ::munmap(address, length);
+    }
+
+    void huge_page_region::make_read_only()
+    {
+      if (::mprotect(address, length, PROT_READ)==-1)
+        {
+          throw std::system_error{errno, std::system_category(), "mprotect"};
+        }
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
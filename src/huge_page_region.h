@@ -0,0 +1,89 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file huge_page_region.h
+/// @brief Memory regions backed by huge pages where the system allows.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Large, randomly accessed, read-mostly data suffers from TLB misses when
+/// held in standard (4 KiB) pages. A huge_page_region is an anonymous
+/// mapping that is, in order of preference and as requested:
+///   - an explicit huge page (hugetlbfs) mapping, if huge pages are reserved
+///   - a transparent huge page candidate, advised with MADV_HUGEPAGE
+///   - standard pages
+/// Regions for which huge pages are requested are 2 MiB aligned and sized
+/// even if only standard pages are obtained; regions requesting standard
+/// pages are page aligned and sized. The backing actually obtained is
+/// reported so it can be logged.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_HUGE_PAGE_REGION_H
+# define DIBASE_BLOG_SIES_HUGE_PAGE_REGION_H
+# include <cstdint>
+# include <cstddef>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Kind of pages a region is to be, or is, backed by.
+    enum class page_backing
+    {
+      standard            ///< Standard pages only.
+    , transparent_huge    ///< Transparent huge pages advised for region.
+    , explicit_huge       ///< Explicit (hugetlbfs) huge pages.
+    };
+
+  /// @brief Returns name of a page_backing value, for reports.
+    char const * to_string(page_backing backing);
+
+  /// @brief Anonymous, private memory mapping, 2 MiB aligned if huge pages
+  /// requested.
+    class huge_page_region
+    {
+      void *        address;
+      std::size_t   length;
+      page_backing  backing_used;
+
+    public:
+    /// @brief Huge page size regions are aligned to and sized in multiples of.
+      static std::size_t const HugePageSize{2U*1024U*1024U};
+
+    /// @brief Map a zero filled region.
+    /// @param size       Number of bytes required. The region is rounded up
+    ///                   to a multiple of HugePageSize, or of the system page
+    ///                   size if preferred is standard.
+    /// @param preferred  Most preferred backing. If it cannot be obtained the
+    ///                   next preferred is tried, down to standard pages.
+    /// @throws std::system_error if no mapping could be made.
+      huge_page_region
+      ( std::size_t size
+      , page_backing preferred = page_backing::explicit_huge
+      );
+
+    /// @brief Destructor: unmap the region.
+      ~huge_page_region();
+
+      huge_page_region(huge_page_region const &) = delete;
+      huge_page_region & operator=(huge_page_region const &) = delete;
+      huge_page_region(huge_page_region &&) = delete;
+      huge_page_region & operator=(huge_page_region &&) = delete;
+
+    /// @brief Returns start of region.
+      void * data() const { return address; }
+
+    /// @brief Returns size of region.
+      std::size_t size() const { return length; }
+
+    /// @brief Returns the backing obtained for the region.
+      page_backing backing() const { return backing_used; }
+
+    /// @brief Make region read-only: any later write to it faults.
+    /// @throws std::system_error if the protection cannot be changed.
+      void make_read_only();
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_HUGE_PAGE_REGION_H
@@ -0,0 +1,345 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file incremental_text_registry.h
+/// @brief Text registry publishing an advancing prefix of its chunks.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// A variation on text_registry in which the creator thread may publish the
+/// chunks added so far and carry on appending more. Readers on any thread
+/// may query the published prefix of chunks at any time rather than having to
+/// wait for the whole setup to complete. Mutating operations are still only
+/// allowed on the creator thread, and only until setup_complete is called.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_INCREMENTAL_TEXT_REGISRTY_H
+# define DIBASE_BLOG_SIES_INCREMENTAL_TEXT_REGISRTY_H
+# include "call_context_validator.h"
+# include "append_only_vector.h"
+# include "text_info.h"
+# include <atomic>
+# include <stdexcept>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Text registry whose published chunk count advances during setup
+  ///
+  /// Chunks are held in an append_only_vector so existing chunks are never
+  /// moved by later appends. The count of published chunks is stored using
+  /// the SyncPolicy: for correct operation this should be a policy whose
+  /// store has (at least) release semantics and whose load has (at least)
+  /// acquire semantics, so that a reader observing a count also observes
+  /// all the writes made to set up the chunks it covers.
+  ///
+  /// Each chunk is stored with the running character and word totals up to
+  /// and including that chunk so corpus-wide counts of any published prefix
+  /// are available without iterating over chunks.
+  ///
+  /// @param SyncPolicy Atomic synchronisation policy type template
+  ///                   (e.g.non_atomic, atomic)
+  /// @param M          0+ (typically 0, 1 or 2) std::memory_oder values
+  ///                   passed to the SyncPolicy template type.
+    template
+    < template <class T, std::memory_order...> class SyncPolicy
+    , std::memory_order... M
+    >
+    class incremental_text_registry
+    {
+    public:
+      typedef text_info::chunk_size_type      chunk_size_type;
+      typedef text_info::chunk_count_type     chunk_count_type;
+      typedef text_info::chunk_index_type     chunk_index_type;
+
+    private:
+      typedef text_info::chunk_info           chunk_info;
+
+    /// @brief Stored chunk: chunk information plus running totals.
+      struct stored_chunk
+      {
+        chunk_info      info;
+        chunk_size_type total_char_count;
+        chunk_size_type total_word_count;
+      };
+
+      call_context_validator<SyncPolicy, incremental_text_registry, M...>
+                                          validate_usage;
+      append_only_vector<stored_chunk>    chunks;
+      SyncPolicy<chunk_count_type, M...>  published_count;
+
+    public:
+    /// @brief Consistent view of the chunks published at some point.
+    ///
+    /// Provides the same immutable operations as text_registry for a
+    /// fixed number of chunks, so that a sequence of queries made through
+    /// one prefix object all see the same data even if more chunks are
+    /// published meanwhile.
+      class prefix
+      {
+        friend class incremental_text_registry;
+        incremental_text_registry const * reg;
+        chunk_count_type                  size;
+
+        prefix(incremental_text_registry const & r, chunk_count_type n)
+        : reg{&r}, size{n}
+        {}
+
+        template <typename MapT, typename KeyT>
+        static chunk_size_type lookup(MapT const & occ_map, KeyT const & key)
+        {
+          auto pos(occ_map.find(key));
+          return (pos==occ_map.end())?0U:pos->second;
+        }
+
+        stored_chunk const & at(chunk_index_type chunk_index) const
+        {
+          if (chunk_index>=size)
+            {
+              throw std::out_of_range{"Chunk index not in published prefix."};
+            }
+          return reg->chunks[chunk_index];
+        }
+
+      public:
+      /// @brief Returns number of text chunks in prefix.
+        chunk_count_type number_of_chunks() const { return size; }
+
+      /// @brief Returns copy of a chunk's text.
+      /// @throws std::out_of_range if chunk_index not in prefix.
+        std::string chunk_text(chunk_index_type chunk_index) const
+        {
+          return at(chunk_index).info.chunk;
+        }
+
+      /// @brief Returns number of characters in a chunk.
+      /// @throws std::out_of_range if chunk_index not in prefix.
+        chunk_size_type chunk_char_count(chunk_index_type chunk_index) const
+        {
+          return at(chunk_index).info.char_count;
+        }
+
+      /// @brief Returns number of words in a chunk.
+      /// @throws std::out_of_range if chunk_index not in prefix.
+        chunk_size_type chunk_word_count(chunk_index_type chunk_index) const
+        {
+          return at(chunk_index).info.word_count;
+        }
+
+      /// @brief Returns occurrence of a character in a chunk.
+      /// @throws std::out_of_range if chunk_index not in prefix.
+        chunk_size_type chunk_char_occurrence
+        ( chunk_index_type chunk_index
+        , char chr
+        ) const
+        {
+          return lookup(at(chunk_index).info.char_occ_map, chr);
+        }
+
+      /// @brief Returns occurrence of a word in a chunk.
+      /// @throws std::out_of_range if chunk_index not in prefix.
+        chunk_size_type chunk_word_occurrence
+        ( chunk_index_type chunk_index
+        , std::string const & word
+        ) const
+        {
+          return lookup(at(chunk_index).info.word_occ_map, tolower(word));
+        }
+
+      /// @brief Returns concatenation of all prefix chunks' text.
+        std::string text() const
+        {
+          std::string txt;
+          txt.reserve(char_count());
+          for (chunk_index_type i{0U}; i!=size; ++i)
+            {
+              txt += reg->chunks[i].info.chunk;
+            }
+          return txt;
+        }
+
+      /// @brief Returns number of characters in all prefix chunks.
+        chunk_size_type char_count() const
+        {
+          return size==0U ? 0U : reg->chunks[size-1U].total_char_count;
+        }
+
+      /// @brief Returns number of words in all prefix chunks.
+        chunk_size_type word_count() const
+        {
+          return size==0U ? 0U : reg->chunks[size-1U].total_word_count;
+        }
+
+      /// @brief Returns occurrence of a character in all prefix chunks.
+        chunk_size_type char_occurrence(char chr) const
+        {
+          chunk_size_type occ{0U};
+          for (chunk_index_type i{0U}; i!=size; ++i)
+            {
+              occ += lookup(reg->chunks[i].info.char_occ_map, chr);
+            }
+          return occ;
+        }
+
+      /// @brief Returns occurrence of a word in all prefix chunks.
+        chunk_size_type word_occurrence(std::string const & word) const
+        {
+          auto lcword(tolower(word));
+          chunk_size_type occ{0U};
+          for (chunk_index_type i{0U}; i!=size; ++i)
+            {
+              occ += lookup(reg->chunks[i].info.word_occ_map, lcword);
+            }
+          return occ;
+        }
+      };
+
+      incremental_text_registry()
+      : published_count{0U}
+      {}
+
+      incremental_text_registry(incremental_text_registry const &) = delete;
+      incremental_text_registry & operator=
+                                (incremental_text_registry const &) = delete;
+      incremental_text_registry(incremental_text_registry &&) = delete;
+      incremental_text_registry & operator=
+                                (incremental_text_registry &&) = delete;
+
+    /// @brief Mutable operation. Add a chunk of text to an object.
+    /// The chunk is not visible to queries until publish_chunks or
+    /// setup_complete is called.
+    /// @param text Text string chunk to add to object.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread or if the object
+    ///         has completed its setup and has become immutable.
+      void add_text_chunk(std::string const & text)
+      {
+        validate_usage(this);
+        auto n(chunks.size());
+        stored_chunk sc{chunk_info{text}, 0U, 0U};
+        sc.total_char_count = sc.info.char_count
+                            + (n==0U ? 0U : chunks[n-1U].total_char_count);
+        sc.total_word_count = sc.info.word_count
+                            + (n==0U ? 0U : chunks[n-1U].total_word_count);
+        chunks.push_back(std::move(sc));
+      }
+
+    /// @brief Mutable operation. Publish all chunks added so far.
+    /// Afterwards queries on any thread see all chunks added before the call.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread or if the object
+    ///         has completed its setup and has become immutable.
+      void publish_chunks()
+      {
+        validate_usage(this);
+        published_count.store(chunks.size());
+      }
+
+    /// @brief Publish all chunks and make the object immutable.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread or if the object
+    ///         has completed its setup and has become immutable.
+      void setup_complete()
+      {
+        publish_chunks();
+        validate_usage.publish(this);
+      }
+
+    /// @brief Unvalidated query to see if setup is complete.
+    /// @returns true if no more chunks will be published.
+      bool complete() const
+      {
+        return validate_usage.published();
+      }
+
+    /// @brief Immutable operation. Returns view of currently published chunks.
+    /// May be called from any thread at any time.
+      prefix published_prefix() const
+      {
+        return prefix{*this, published_count.load()};
+      }
+
+    /// @brief Immutable operation. Returns number of published text chunks.
+      chunk_count_type number_of_chunks() const
+      {
+        return published_count.load();
+      }
+
+    /// @brief Immutable operation. Returns copy of a published chunk's text.
+    /// @throws std::out_of_range if chunk_index is not published.
+      std::string chunk_text(chunk_index_type chunk_index) const
+      {
+        return published_prefix().chunk_text(chunk_index);
+      }
+
+    /// @brief Immutable operation. Returns number of characters in a chunk.
+    /// @throws std::out_of_range if chunk_index is not published.
+      chunk_size_type chunk_char_count(chunk_index_type chunk_index) const
+      {
+        return published_prefix().chunk_char_count(chunk_index);
+      }
+
+    /// @brief Immutable operation. Returns number of words in a chunk.
+    /// @throws std::out_of_range if chunk_index is not published.
+      chunk_size_type chunk_word_count(chunk_index_type chunk_index) const
+      {
+        return published_prefix().chunk_word_count(chunk_index);
+      }
+
+    /// @brief Immutable operation. Returns occurrence of a character in a chunk.
+    /// @throws std::out_of_range if chunk_index is not published.
+      chunk_size_type chunk_char_occurrence
+      ( chunk_index_type chunk_index
+      , char chr
+      ) const
+      {
+        return published_prefix().chunk_char_occurrence(chunk_index, chr);
+      }
+
+    /// @brief Immutable operation. Returns occurrence of a word in a chunk.
+    /// @throws std::out_of_range if chunk_index is not published.
+      chunk_size_type chunk_word_occurrence
+      ( chunk_index_type chunk_index
+      , std::string const & word
+      ) const
+      {
+        return published_prefix().chunk_word_occurrence(chunk_index, word);
+      }
+
+    /// @brief Immutable operation. Returns text of all published chunks.
+      std::string text() const
+      {
+        return published_prefix().text();
+      }
+
+    /// @brief Immutable operation. Returns characters in published chunks.
+      chunk_size_type char_count() const
+      {
+        return published_prefix().char_count();
+      }
+
+    /// @brief Immutable operation. Returns words in published chunks.
+      chunk_size_type word_count() const
+      {
+        return published_prefix().word_count();
+      }
+
+    /// @brief Immutable operation. Returns occurrence of character in
+    /// published chunks.
+      chunk_size_type char_occurrence(char chr) const
+      {
+        return published_prefix().char_occurrence(chr);
+      }
+
+    /// @brief Immutable operation. Returns occurrence of word in published
+    /// chunks.
+      chunk_size_type word_occurrence(std::string const & word) const
+      {
+        return published_prefix().word_occurrence(word);
+      }
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_INCREMENTAL_TEXT_REGISRTY_H
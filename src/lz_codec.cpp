@@ -0,0 +1,219 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file lz_codec.cpp
+/// @brief Small, fast LZ77 family codec for compressing chunk text.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "lz_codec.h"
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace
+    {
+      std::size_t const MinMatch{4U};
+      std::size_t const MaxOffset{65535U};
+      std::size_t const HashBits{12U};
+      unsigned const    NibbleMax{15U};
+      std::size_t const NoPosition{~std::size_t{0U}};
+
+      std::uint32_t read32(char const * p)
+      {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+      }
+
+      std::size_t hash4(char const * p)
+      {
+        return (read32(p)*2654435761U) >> (32U-HashBits);
+      }
+
+    /// @brief Append bytes extending a length that did not fit its nibble.
+      void append_length(std::string & out, std::size_t length)
+      {
+        for (; length>=255U; length-=255U)
+          {
+            out += static_cast<char>(255U);
+          }
+        out += static_cast<char>(length);
+      }
+
+      void append_sequence
+      ( std::string & out
+      , char const * literals
+      , std::size_t literal_length
+      , std::size_t offset
+      , std::size_t match_length
+      )
+      {
+        bool has_match{match_length!=0U};
+        std::size_t match_code{has_match ? match_length-MinMatch : 0U};
+        out += static_cast<char>
+                  ( (std::min<std::size_t>(literal_length,NibbleMax)<<4U)
+                  | std::min<std::size_t>(match_code,NibbleMax)
+                  );
+        if (literal_length>=NibbleMax)
+          {
+            append_length(out, literal_length-NibbleMax);
+          }
+        out.append(literals, literal_length);
+        if (has_match)
+          {
+            out += static_cast<char>(offset & 0xffU);
+            out += static_cast<char>(offset >> 8U);
+            if (match_code>=NibbleMax)
+              {
+                append_length(out, match_code-NibbleMax);
+              }
+          }
+      }
+
+    /// @brief Read bytes extending a length whose nibble value was 15.
+      std::size_t read_length
+      ( unsigned char const * & in
+      , unsigned char const * end
+      )
+      {
+        std::size_t length{0U};
+        unsigned char byte;
+        do
+          {
+            if (in==end)
+              {
+                throw lz_codec_error{"Compressed data truncated in length."};
+              }
+            byte = *in++;
+            length += byte;
+          }
+        while (byte==255U);
+        return length;
+      }
+    } // namespace
+
+    std::string lz_compress(char const * data, std::size_t size)
+    {
+      std::string out;
+      out.reserve(size/2U + 16U);
+      std::vector<std::size_t> table(std::size_t{1U}<<HashBits, NoPosition);
+      std::size_t anchor{0U};
+      std::size_t pos{0U};
+      while (size>=MinMatch && pos<=size-MinMatch)
+        {
+          auto & entry(table[hash4(data+pos)]);
+          auto candidate(entry);
+          entry = pos;
+          if ( candidate==NoPosition
+            || pos-candidate>MaxOffset
+            || read32(data+candidate)!=read32(data+pos)
+             )
+            {
+              ++pos;
+              continue;
+            }
+          std::size_t length{MinMatch};
+          while (pos+length<size && data[candidate+length]==data[pos+length])
+            {
+              ++length;
+            }
+          append_sequence(out, data+anchor, pos-anchor, pos-candidate, length);
+          pos += length;
+          anchor = pos;
+        }
+      if (anchor!=size)
+        {
+          append_sequence(out, data+anchor, size-anchor, 0U, 0U);
+        }
+      return out;
+    }
+
+    void lz_decompress
+    ( char const * data
+    , std::size_t size
+    , std::size_t decompressed_size
+    , std::string & out
+    )
+    {
+      auto const base(out.size()); // Matches are relative to this block
+      out.reserve(base+decompressed_size);
+      auto in(reinterpret_cast<unsigned char const *>(data));
+      auto end(in+size);
+      while (in!=end)
+        {
+          unsigned token{*in++};
+          std::size_t literal_length{token>>4U};
+          if (literal_length==NibbleMax)
+            {
+              literal_length += read_length(in, end);
+            }
+          if ( literal_length>static_cast<std::size_t>(end-in)
+            || literal_length>decompressed_size-(out.size()-base)
+             )
+            {
+              throw lz_codec_error{"Compressed data literals overrun."};
+            }
+          out.append(reinterpret_cast<char const *>(in), literal_length);
+          in += literal_length;
+          if (in==end)
+            {
+              break;
+            }
+          if (end-in<2)
+            {
+              throw lz_codec_error{"Compressed data truncated in offset."};
+            }
+          std::size_t offset{in[0] | (std::size_t{in[1]}<<8U)};
+          in += 2;
+          std::size_t match_length{(token & NibbleMax)};
+          if (match_length==NibbleMax)
+            {
+              match_length += read_length(in, end);
+            }
+          match_length += MinMatch;
+          if ( offset==0U || offset>out.size()-base
+            || match_length>decompressed_size-(out.size()-base)
+             )
+            {
+              throw lz_codec_error{"Compressed data match out of range."};
+            }
+          auto from(out.size()-offset);
+          if (offset>=match_length)
+            {
+              out.append(out, from, match_length);
+            }
+          else
+            {
+              for (std::size_t i{0U}; i!=match_length; ++i)
+                {
+                  out += out[from+i];
+                }
+            }
+        }
+      if (out.size()-base!=decompressed_size)
+        {
+          throw lz_codec_error{"Compressed data decompressed size incorrect."};
+        }
+    }
+
+    std::string lz_decompress
+    ( char const * data
+    , std::size_t size
+    , std::size_t decompressed_size
+    )
+    {
+      std::string out;
+      lz_decompress(data, size, decompressed_size, out);
+      return out;
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
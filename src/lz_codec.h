@@ -0,0 +1,103 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file lz_codec.h
+/// @brief Small, fast LZ77 family codec for compressing chunk text.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Compressed data is a sequence of sequences, each being:
+///   - a token byte: high nibble literal length, low nibble match length - 4
+///     (a nibble value of 15 means further length bytes follow)
+///   - further literal length bytes: each adds its value, 255 means more follow
+///   - the literal bytes
+///   - a 2 byte little endian match offset (1..65535 bytes back)
+///   - further match length bytes, as for literal length
+/// The final sequence has only a token, literal length and literals. Favours
+/// speed over compression ratio: one hash table probe per position.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_LZ_CODEC_H
+# define DIBASE_BLOG_SIES_LZ_CODEC_H
+# include <string>
+# include <cstddef>
+# include <stdexcept>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Specific exception type for corrupt compressed data
+    class lz_codec_error : public std::runtime_error
+    {
+    public:
+    /// @brief Construct from C-string message
+      explicit lz_codec_error(char const * what_arg)
+      : std::runtime_error(what_arg)
+      {}
+    };
+
+  /// @brief Compress a block of data.
+  /// @param data   Start of data to compress.
+  /// @param size   Number of bytes to compress.
+  /// @returns Compressed data. Empty only if size is zero.
+    std::string lz_compress(char const * data, std::size_t size);
+
+  /// @brief Compress a string.
+  /// @param text   String to compress.
+  /// @returns Compressed text. Empty only if text is empty.
+    inline
+    std::string lz_compress(std::string const & text)
+    {
+      return lz_compress(text.data(), text.size());
+    }
+
+  /// @brief Decompress a block of data produced by lz_compress.
+  /// @param data               Start of compressed data.
+  /// @param size               Number of bytes of compressed data.
+  /// @param decompressed_size  Size of the original, uncompressed, data.
+  /// @returns Decompressed data.
+  /// @throws dibase::blog::sies::lz_codec_error if the compressed data is not
+  ///         valid or does not decompress to decompressed_size bytes.
+    std::string lz_decompress
+    ( char const * data
+    , std::size_t size
+    , std::size_t decompressed_size
+    );
+
+  /// @brief Decompress a block of data produced by lz_compress, appending
+  /// the decompressed data to out, so a caller may reuse out's memory.
+  /// @param data               Start of compressed data.
+  /// @param size               Number of bytes of compressed data.
+  /// @param decompressed_size  Size of the original, uncompressed, data.
+  /// @param out                String the decompressed data is appended to.
+  /// @throws dibase::blog::sies::lz_codec_error if the compressed data is not
+  ///         valid or does not decompress to decompressed_size bytes. Part
+  ///         of the data may have been appended to out.
+    void lz_decompress
+    ( char const * data
+    , std::size_t size
+    , std::size_t decompressed_size
+    , std::string & out
+    );
+
+  /// @brief Decompress a string produced by lz_compress.
+  /// @param compressed         Compressed data.
+  /// @param decompressed_size  Size of the original, uncompressed, data.
+  /// @returns Decompressed data.
+  /// @throws dibase::blog::sies::lz_codec_error if the compressed data is not
+  ///         valid or does not decompress to decompressed_size bytes.
+    inline
+    std::string lz_decompress
+    ( std::string const & compressed
+    , std::size_t decompressed_size
+    )
+    {
+      return lz_decompress( compressed.data(), compressed.size()
+                          , decompressed_size
+                          );
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_LZ_CODEC_H
@@ -0,0 +1,89 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file monotonic_arena.cpp
+/// @brief Monotonic (bump pointer) arena and an allocator that uses one.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "monotonic_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace
+    {
+      std::size_t const BlockHeaderSize
+                          {(sizeof(void*)+sizeof(std::size_t)+15U) & ~15U};
+    } // namespace
+
+    std::size_t const monotonic_arena::DefaultInitialBlockSize;
+    std::size_t const monotonic_arena::MaxBlockSize;
+
+    monotonic_arena::monotonic_arena(std::size_t initial_block_size)
+    : blocks{nullptr}
+    , next{nullptr}
+    , end{nullptr}
+    , next_block_size{std::max(initial_block_size, BlockHeaderSize+1U)}
+    , allocated{0U}
+    {}
+
+    monotonic_arena::~monotonic_arena()
+    {
+      while (blocks!=nullptr)
+        {
+          auto previous(blocks->previous);
+          ::operator delete(blocks);
+          blocks = previous;
+        }
+    }
+
+    void monotonic_arena::add_block(std::size_t min_size)
+    {
+      auto size(std::max(next_block_size, BlockHeaderSize+min_size));
+      auto b(static_cast<block *>(::operator new(size)));
+      b->previous = blocks;
+      b->size = size;
+      blocks = b;
+      next = reinterpret_cast<char *>(b) + BlockHeaderSize;
+      end = reinterpret_cast<char *>(b) + size;
+      next_block_size = std::min(next_block_size*2U, MaxBlockSize);
+    }
+
+    void * monotonic_arena::allocate(std::size_t size, std::size_t alignment)
+    {
+      auto aligned([alignment](char * p)
+                   {
+                     auto addr(reinterpret_cast<std::uintptr_t>(p));
+                     return reinterpret_cast<char *>
+                                ((addr+alignment-1U) & ~(alignment-1U));
+                   }
+                  );
+      auto p(next==nullptr ? nullptr : aligned(next));
+      if (p==nullptr || p>end || static_cast<std::size_t>(end-p)<size)
+        {
+          add_block(size+alignment);
+          p = aligned(next);
+        }
+      next = p + size;
+      allocated += size;
+      return p;
+    }
+
+    std::size_t monotonic_arena::bytes_reserved() const
+    {
+      std::size_t total{0U};
+      for (auto b(blocks); b!=nullptr; b=b->previous)
+        {
+          total += b->size;
+        }
+      return total;
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
@@ -0,0 +1,157 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file monotonic_arena.h
+/// @brief Monotonic (bump pointer) arena and an allocator that uses one.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Objects built during an exclusive setup phase and then destroyed as a
+/// whole - such as a registry's strings, vectors and map nodes - can be
+/// allocated from a monotonic_arena: allocation is a pointer bump, individual
+/// deallocations do nothing and all memory is released in one go when the
+/// arena is destroyed.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_MONOTONIC_ARENA_H
+# define DIBASE_BLOG_SIES_MONOTONIC_ARENA_H
+# include <cstddef>
+# include <new>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Bump pointer memory arena releasing all memory on destruction.
+  ///
+  /// Memory is obtained from the heap in blocks, each block twice the size of
+  /// the previous one up to a maximum, or larger if needed for a single
+  /// request. Not thread safe: intended for use by one thread at a time, such
+  /// as the creator thread of an object during setup.
+    class monotonic_arena
+    {
+    /// @brief Header at the start of each block, linking blocks for release.
+      struct block
+      {
+        block *     previous;
+        std::size_t size;
+      };
+
+      block *     blocks;
+      char *      next;
+      char *      end;
+      std::size_t next_block_size;
+      std::size_t allocated;
+
+      void add_block(std::size_t min_size);
+
+    public:
+    /// @brief Size of first block obtained if none specified.
+      static std::size_t const DefaultInitialBlockSize{64U*1024U};
+
+    /// @brief Largest size to which block sizes grow.
+      static std::size_t const MaxBlockSize{64U*1024U*1024U};
+
+    /// @brief Construct arena. No memory is obtained until first allocation.
+    /// @param initial_block_size   Size of first block to obtain.
+      explicit monotonic_arena
+      ( std::size_t initial_block_size = DefaultInitialBlockSize
+      );
+
+    /// @brief Destructor: releases all blocks.
+      ~monotonic_arena();
+
+      monotonic_arena(monotonic_arena const &) = delete;
+      monotonic_arena & operator=(monotonic_arena const &) = delete;
+      monotonic_arena(monotonic_arena &&) = delete;
+      monotonic_arena & operator=(monotonic_arena &&) = delete;
+
+    /// @brief Allocate memory from the arena.
+    /// @param size       Number of bytes required.
+    /// @param alignment  Required alignment, a power of 2 no larger than that
+    ///                   of std::max_align_t.
+    /// @returns Start of size bytes of suitably aligned memory.
+    /// @throws std::bad_alloc if memory cannot be obtained.
+      void * allocate(std::size_t size, std::size_t alignment);
+
+    /// @brief Deallocating arena memory has no effect: it is released when
+    /// the arena is destroyed.
+      void deallocate(void *, std::size_t) {}
+
+    /// @brief Returns number of bytes obtained from the heap for blocks.
+      std::size_t bytes_reserved() const;
+
+    /// @brief Returns number of bytes allocated from the arena.
+      std::size_t bytes_allocated() const { return allocated; }
+    };
+
+  /// @brief Stateful allocator allocating from a monotonic_arena.
+  ///
+  /// An allocator with no arena - as default constructed - allocates from the
+  /// heap, so containers using the allocator type may also be created
+  /// outside of any arena, for example transient lookup keys made while
+  /// querying. Allocators are equal if they use the same arena (or both none).
+  /// @param T  Type of object allocated.
+    template <typename T>
+    class arena_allocator
+    {
+      template <typename U> friend class arena_allocator;
+
+      monotonic_arena * arena;
+
+    public:
+      typedef T value_type;
+
+    /// @brief Construct allocator using the heap.
+      arena_allocator() noexcept : arena{nullptr} {}
+
+    /// @brief Construct allocator using an arena.
+    /// @param a    Arena to allocate from, or nullptr to use the heap.
+      explicit arena_allocator(monotonic_arena * a) noexcept : arena{a} {}
+
+    /// @brief Construct allocator for T using same arena as one for U.
+      template <typename U>
+      arena_allocator(arena_allocator<U> const & other) noexcept
+      : arena{other.arena}
+      {}
+
+    /// @brief Returns arena allocated from, nullptr if the heap.
+      monotonic_arena * resource() const noexcept { return arena; }
+
+      T * allocate(std::size_t n)
+      {
+        if (arena==nullptr)
+          {
+            return static_cast<T *>(::operator new(n*sizeof(T)));
+          }
+        return static_cast<T *>(arena->allocate(n*sizeof(T), alignof(T)));
+      }
+
+      void deallocate(T * p, std::size_t n)
+      {
+        if (arena==nullptr)
+          {
+            ::operator delete(p);
+          }
+        else
+          {
+            arena->deallocate(p, n*sizeof(T));
+          }
+      }
+
+      template <typename U>
+      bool operator==(arena_allocator<U> const & other) const noexcept
+      {
+        return arena==other.arena;
+      }
+
+      template <typename U>
+      bool operator!=(arena_allocator<U> const & other) const noexcept
+      {
+        return arena!=other.arena;
+      }
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_MONOTONIC_ARENA_H
@@ -0,0 +1,408 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file occurrence_tables.h
+/// @brief Occurrence table policies for basic_text_info chunk_info objects.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// A chunk_info holds two occurrence tables: one mapping characters, and one
+/// mapping words, to the number of times they occur in the chunk. The table
+/// type is chosen by an occurrence table policy, a type with a member alias
+/// template:
+///
+///     template <typename Key, typename Count, typename Allocator>
+///     using table_type = ...;
+///
+/// where Allocator is the text_info's allocator, to be rebound as required.
+/// A table type must provide, in the manner of std::map:
+///   - construction from an allocator and get_allocator(),
+///   - operator[] returning a reference to a key's count, inserting a zero
+///     count for a key not already in the table,
+///   - const find, begin, end and size, iterating over value_type objects
+///     having first (key) and second (count) members,
+///   - operator== and operator!=.
+/// Iteration order is unspecified: it need not be key order.
+///
+/// Three policies are provided:
+///   - map_occurrence_tables: std::map, the original chunk_info table type.
+///   - sorted_vector_occurrence_tables: a vector of key, count pairs sorted on
+///     key, searched using a binary search.
+///   - hash_occurrence_tables: an open addressing, linear probing hash table
+///     held in a single vector.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_OCCURRENCE_TABLES_H
+# define DIBASE_BLOG_SIES_OCCURRENCE_TABLES_H
+# include <map>
+# include <vector>
+# include <string>
+# include <utility>
+# include <iterator>
+# include <algorithm>
+# include <functional>
+# include <memory>
+# include <type_traits>
+# include <cstddef>
+# include <cstdint>
+# include "packed_word.h"
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Occurrence table policy selecting std::map tables.
+    struct map_occurrence_tables
+    {
+      template <typename Key, typename Count, typename Allocator>
+      using table_type
+            = std::map< Key, Count, std::less<Key>
+                      , typename std::allocator_traits<Allocator>::template
+                                    rebind_alloc<std::pair<Key const, Count>>
+                      >;
+    };
+
+  /// @brief Occurrence table held as a vector of entries sorted on key.
+  ///
+  /// Lookups are binary searches over contiguous entries. Inserting a key
+  /// moves all the entries following it, which is cheap for the few hundreds
+  /// of distinct keys of a typical chunk.
+  ///
+  /// @param Key        Key type: char or a string type.
+  /// @param Count      Count type.
+  /// @param Allocator  Allocator type, rebound to the entry type.
+    template <typename Key, typename Count, typename Allocator>
+    class sorted_vector_occurrence_table
+    {
+    public:
+      typedef Key                                         key_type;
+      typedef Count                                       mapped_type;
+      typedef std::pair<Key, Count>                       value_type;
+      typedef typename std::allocator_traits<Allocator>::template
+                                    rebind_alloc<value_type>  allocator_type;
+
+    private:
+      typedef std::vector<value_type, allocator_type>     entry_vector;
+
+      entry_vector entries;
+
+      static bool key_less(value_type const & entry, key_type const & key)
+      {
+        return entry.first<key;
+      }
+
+    public:
+      typedef typename entry_vector::const_iterator       const_iterator;
+      typedef const_iterator                              iterator;
+      typedef typename entry_vector::size_type            size_type;
+
+      explicit sorted_vector_occurrence_table
+      ( allocator_type const & alloc = allocator_type()
+      )
+      : entries(alloc)
+      {}
+
+      allocator_type get_allocator() const { return entries.get_allocator(); }
+
+      mapped_type & operator[](key_type const & key)
+      {
+        auto pos(std::lower_bound( entries.begin(), entries.end(), key
+                                 , key_less
+                                 ));
+        if (pos==entries.end() || pos->first!=key)
+          {
+            pos = entries.insert(pos, value_type{key, mapped_type{0U}});
+          }
+        return pos->second;
+      }
+
+      const_iterator find(key_type const & key) const
+      {
+        auto pos(std::lower_bound(entries.begin(), entries.end(), key, key_less));
+        return (pos==entries.end() || pos->first!=key) ? entries.end() : pos;
+      }
+
+      const_iterator begin() const { return entries.begin(); }
+      const_iterator end() const { return entries.end(); }
+      size_type size() const { return entries.size(); }
+      bool empty() const { return entries.empty(); }
+
+      bool operator==(sorted_vector_occurrence_table const & other) const
+      {
+        return entries==other.entries;
+      }
+
+      bool operator!=(sorted_vector_occurrence_table const & other) const
+      {
+        return !(*this==other);
+      }
+    };
+
+  /// @brief Occurrence table policy selecting sorted_vector_occurrence_table
+  /// tables.
+    struct sorted_vector_occurrence_tables
+    {
+      template <typename Key, typename Count, typename Allocator>
+      using table_type = sorted_vector_occurrence_table<Key, Count, Allocator>;
+    };
+
+  /// @brief Hash function used by hash_occurrence_table.
+  /// Characters hash to their (unsigned) values scrambled by a multiplicative
+  /// hash; strings use 64 bit FNV-1a; packed words their own hash.
+    struct occurrence_key_hash
+    {
+      std::uint64_t operator()(char key) const
+      {
+        return static_cast<unsigned char>(key)*0x9E3779B97F4A7C15ULL;
+      }
+
+      template <class Traits, class Alloc>
+      std::uint64_t operator()
+      ( std::basic_string<char, Traits, Alloc> const & key
+      ) const
+      {
+        std::uint64_t hash{0xcbf29ce484222325ULL};
+        for (auto chr : key)
+          {
+            hash = (hash ^ static_cast<unsigned char>(chr))*0x100000001b3ULL;
+          }
+        return hash;
+      }
+
+      template <std::size_t InlineSize, class Alloc>
+      std::uint64_t operator()
+      ( basic_packed_word<InlineSize, Alloc> const & key
+      ) const
+      {
+        return key.hash();
+      }
+    };
+
+  /// @brief Occurrence table held as an open addressing hash table.
+  ///
+  /// Entries are held in a single vector of slots, the number of slots
+  /// always a power of two, probed linearly from a key's hash. The table
+  /// doubles in size before more than half its slots are used, so a miss
+  /// typically inspects only a slot or two. Entries are never removed.
+  ///
+  /// @param Key        Key type: char or a string type.
+  /// @param Count      Count type.
+  /// @param Allocator  Allocator type, rebound to the slot type.
+    template <typename Key, typename Count, typename Allocator>
+    class hash_occurrence_table
+    {
+    public:
+      typedef Key                                         key_type;
+      typedef Count                                       mapped_type;
+      typedef std::pair<Key, Count>                       value_type;
+      typedef std::size_t                                 size_type;
+
+    private:
+      struct slot
+      {
+        value_type  entry;
+        bool        used;
+
+        explicit slot(value_type const & e) : entry(e), used{false} {}
+      };
+
+    public:
+      typedef typename std::allocator_traits<Allocator>::template
+                                    rebind_alloc<slot>    allocator_type;
+
+    private:
+      typedef std::vector<slot, allocator_type>           slot_vector;
+
+      static size_type const MinimumSlots{8U};
+
+      slot_vector slots;
+      size_type   number_used;
+
+    /// @brief Empty slot value: constructs key with the slot allocator so
+    /// string keys use the table's allocator.
+      value_type empty_entry() const
+      {
+        return empty_entry(slots.get_allocator(), std::is_same<key_type,char>{});
+      }
+
+      static value_type empty_entry(allocator_type const &, std::true_type)
+      {
+        return value_type{'\0', mapped_type{0U}};
+      }
+
+      static value_type empty_entry(allocator_type const & alloc, std::false_type)
+      {
+        return value_type{key_type(alloc), mapped_type{0U}};
+      }
+
+    /// @brief Returns index of key's slot, or of the unused slot it would
+    /// occupy. Requires at least one unused slot.
+      size_type probe(key_type const & key) const
+      {
+        auto mask(slots.size()-1U);
+        auto i(static_cast<size_type>(occurrence_key_hash{}(key)) & mask);
+        while (slots[i].used && slots[i].entry.first!=key)
+          {
+            i = (i+1U) & mask;
+          }
+        return i;
+      }
+
+      void grow()
+      {
+        slot_vector old( slots.size()==0U ? MinimumSlots : 2U*slots.size()
+                       , slot{empty_entry()}, slots.get_allocator()
+                       );
+        old.swap(slots);
+        for (auto & s : old)
+          {
+            if (s.used)
+              {
+                auto & dest(slots[probe(s.entry.first)]);
+                dest.entry = std::move(s.entry);
+                dest.used = true;
+              }
+          }
+      }
+
+    public:
+    /// @brief Forward iterator over used slots' entries.
+      class const_iterator
+      : public std::iterator<std::forward_iterator_tag, value_type const>
+      {
+        typename slot_vector::const_iterator pos;
+        typename slot_vector::const_iterator last;
+
+        void skip_unused()
+        {
+          while (pos!=last && !pos->used)
+            {
+              ++pos;
+            }
+        }
+
+      public:
+        const_iterator() = default;
+
+        const_iterator
+        ( typename slot_vector::const_iterator p
+        , typename slot_vector::const_iterator l
+        )
+        : pos(p)
+        , last(l)
+        {
+          skip_unused();
+        }
+
+        value_type const & operator*() const { return pos->entry; }
+        value_type const * operator->() const { return &pos->entry; }
+
+        const_iterator & operator++()
+        {
+          ++pos;
+          skip_unused();
+          return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+          auto prev(*this);
+          ++*this;
+          return prev;
+        }
+
+        bool operator==(const_iterator const & other) const
+        {
+          return pos==other.pos;
+        }
+
+        bool operator!=(const_iterator const & other) const
+        {
+          return pos!=other.pos;
+        }
+      };
+
+      typedef const_iterator                              iterator;
+
+      explicit hash_occurrence_table
+      ( allocator_type const & alloc = allocator_type()
+      )
+      : slots(alloc)
+      , number_used{0U}
+      {}
+
+      allocator_type get_allocator() const { return slots.get_allocator(); }
+
+      mapped_type & operator[](key_type const & key)
+      {
+        if (2U*(number_used+1U)>slots.size())
+          {
+            grow();
+          }
+        auto & s(slots[probe(key)]);
+        if (!s.used)
+          {
+            s.entry.first = key;
+            s.used = true;
+            ++number_used;
+          }
+        return s.entry.second;
+      }
+
+      const_iterator find(key_type const & key) const
+      {
+        if (number_used==0U)
+          {
+            return end();
+          }
+        auto i(probe(key));
+        return slots[i].used ? const_iterator{slots.begin()+i, slots.end()}
+                             : end();
+      }
+
+      const_iterator begin() const
+      {
+        return const_iterator{slots.begin(), slots.end()};
+      }
+
+      const_iterator end() const
+      {
+        return const_iterator{slots.end(), slots.end()};
+      }
+
+      size_type size() const { return number_used; }
+      bool empty() const { return number_used==0U; }
+
+      bool operator==(hash_occurrence_table const & other) const
+      {
+        if (number_used!=other.number_used)
+          {
+            return false;
+          }
+        for (auto const & entry : *this)
+          {
+            auto pos(other.find(entry.first));
+            if (pos==other.end() || pos->second!=entry.second)
+              {
+                return false;
+              }
+          }
+        return true;
+      }
+
+      bool operator!=(hash_occurrence_table const & other) const
+      {
+        return !(*this==other);
+      }
+    };
+
+  /// @brief Occurrence table policy selecting hash_occurrence_table tables.
+    struct hash_occurrence_tables
+    {
+      template <typename Key, typename Count, typename Allocator>
+      using table_type = hash_occurrence_table<Key, Count, Allocator>;
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_OCCURRENCE_TABLES_H
@@ -0,0 +1,381 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file packed_word.h
+/// @brief Word keys packing short words into integers.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_PACKED_WORD_H
+# define DIBASE_BLOG_SIES_PACKED_WORD_H
+# include <string>
+# include <memory>
+# include <algorithm>
+# include <utility>
+# include <cstring>
+# include <cstddef>
+# include <cstdint>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Word key holding short words packed into integers.
+  ///
+  /// The first InlineSize-1 bytes of a word are held in InlineSize/8 64 bit
+  /// integers, most significant byte first and zero padded, with the word's
+  /// length in the least significant byte of the last integer. Words of up
+  /// to InlineSize-1 bytes - the vast majority of words - are held entirely
+  /// inline and compared and hashed as integers. Longer words have a length
+  /// byte of LongWord and their remaining bytes held out of line in memory
+  /// obtained from the allocator.
+  ///
+  /// Because the integers are compared most significant first and shorter
+  /// words are zero padded, keys order as the words' bytes compared as
+  /// unsigned char values, shorter words first (i.e. as std::string does).
+  ///
+  /// @param InlineSize Size in bytes of the packed integers: 8 or 16.
+  /// @param Allocator  Allocator type, rebound to char, for long words' bytes.
+    template <std::size_t InlineSize, class Allocator = std::allocator<char>>
+    class basic_packed_word
+    : private std::allocator_traits<Allocator>::template rebind_alloc<char>
+    {
+      static_assert( InlineSize==8U || InlineSize==16U
+                   , "Packed word inline size must be 8 or 16 bytes."
+                   );
+
+    public:
+      typedef typename std::allocator_traits<Allocator>::template
+                                      rebind_alloc<char>  allocator_type;
+      typedef std::size_t                                 size_type;
+
+    /// @brief Maximum size of a word held entirely inline.
+      static size_type const MaxInlineSize{InlineSize-1U};
+
+    private:
+      typedef std::allocator_traits<allocator_type>       alloc_traits;
+
+      static size_type const NumberOfInts{InlineSize/8U};
+      static unsigned const LongWord{0xffU};
+
+      std::uint64_t packed[NumberOfInts];
+      char *        tail; ///< size_type tail size then tail bytes, if long
+
+      allocator_type & alloc() { return *this; }
+
+      unsigned length_byte() const
+      {
+        return static_cast<unsigned>(packed[NumberOfInts-1U] & 0xffU);
+      }
+
+      size_type tail_size() const
+      {
+        size_type size{0U};
+        if (tail!=nullptr)
+          {
+            std::memcpy(&size, tail, sizeof(size));
+          }
+        return size;
+      }
+
+      char const * tail_data() const { return tail+sizeof(size_type); }
+
+    /// @brief Sets word, which has no tail, from size bytes at data,
+    /// lowercasing [A-Z] if fold. The word is unchanged if allocating a tail
+    /// throws.
+      void assign(char const * data, size_type size, bool fold)
+      {
+        char * long_tail{nullptr};
+        if (size>MaxInlineSize)
+          {
+            long_tail = new_tail(data+MaxInlineSize, size-MaxInlineSize);
+            if (fold)
+              {
+                auto first(long_tail+sizeof(size_type));
+                for (auto p=first; p!=first+size-MaxInlineSize; ++p)
+                  {
+                    if ('A'<=*p && *p<='Z')
+                      {
+                        *p += 'a'-'A';
+                      }
+                  }
+              }
+          }
+        for (auto & p : packed)
+          {
+            p = 0U;
+          }
+        auto inline_size(size<=MaxInlineSize ? size : MaxInlineSize);
+        for (size_type i{0U}; i!=inline_size; ++i)
+          {
+            auto chr(static_cast<unsigned char>(data[i]));
+            if (fold && 'A'<=chr && chr<='Z')
+              {
+                chr += 'a'-'A';
+              }
+            packed[i/8U] |= std::uint64_t{chr} << (56U-8U*(i%8U));
+          }
+        packed[NumberOfInts-1U] |= size<=MaxInlineSize ? size : LongWord;
+        tail = long_tail;
+      }
+
+    /// @brief Returns a new tail holding size bytes at data.
+      char * new_tail(char const * data, size_type size)
+      {
+        auto t(alloc_traits::allocate(alloc(), sizeof(size_type)+size));
+        std::memcpy(t, &size, sizeof(size));
+        std::memcpy(t+sizeof(size_type), data, size);
+        return t;
+      }
+
+      void release_tail()
+      {
+        if (tail!=nullptr)
+          {
+            alloc_traits::deallocate(alloc(), tail, sizeof(size_type)+tail_size());
+            tail = nullptr;
+          }
+      }
+
+    /// @brief Forgets any tail, which must have been taken by another word,
+    /// and makes the word empty.
+      void make_empty()
+      {
+        std::memset(packed, 0, sizeof(packed));
+        tail = nullptr;
+      }
+
+    /// @brief Replaces the word with a copy of other, keeping this word's
+    /// allocator. The word is unchanged if allocating a tail throws.
+      void copy_from(basic_packed_word const & other)
+      {
+        auto other_tail( other.tail!=nullptr
+                       ? new_tail(other.tail_data(), other.tail_size())
+                       : nullptr
+                       );
+        release_tail();
+        std::memcpy(packed, other.packed, sizeof(packed));
+        tail = other_tail;
+      }
+
+    public:
+    /// @brief Construct empty word.
+      explicit basic_packed_word(allocator_type const & a = allocator_type())
+      : allocator_type(a)
+      , packed{}
+      , tail{nullptr}
+      {}
+
+    /// @brief Construct from a word's bytes.
+    /// @param data   Pointer to word's first byte.
+    /// @param size   Number of bytes in word.
+    /// @param a      Allocator for bytes of long words.
+      basic_packed_word
+      ( char const * data
+      , size_type size
+      , allocator_type const & a = allocator_type()
+      )
+      : allocator_type(a)
+      , tail{nullptr}
+      {
+        assign(data, size, false);
+      }
+
+    /// @brief Implicit construction from a word as a C-string.
+      basic_packed_word(char const * word)
+      : tail{nullptr}
+      {
+        assign(word, std::strlen(word), false);
+      }
+
+    /// @brief Implicit construction from a word as a string.
+      template <class Traits, class Alloc>
+      basic_packed_word(std::basic_string<char, Traits, Alloc> const & word)
+      : tail{nullptr}
+      {
+        assign(word.data(), word.size(), false);
+      }
+
+    /// @brief Make a key for a word with characters [A-Z] replaced by [a-z].
+    /// @param data   Pointer to word's first byte.
+    /// @param size   Number of bytes in word.
+    /// @param a      Allocator for bytes of long words.
+    /// @returns Case folded word key.
+      static basic_packed_word folded
+      ( char const * data
+      , size_type size
+      , allocator_type const & a = allocator_type()
+      )
+      {
+        basic_packed_word key{a};
+        key.assign(data, size, true);
+        return key;
+      }
+
+      basic_packed_word(basic_packed_word const & other)
+      : allocator_type(alloc_traits::select_on_container_copy_construction(other))
+      , tail{nullptr}
+      {
+        copy_from(other);
+      }
+
+      basic_packed_word(basic_packed_word && other) noexcept
+      : allocator_type(std::move(static_cast<allocator_type &>(other)))
+      , tail{other.tail}
+      {
+        std::memcpy(packed, other.packed, sizeof(packed));
+        other.make_empty();
+      }
+
+    /// @brief Copy assignment: keeps this word's allocator.
+      basic_packed_word & operator=(basic_packed_word const & other)
+      {
+        if (this!=&other)
+          {
+            copy_from(other);
+          }
+        return *this;
+      }
+
+    /// @brief Move assignment: keeps this word's allocator, taking other's
+    /// bytes only if they were allocated by an equal allocator.
+      basic_packed_word & operator=(basic_packed_word && other)
+      {
+        if (this!=&other)
+          {
+            if (alloc()==other.alloc())
+              {
+                release_tail();
+                std::memcpy(packed, other.packed, sizeof(packed));
+                tail = other.tail;
+                other.make_empty();
+              }
+            else
+              {
+                copy_from(other);
+              }
+          }
+        return *this;
+      }
+
+      ~basic_packed_word()
+      {
+        release_tail();
+      }
+
+      allocator_type get_allocator() const { return *this; }
+
+    /// @brief Returns true if the word is held entirely inline.
+      bool is_inline() const { return tail==nullptr; }
+
+    /// @brief Returns number of bytes in word.
+      size_type size() const
+      {
+        return tail==nullptr ? length_byte() : MaxInlineSize+tail_size();
+      }
+
+      bool empty() const { return size()==0U; }
+
+    /// @brief Copies the word's bytes to dest, which must have room for size()
+    /// bytes.
+      void copy(char * dest) const
+      {
+        auto inline_size(tail==nullptr ? length_byte() : MaxInlineSize);
+        for (size_type i{0U}; i!=inline_size; ++i)
+          {
+            dest[i] = static_cast<char>(packed[i/8U] >> (56U-8U*(i%8U)));
+          }
+        if (tail!=nullptr)
+          {
+            std::memcpy(dest+MaxInlineSize, tail_data(), tail_size());
+          }
+      }
+
+    /// @brief Returns the word as a string.
+      std::string str() const
+      {
+        std::string word(size(), '\0');
+        copy(&word[0]);
+        return word;
+      }
+
+    /// @brief Returns hash of word: a mix of the packed integers and, for
+    /// long words, of the out of line bytes.
+      std::uint64_t hash() const
+      {
+        std::uint64_t h{0U};
+        for (auto p : packed)
+          {
+            h = (h ^ p)*0x9E3779B97F4A7C15ULL;
+            h ^= h >> 29U;
+          }
+        if (tail!=nullptr)
+          {
+            auto first(reinterpret_cast<unsigned char const *>(tail_data()));
+            for (auto p=first; p!=first+tail_size(); ++p)
+              {
+                h = (h ^ *p)*0x100000001b3ULL;
+              }
+          }
+        return h;
+      }
+
+      friend bool operator==
+      ( basic_packed_word const & lhs
+      , basic_packed_word const & rhs
+      )
+      {
+        for (size_type i{0U}; i!=NumberOfInts; ++i)
+          {
+            if (lhs.packed[i]!=rhs.packed[i])
+              {
+                return false;
+              }
+          }
+        return lhs.tail==nullptr
+            || ( lhs.tail_size()==rhs.tail_size()
+              && std::memcmp(lhs.tail_data(), rhs.tail_data(), lhs.tail_size())==0
+               );
+      }
+
+      friend bool operator!=
+      ( basic_packed_word const & lhs
+      , basic_packed_word const & rhs
+      )
+      {
+        return !(lhs==rhs);
+      }
+
+      friend bool operator<
+      ( basic_packed_word const & lhs
+      , basic_packed_word const & rhs
+      )
+      {
+        for (size_type i{0U}; i!=NumberOfInts; ++i)
+          {
+            if (lhs.packed[i]!=rhs.packed[i])
+              {
+                return lhs.packed[i]<rhs.packed[i];
+              }
+          }
+        if (lhs.tail==nullptr)
+          {
+            return false; // rhs equal so also inline
+          }
+        auto common(std::min(lhs.tail_size(), rhs.tail_size()));
+        auto result(std::memcmp(lhs.tail_data(), rhs.tail_data(), common));
+        return result<0 || (result==0 && lhs.tail_size()<rhs.tail_size());
+      }
+    };
+
+    template <std::size_t InlineSize, class Allocator>
+    typename basic_packed_word<InlineSize, Allocator>::size_type const
+              basic_packed_word<InlineSize, Allocator>::MaxInlineSize;
+
+  /// @brief Word key with up to 15 byte words held inline.
+    typedef basic_packed_word<16U> packed_word;
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_PACKED_WORD_H
@@ -0,0 +1,343 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file publication_holder.h
+/// @brief RCU style holder for replaceable published immutable objects.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Defines a class template that holds a pointer to the current version of a
+/// published (immutable) object - such as a text_registry that has completed
+/// its setup - and allows a newer version to be atomically swapped in while
+/// reader threads continue to use older versions. Retired versions are
+/// reclaimed using epoch based reclamation: each registered reader has its own
+/// epoch slot so the read path neither locks nor updates any shared reference
+/// count.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_PUBLICATION_HOLDER_H
+# define DIBASE_BLOG_SIES_PUBLICATION_HOLDER_H
+# include <atomic>
+# include <memory>
+# include <mutex>
+# include <vector>
+# include <cstdint>
+# include <stdexcept>
+# include <limits>
+# include <new>
+# include <type_traits>
+# include <cstdlib>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Specific exception type for running out of reader slots
+    class reader_slots_exhausted : public std::runtime_error
+    {
+    public:
+    /// @brief Construct from C-string message
+      explicit reader_slots_exhausted(char const * what_arg)
+      : std::runtime_error(what_arg)
+      {}
+    };
+
+  /// @brief Holder of current published version of an immutable object.
+  ///
+  /// Updater threads pass ownership of fully setup, published, objects to
+  /// publish, which atomically replaces the current version and retires the
+  /// previous one. Reader threads each register once to obtain a reader
+  /// handle, then pin the current version for the duration of each group of
+  /// queries. A pin costs one load of the global epoch, one store to the
+  /// reader's own slot and one load of the current pointer - that is reads
+  /// are wait-free.
+  ///
+  /// Retired versions are deleted once no reader slot holds an epoch at or
+  /// before that in which the version was retired, either during a later
+  /// publish or an explicit call to reclaim.
+  ///
+  /// @param T  Type of object held. Readers only have const access to
+  ///           held objects.
+    template <class T>
+    class publication_holder
+    {
+    /// @brief Per-reader epoch slot, on its own cache line to prevent
+    /// false sharing. An epoch value of zero means the reader is not pinned.
+      struct alignas(64) reader_slot
+      {
+        std::atomic<std::uint64_t>  epoch;
+        std::atomic<bool>           in_use;
+
+        reader_slot() : epoch{0U}, in_use{false} {}
+      };
+      static_assert( sizeof(reader_slot)==64U
+                   , "publication_holder reader_slot not one cache line"
+                   );
+      static_assert( std::is_trivially_destructible<reader_slot>::value
+                   , "publication_holder reader_slot destructor not trivial"
+                   );
+
+    /// @brief Frees slot arrays allocated by allocate_slots. As reader_slot
+    /// destruction is trivial the slots are not destroyed.
+      struct slots_deleter
+      {
+        void operator()(reader_slot * s) const { std::free(s); }
+      };
+      typedef std::unique_ptr<reader_slot[], slots_deleter> slot_array;
+
+    /// @brief Helper: allocate count cache line aligned slots. Operator new
+    /// does not honour over-alignment before C++17, so posix_memalign is used.
+    /// @throws std::bad_alloc if memory cannot be allocated.
+      static slot_array allocate_slots(std::size_t count)
+      {
+        void * memory{nullptr};
+        if (::posix_memalign( &memory, alignof(reader_slot)
+                            , (count==0U ? 1U : count)*sizeof(reader_slot)
+                            )!=0
+           )
+          {
+            throw std::bad_alloc{};
+          }
+        auto s(static_cast<reader_slot *>(memory));
+        for (std::size_t i{0U}; i!=count; ++i)
+          {
+            new (s+i) reader_slot;
+          }
+        return slot_array{s};
+      }
+
+    /// @brief Retired version and the epoch in which it was retired
+      struct retired_version
+      {
+        T const *     ptr;
+        std::uint64_t epoch;
+      };
+
+      std::atomic<T const *>          current;
+      std::atomic<std::uint64_t>      global_epoch;
+      std::size_t                     number_of_slots;
+      slot_array                      slots;
+      std::mutex                      update_mutex;
+      std::vector<retired_version>    retired;
+
+    /// @brief Helper: delete retired versions no pinned reader can be using.
+    /// Must be called with update_mutex locked.
+      void reclaim_retired()
+      {
+        std::uint64_t oldest_pinned{std::numeric_limits<std::uint64_t>::max()};
+        for (std::size_t i{0U}; i!=number_of_slots; ++i)
+          {
+            auto pinned(slots[i].epoch.load(std::memory_order_seq_cst));
+            if (pinned!=0U && pinned<oldest_pinned)
+              {
+                oldest_pinned = pinned;
+              }
+          }
+        auto keep(retired.begin());
+        for (auto & version : retired)
+          {
+            if (version.epoch<oldest_pinned)
+              {
+                delete version.ptr;
+              }
+            else
+              {
+                *keep++ = version;
+              }
+          }
+        retired.erase(keep, retired.end());
+      }
+
+    public:
+      class reader;
+
+    /// @brief Scoped pin of the current version for one reader.
+    ///
+    /// Provides const pointer-like access to the version that was current
+    /// when the guard was created. That version will not be reclaimed until
+    /// the guard is destroyed.
+      class read_guard
+      {
+        friend class reader;
+        reader *  owner;
+        T const * version;
+
+        read_guard(reader & r, T const * v) : owner{&r}, version{v} {}
+
+      public:
+        read_guard(read_guard const &) = delete;
+        read_guard & operator=(read_guard const &) = delete;
+        read_guard & operator=(read_guard &&) = delete;
+
+      /// @brief Move construct: other no longer unpins on destruction.
+        read_guard(read_guard && other)
+        : owner{other.owner}
+        , version{other.version}
+        {
+          other.owner = nullptr;
+        }
+
+      /// @brief Destructor : unpin the reader if this is its outermost pin.
+        ~read_guard()
+        {
+          if (owner)
+            {
+              owner->unpin();
+            }
+        }
+
+      /// @brief Returns pinned version, null if nothing published yet.
+        T const * get() const { return version; }
+        T const * operator->() const { return version; }
+        T const & operator*() const { return *version; }
+        explicit operator bool() const { return version!=nullptr; }
+      };
+
+    /// @brief Per-thread reader registration handle.
+    ///
+    /// Obtained from publication_holder::register_reader. Owns one reader
+    /// slot for its lifetime. A reader must only be used by one thread at
+    /// a time, and must not outlive the holder it was registered with.
+      class reader
+      {
+        friend class publication_holder;
+        friend class read_guard;
+        publication_holder *  holder;
+        reader_slot *         slot;
+        unsigned              pin_depth;
+
+        reader(publication_holder & h, reader_slot & s)
+        : holder{&h}, slot{&s}, pin_depth{0U}
+        {}
+
+        void unpin()
+        {
+          if (--pin_depth==0U)
+            {
+              slot->epoch.store(0U, std::memory_order_release);
+            }
+        }
+
+      public:
+        reader(reader const &) = delete;
+        reader & operator=(reader const &) = delete;
+        reader & operator=(reader &&) = delete;
+
+      /// @brief Move construct: other no longer owns a slot.
+        reader(reader && other)
+        : holder{other.holder}
+        , slot{other.slot}
+        , pin_depth{other.pin_depth}
+        {
+          other.slot = nullptr;
+        }
+
+      /// @brief Destructor : release the owned reader slot.
+        ~reader()
+        {
+          if (slot)
+            {
+              slot->epoch.store(0U, std::memory_order_release);
+              slot->in_use.store(false, std::memory_order_release);
+            }
+        }
+
+      /// @brief Pin and return access to the current published version.
+      /// Pins may be nested; the reader is unpinned when the outermost
+      /// guard is destroyed, and nested guards see the version current at
+      /// the time they were created.
+      /// @returns read_guard for the current version.
+        read_guard pin()
+        {
+          if (pin_depth++==0U)
+            {
+              slot->epoch.store( holder->global_epoch.load
+                                                  (std::memory_order_acquire)
+                               , std::memory_order_seq_cst
+                               );
+            }
+          return read_guard
+                 {*this, holder->current.load(std::memory_order_seq_cst)};
+        }
+      };
+
+    /// @brief Construct empty holder with fixed number of reader slots.
+    /// @param max_readers  Maximum number of concurrently registered readers.
+      explicit publication_holder(std::size_t max_readers)
+      : current{nullptr}
+      , global_epoch{1U}
+      , number_of_slots{max_readers}
+      , slots{allocate_slots(max_readers)}
+      {}
+
+      publication_holder(publication_holder const &) = delete;
+      publication_holder & operator=(publication_holder const &) = delete;
+      publication_holder(publication_holder &&) = delete;
+      publication_holder & operator=(publication_holder &&) = delete;
+
+    /// @brief Destructor : delete current and all retired versions.
+    /// All readers should have been destroyed before the holder.
+      ~publication_holder()
+      {
+        for (auto & version : retired)
+          {
+            delete version.ptr;
+          }
+        delete current.load();
+      }
+
+    /// @brief Register a reader, claiming a free reader slot.
+    /// @returns reader handle owning a reader slot.
+    /// @throws dibase::blog::sies::reader_slots_exhausted if all reader
+    ///         slots are in use.
+      reader register_reader()
+      {
+        for (std::size_t i{0U}; i!=number_of_slots; ++i)
+          {
+            bool free_slot{false};
+            if (slots[i].in_use.compare_exchange_strong(free_slot, true))
+              {
+                return reader{*this, slots[i]};
+              }
+          }
+        throw reader_slots_exhausted{"No free publication_holder reader slots."};
+      }
+
+    /// @brief Atomically make a new version current, retiring the old one.
+    /// The new version should be fully setup (published) as readers may
+    /// access it as soon as this call has swapped it in. Also attempts to
+    /// reclaim previously retired versions.
+    /// @param version  Owning pointer to the new current version.
+      void publish(std::unique_ptr<T const> version)
+      {
+        std::lock_guard<std::mutex> lock{update_mutex};
+        auto old(current.exchange(version.release(), std::memory_order_seq_cst));
+        auto retire_epoch(global_epoch.fetch_add(1U, std::memory_order_seq_cst));
+        if (old)
+          {
+            retired.push_back(retired_version{old, retire_epoch});
+          }
+        reclaim_retired();
+      }
+
+    /// @brief Attempt to delete retired versions no longer pinned by readers.
+    /// @returns Number of retired versions still awaiting reclamation.
+      std::size_t reclaim()
+      {
+        std::lock_guard<std::mutex> lock{update_mutex};
+        reclaim_retired();
+        return retired.size();
+      }
+
+    /// @brief Unvalidated query of current version without pinning it.
+    /// Only safe to dereference while no other thread can publish.
+    /// @returns Current version, null if nothing published yet.
+      T const * unsafe_current() const
+      {
+        return current.load(std::memory_order_acquire);
+      }
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_PUBLICATION_HOLDER_H
@@ -0,0 +1,238 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file query_protocol.cpp
+/// @brief Compact binary protocol for querying a published text registry.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "query_protocol.h"
+
+#include <cstring>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace query_protocol
+    {
+      namespace
+      {
+      /// @brief Size of length, id and opcode or status fields.
+        std::size_t const FrameHeaderSize{4U+4U+1U};
+
+      /// @brief Largest text result that fits in a frame.
+        std::size_t const MaxResponseTextSize{0xffffffffU - 4U - 1U};
+
+      /// @brief Operands carried by a request, by opcode.
+        struct operands
+        {
+          bool index;
+          bool chr;
+          bool word;
+          bool known;
+        };
+
+        operands operands_of(opcode op)
+        {
+          switch (op)
+            {
+            case opcode::number_of_chunks:
+            case opcode::text:
+            case opcode::char_count:
+            case opcode::word_count:
+              return operands{false, false, false, true};
+            case opcode::chunk_text:
+            case opcode::chunk_char_count:
+            case opcode::chunk_word_count:
+              return operands{true, false, false, true};
+            case opcode::chunk_char_occurrence:
+              return operands{true, true, false, true};
+            case opcode::chunk_word_occurrence:
+              return operands{true, false, true, true};
+            case opcode::char_occurrence:
+              return operands{false, true, false, true};
+            case opcode::word_occurrence:
+              return operands{false, false, true, true};
+            default:
+              return operands{false, false, false, false};
+            }
+        }
+
+        template <typename T>
+        void append_pod(std::string & buffer, T value)
+        {
+          buffer.append(reinterpret_cast<char const *>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        T read_pod(char const * data)
+        {
+          T value;
+          std::memcpy(&value, data, sizeof(value));
+          return value;
+        }
+
+      /// @brief Read frame length, returning 0 if frame incomplete.
+        std::size_t frame_size(char const * data, std::size_t size)
+        {
+          if (size<sizeof(std::uint32_t))
+            {
+              return 0U;
+            }
+          std::size_t total{sizeof(std::uint32_t)
+                           + read_pod<std::uint32_t>(data)};
+          return total<=size ? total : 0U;
+        }
+      } // namespace
+
+      bool has_text_result(opcode op)
+      {
+        return op==opcode::chunk_text || op==opcode::text;
+      }
+
+      void append_request(std::string & buffer, request const & req)
+      {
+        auto ops(operands_of(req.op));
+        std::uint32_t length(4U + 1U + (ops.index ? 8U : 0U) + (ops.chr ? 1U : 0U)
+                            + (ops.word ? req.word.size() : 0U));
+        append_pod(buffer, length);
+        append_pod(buffer, req.id);
+        append_pod(buffer, static_cast<std::uint8_t>(req.op));
+        if (ops.index)
+          {
+            append_pod(buffer, req.chunk_index);
+          }
+        if (ops.chr)
+          {
+            buffer += req.chr;
+          }
+        if (ops.word)
+          {
+            buffer += req.word;
+          }
+      }
+
+      std::size_t parse_request
+      ( char const * data
+      , std::size_t size
+      , request & req
+      )
+      {
+        if ( size>=sizeof(std::uint32_t)
+          && read_pod<std::uint32_t>(data)>MaxRequestLength
+           )
+          {
+            throw query_protocol_error{"Request frame too long."};
+          }
+        auto total(frame_size(data, size));
+        if (total==0U)
+          {
+            return 0U;
+          }
+        req = request{0U, opcode::invalid, 0U, '\0', std::string{}};
+        if (total<FrameHeaderSize)
+          {
+            return total;
+          }
+        req.id = read_pod<std::uint32_t>(data+4U);
+        auto op(static_cast<opcode>(read_pod<std::uint8_t>(data+8U)));
+        auto ops(operands_of(op));
+        std::size_t pos{FrameHeaderSize};
+        std::size_t fixed{(ops.index ? 8U : 0U) + (ops.chr ? 1U : 0U)};
+        if ( !ops.known
+          || total-pos<fixed
+          || (!ops.word && total-pos!=fixed)
+           )
+          {
+            return total;
+          }
+        if (ops.index)
+          {
+            req.chunk_index = read_pod<std::uint64_t>(data+pos);
+            pos += 8U;
+          }
+        if (ops.chr)
+          {
+            req.chr = data[pos++];
+          }
+        if (ops.word)
+          {
+            req.word.assign(data+pos, total-pos);
+          }
+        req.op = op;
+        return total;
+      }
+
+      void append_response
+      ( std::string & buffer
+      , response const & resp
+      , opcode op
+      )
+      {
+        bool text{has_text_result(op)};
+        bool ok{ resp.result==status::ok
+              && (!text || resp.text.size()<=MaxResponseTextSize)
+               };
+        std::uint32_t length(4U + 1U + (ok ? (text ? resp.text.size() : 8U) : 0U));
+        append_pod(buffer, length);
+        append_pod(buffer, resp.id);
+        append_pod(buffer, static_cast<std::uint8_t>
+                              (ok ? status::ok
+                                  : (resp.result==status::ok ? status::failed
+                                                             : resp.result)
+                              ));
+        if (ok && text)
+          {
+            buffer += resp.text;
+          }
+        else if (ok)
+          {
+            append_pod(buffer, resp.count);
+          }
+      }
+
+      std::size_t parse_response
+      ( char const * data
+      , std::size_t size
+      , opcode op
+      , response & resp
+      )
+      {
+        auto total(frame_size(data, size));
+        if (total==0U)
+          {
+            return 0U;
+          }
+        if (total<FrameHeaderSize)
+          {
+            throw query_protocol_error{"Response frame too short."};
+          }
+        resp = response{ read_pod<std::uint32_t>(data+4U)
+                       , static_cast<status>(read_pod<std::uint8_t>(data+8U))
+                       , 0U
+                       , std::string{}
+                       };
+        if (resp.result!=status::ok)
+          {
+            return total;
+          }
+        if (has_text_result(op))
+          {
+            resp.text.assign(data+FrameHeaderSize, total-FrameHeaderSize);
+          }
+        else if (total-FrameHeaderSize==8U)
+          {
+            resp.count = read_pod<std::uint64_t>(data+FrameHeaderSize);
+          }
+        else
+          {
+            throw query_protocol_error{"Response frame count size incorrect."};
+          }
+        return total;
+      }
+    } // namespace query_protocol
+  } // namespace sies
+}} // namespaces dibase::blog
@@ -0,0 +1,212 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file query_protocol.h
+/// @brief Compact binary protocol for querying a published text registry.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Requests and responses are framed messages intended for a local (Unix
+/// domain socket) connection so integers are in host byte order. Clients may
+/// pipeline requests - send many without waiting for responses - and a server
+/// answers every complete request it has received in one batch. Responses are
+/// sent in request order and carry the id of the request they answer.
+///
+/// Request frame:
+///   - std::uint32_t  length of rest of frame
+///   - std::uint32_t  request id (client chosen)
+///   - std::uint8_t   opcode
+///   - operands, by opcode: std::uint64_t chunk index, then char or word
+///     (the word being the rest of the frame)
+///
+/// Response frame:
+///   - std::uint32_t  length of rest of frame
+///   - std::uint32_t  request id
+///   - std::uint8_t   status
+///   - result: std::uint64_t count, or text (the rest of the frame)
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_QUERY_PROTOCOL_H
+# define DIBASE_BLOG_SIES_QUERY_PROTOCOL_H
+# include <cstdint>
+# include <cstddef>
+# include <stdexcept>
+# include <string>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Specific exception type for malformed protocol frames
+    class query_protocol_error : public std::runtime_error
+    {
+    public:
+    /// @brief Construct from C-string message
+      explicit query_protocol_error(char const * what_arg)
+      : std::runtime_error(what_arg)
+      {}
+    };
+
+    namespace query_protocol
+    {
+    /// @brief Largest frame length accepted, excluding the length field.
+      std::uint32_t const MaxRequestLength{64U*1024U};
+
+    /// @brief Query operations, one per text_registry immutable operation.
+      enum class opcode : std::uint8_t
+      { invalid = 0           ///< Decoded from malformed request frames
+      , number_of_chunks
+      , chunk_text
+      , chunk_char_count
+      , chunk_word_count
+      , chunk_char_occurrence
+      , chunk_word_occurrence
+      , text
+      , char_count
+      , word_count
+      , char_occurrence
+      , word_occurrence
+      };
+
+    /// @brief Response status values.
+      enum class status : std::uint8_t
+      { ok = 0
+      , bad_request
+      , out_of_range
+      , failed
+      };
+
+    /// @brief Decoded request. Only the operands used by op are relevant.
+      struct request
+      {
+        std::uint32_t id;
+        opcode        op;
+        std::uint64_t chunk_index;
+        char          chr;
+        std::string   word;
+      };
+
+    /// @brief Decoded response. Text results are in text, others in count.
+      struct response
+      {
+        std::uint32_t id;
+        status        result;
+        std::uint64_t count;
+        std::string   text;
+      };
+
+    /// @brief Returns true if responses to op carry text rather than a count.
+      bool has_text_result(opcode op);
+
+    /// @brief Append encoded request frame to buffer.
+      void append_request(std::string & buffer, request const & req);
+
+    /// @brief Try to decode a request frame from start of data.
+    /// @param data     Received bytes.
+    /// @param size     Number of received bytes.
+    /// @param req      Receives decoded request.
+    /// @returns Number of bytes of the frame consumed, 0 if data does not
+    ///          yet hold a whole frame. A complete but malformed frame (unknown
+    ///          opcode, missing or surplus operands) is consumed and decoded
+    ///          as a request with opcode invalid.
+    /// @throws dibase::blog::sies::query_protocol_error if the frame length
+    ///         exceeds MaxRequestLength.
+      std::size_t parse_request
+      ( char const * data
+      , std::size_t size
+      , request & req
+      );
+
+    /// @brief Append encoded response frame to buffer.
+    /// @param buffer   Buffer to append to.
+    /// @param resp     Response to encode.
+    /// @param op       Opcode of the request the response answers.
+      void append_response
+      ( std::string & buffer
+      , response const & resp
+      , opcode op
+      );
+
+    /// @brief Try to decode a response frame from start of data.
+    /// @param data     Received bytes.
+    /// @param size     Number of received bytes.
+    /// @param op       Opcode of the request the response answers.
+    /// @param resp     Receives decoded response.
+    /// @returns Number of bytes of the frame consumed, 0 if data does not
+    ///          yet hold a whole frame.
+    /// @throws dibase::blog::sies::query_protocol_error if the frame is
+    ///         malformed.
+      std::size_t parse_response
+      ( char const * data
+      , std::size_t size
+      , opcode op
+      , response & resp
+      );
+
+    /// @brief Execute request against a registry-like object.
+    ///
+    /// Function template as any type providing the text_info query
+    /// operations may be used - text_registry, text_info, text_image_view.
+    /// @param reg      Object to query.
+    /// @param req      Request to execute.
+    /// @returns Response to request.
+      template <class RegistryT>
+      response execute(RegistryT const & reg, request const & req)
+      {
+        response resp{req.id, status::ok, 0U, std::string{}};
+        try
+          {
+            switch (req.op)
+              {
+              case opcode::number_of_chunks:
+                resp.count = reg.number_of_chunks();
+                break;
+              case opcode::chunk_text:
+                resp.text = reg.chunk_text(req.chunk_index);
+                break;
+              case opcode::chunk_char_count:
+                resp.count = reg.chunk_char_count(req.chunk_index);
+                break;
+              case opcode::chunk_word_count:
+                resp.count = reg.chunk_word_count(req.chunk_index);
+                break;
+              case opcode::chunk_char_occurrence:
+                resp.count = reg.chunk_char_occurrence(req.chunk_index, req.chr);
+                break;
+              case opcode::chunk_word_occurrence:
+                resp.count = reg.chunk_word_occurrence(req.chunk_index, req.word);
+                break;
+              case opcode::text:
+                resp.text = reg.text();
+                break;
+              case opcode::char_count:
+                resp.count = reg.char_count();
+                break;
+              case opcode::word_count:
+                resp.count = reg.word_count();
+                break;
+              case opcode::char_occurrence:
+                resp.count = reg.char_occurrence(req.chr);
+                break;
+              case opcode::word_occurrence:
+                resp.count = reg.word_occurrence(req.word);
+                break;
+              default:
+                resp.result = status::bad_request;
+              }
+          }
+        catch (std::out_of_range &)
+          {
+            resp.result = status::out_of_range;
+          }
+        catch (std::exception &)
+          {
+            resp.result = status::failed;
+          }
+        return resp;
+      }
+    } // namespace query_protocol
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_QUERY_PROTOCOL_H
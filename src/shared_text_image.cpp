@@ -0,0 +1,173 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file shared_text_image.cpp
+/// @brief Text images shared between processes via POSIX shared memory.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "shared_text_image.h"
+
+#include <system_error>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace
+    {
+      [[noreturn]] void throw_errno(std::string const & what)
+      {
+        throw std::system_error{errno, std::system_category(), what};
+      }
+
+    /// @brief Closes file descriptor on scope exit.
+      struct fd_closer
+      {
+        int fd;
+        ~fd_closer() { ::close(fd); }
+      };
+
+    /// @brief Creates shared memory object name of length bytes, has
+    /// write_image write the image to its memory then makes it readable.
+      template <typename WriteImage>
+      void export_image
+      ( std::string const & name
+      , std::uint64_t length
+      , WriteImage const & write_image
+      )
+      {
+      // Created with no permissions so other (non-privileged) processes
+      // cannot open the object until it is completely written.
+        int fd{::shm_open(name.c_str(), O_RDWR|O_CREAT|O_EXCL, 0)};
+        if (fd==-1)
+          {
+            throw_errno("shm_open "+name);
+          }
+        fd_closer closer{fd};
+        try
+          {
+            if (::ftruncate(fd, length)==-1)
+              {
+                throw_errno("ftruncate "+name);
+              }
+            auto addr(::mmap(nullptr, length, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0));
+            if (addr==MAP_FAILED)
+              {
+                throw_errno("mmap "+name);
+              }
+            write_image(addr);
+            ::munmap(addr, length);
+            if (::fchmod(fd, S_IRUSR|S_IRGRP|S_IROTH)==-1)
+              {
+                throw_errno("fchmod "+name);
+              }
+          }
+        catch (...)
+          {
+            ::shm_unlink(name.c_str());
+            throw;
+          }
+      }
+    } // namespace
+
+    void export_shared_text_image(std::string const & name, text_info const & ti)
+    {
+      text_image_builder builder{ti};
+      export_image(name, builder.size(), [&builder](void * addr)
+                                         {
+                                           builder.write(addr);
+                                         }
+                  );
+    }
+
+    void export_shared_text_image
+    ( std::string const & name
+    , text_image_view const & image
+    )
+    {
+      export_image( name, image.size()
+                  , [&image](void * addr)
+                    { // As builders do, write the magic last
+                      auto dest(static_cast<char *>(addr));
+                      auto src(static_cast<char const *>(image.data()));
+                      auto magic_size(sizeof(image::header::magic));
+                      std::memcpy( dest+magic_size, src+magic_size
+                                 , image.size()-magic_size
+                                 );
+                      std::atomic_thread_fence(std::memory_order_release);
+                      std::memcpy(dest, src, magic_size);
+                    }
+                  );
+    }
+
+    bool remove_shared_text_image(std::string const & name)
+    {
+      if (::shm_unlink(name.c_str())==-1)
+        {
+          if (errno==ENOENT)
+            {
+              return false;
+            }
+          throw_errno("shm_unlink "+name);
+        }
+      return true;
+    }
+
+    shared_text_image::mapping shared_text_image::map_image(std::string const & name)
+    {
+      int fd{::shm_open(name.c_str(), O_RDONLY, 0)};
+      if (fd==-1)
+        {
+          throw_errno("shm_open "+name);
+        }
+      fd_closer closer{fd};
+      struct stat st;
+      if (::fstat(fd, &st)==-1)
+        {
+          throw_errno("fstat "+name);
+        }
+      std::uint64_t length(st.st_size);
+      if (length<sizeof(image::header))
+        { // Not yet sized by its exporter, or not an image at all.
+          throw bad_text_image{"Not a text image."};
+        }
+      auto addr(::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0));
+      if (addr==MAP_FAILED)
+        {
+          throw_errno("mmap "+name);
+        }
+      return mapping{addr, length};
+    }
+
+    shared_text_image::shared_text_image(mapping m)
+    try
+    : mapped(m)
+    , image_view{m.address, m.length}
+    {
+    }
+    catch (...)
+    {
+      ::munmap(const_cast<void*>(m.address), m.length);
+    }
+
+    shared_text_image::shared_text_image(std::string const & name)
+    : shared_text_image(map_image(name))
+    {
+    }
+
+    shared_text_image::~shared_text_image()
+    {
+      ::munmap(const_cast<void*>(mapped.address), mapped.length);
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
@@ -0,0 +1,101 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file shared_text_image.h
+/// @brief Text images shared between processes via POSIX shared memory.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// A published text_registry (or any fully setup text_info) may be exported
+/// once as a text image into a named POSIX shared memory object. Other
+/// processes then map the object read-only and query it in place, so one
+/// copy of the data serves every process on the host.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_SHARED_TEXT_IMAGE_H
+# define DIBASE_BLOG_SIES_SHARED_TEXT_IMAGE_H
+# include "text_image.h"
+# include <string>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Export image of text_info to a new POSIX shared memory object.
+  ///
+  /// The object is created with no permissions and made readable by its
+  /// owner, group and others only once the image has been written, so only
+  /// the exporting process ever has write access and other processes cannot
+  /// open a partially written image. The image's magic is also written last,
+  /// so even a privileged process opening the object early is refused by
+  /// text_image_view rather than seeing a partial image.
+  /// @param name   Shared memory object name, of the form "/somename".
+  /// @param ti     Fully setup text_info object to export.
+  /// @throws std::system_error if the object already exists or cannot be
+  ///         created, sized or mapped.
+    void export_shared_text_image(std::string const & name, text_info const & ti);
+
+  /// @brief Export copy of an existing image, such as a compacted
+  /// text_registry's frozen_text_image, to a new POSIX shared memory object.
+  ///
+  /// The object is created and published as for exporting a text_info.
+  /// @param name   Shared memory object name, of the form "/somename".
+  /// @param image  View of image to copy.
+  /// @throws std::system_error if the object already exists or cannot be
+  ///         created, sized or mapped.
+    void export_shared_text_image
+    ( std::string const & name
+    , text_image_view const & image
+    );
+
+  /// @brief Remove a named POSIX shared memory text image.
+  /// Processes that have the image mapped may continue to use it.
+  /// @param name   Shared memory object name passed to export.
+  /// @returns true if removed, false if no such object existed.
+  /// @throws std::system_error on failures other than no such object.
+    bool remove_shared_text_image(std::string const & name);
+
+  /// @brief Read-only mapping of a text image in POSIX shared memory.
+  ///
+  /// Maps the whole object read-only on construction and unmaps it on
+  /// destruction. Queries are made through the view returned by view().
+    class shared_text_image
+    {
+    /// @brief Address and length of a mapped shared memory object.
+      struct mapping
+      {
+        void const *  address;
+        std::uint64_t length;
+      };
+
+      mapping         mapped;
+      text_image_view image_view;
+
+      explicit shared_text_image(mapping m);
+
+    /// @brief Helper: open and map named object read-only.
+      static mapping map_image(std::string const & name);
+
+    public:
+    /// @brief Open and map existing shared memory text image.
+    /// @param name   Shared memory object name passed to export.
+    /// @throws std::system_error if the object cannot be opened or mapped.
+    /// @throws dibase::blog::sies::bad_text_image if the object does not
+    ///         contain a valid, completely written, text image.
+      explicit shared_text_image(std::string const & name);
+
+      shared_text_image(shared_text_image const &) = delete;
+      shared_text_image & operator=(shared_text_image const &) = delete;
+      shared_text_image(shared_text_image &&) = delete;
+      shared_text_image & operator=(shared_text_image &&) = delete;
+
+    /// @brief Destructor : unmap the shared memory.
+      ~shared_text_image();
+
+    /// @brief Returns view through which the image may be queried.
+      text_image_view const & view() const { return image_view; }
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_SHARED_TEXT_IMAGE_H
@@ -0,0 +1,845 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file static_text_info.h
+/// @brief Text information for reference text analysed at compile time.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Fixed reference text known when a program is built - such as the
+/// exemplar data used to check other text_info or text_registry objects -
+/// need not be analysed at run time. A basic_static_text_info type's chunks
+/// are tokenized and counted by constexpr functions as the program is
+/// compiled, the results being held in constexpr static arrays that are
+/// placed in read only data, so such objects cost nothing at start up. As
+/// they have no mutable operations they are, in effect, published from the
+/// start and may be queried by any number of threads without further
+/// synchronisation.
+///
+/// Each chunk's text is provided by a source type having a constexpr static
+/// character array member named text initialised by a string literal:
+///
+///     struct greeting { static constexpr char text[] = "Hello, World!"; };
+///     constexpr char greeting::text[];
+///
+///     constexpr static_text_info<greeting> reference{};
+///     static_assert(reference.word_count()==2U, "");
+///
+/// Compile time analysis is intended for modest amounts of reference text.
+/// With g++ 12 a chunk of a few hundred words takes a few seconds to
+/// analyse, compile time growing somewhat faster than the number of words in
+/// a chunk, so longer texts are best split into several chunks. No word may
+/// be longer than the compiler's constexpr recursion depth (512 for g++).
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_STATIC_TEXT_INFO_H
+# define DIBASE_BLOG_SIES_STATIC_TEXT_INFO_H
+# include "tokenizers.h"
+# include <string>
+# include <algorithm>
+# include <stdexcept>
+# include <type_traits>
+# include <cstddef>
+# include <cstdint>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Compile time text analysis functions and tables.
+  ///
+  /// Functions over ranges of text divide the range in two and recurse on
+  /// each half so recursion depth is logarithmic in the size of the range.
+    namespace static_analysis
+    {
+    /// @brief Number of characters in each block of a chunk's text for which
+    /// the number of words starting before the block is recorded.
+      std::size_t const BlockSize{256U};
+
+    /// @brief Number of values in each block of a table.
+      std::size_t const TableBlockSize{64U};
+
+    /// @brief Word key bytes held inline, as basic_packed_word<8> does.
+      std::size_t const KeyBytes{7U};
+
+    /// @brief Word key length byte value of words longer than KeyBytes.
+      std::uint64_t const LongWordKey{0xFFU};
+
+      constexpr std::size_t midpoint(std::size_t first, std::size_t last)
+      {
+        return first+(last-first)/2U;
+      }
+
+    /// @brief Returns smallest power of two not less than n.
+      constexpr std::size_t power_of_two_not_less(std::size_t n, std::size_t p = 1U)
+      {
+        return p>=n ? p : power_of_two_not_less(n, 2U*p);
+      }
+
+      template <class Generator, std::size_t Block, class Indices
+                  = typename char_class::make_indices<TableBlockSize>::type
+               >
+      struct table_block;
+
+      template <class Generator, std::size_t Block, std::size_t... I>
+      struct table_block<Generator, Block, char_class::indices<I...>>
+      {
+        typedef typename Generator::value_type value_type;
+
+        static constexpr value_type values[TableBlockSize]
+                  = { ( Block*TableBlockSize+I<Generator::size
+                          ? Generator::value(Block*TableBlockSize+I)
+                          : value_type()
+                      )...
+                    };
+      };
+
+      template <class Generator, std::size_t Block, std::size_t... I>
+      constexpr typename Generator::value_type table_block
+                  <Generator, Block, char_class::indices<I...>>
+                    ::values[TableBlockSize];
+
+    /// @brief Blocks [First, Last) of a table.
+      template < class Generator
+               , std::size_t First
+               , std::size_t Last
+               , bool Single = Last-First==1U
+               >
+      struct table_blocks
+      {
+        static constexpr std::size_t Middle{First+(Last-First)/2U};
+
+        static constexpr typename Generator::value_type at(std::size_t i)
+        {
+          return i<Middle*TableBlockSize
+                  ? table_blocks<Generator, First, Middle>::at(i)
+                  : table_blocks<Generator, Middle, Last>::at(i);
+        }
+      };
+
+      template <class Generator, std::size_t First, std::size_t Last>
+      struct table_blocks<Generator, First, Last, true>
+      {
+        static constexpr typename Generator::value_type at(std::size_t i)
+        {
+          return table_block<Generator, First>::values[i-First*TableBlockSize];
+        }
+      };
+
+    /// @brief Table of the Generator::size values Generator::value(i) for i
+    /// in [0, Generator::size), generated at compile time.
+    ///
+    /// Reading an element of a constexpr array during constant evaluation
+    /// can cost time proportional to the size of the array (it does for g++
+    /// 12), so tables read many times during compile time analysis are held
+    /// in TableBlockSize blocks, the block holding an element being found by
+    /// a binary search of the blocks.
+      template <class Generator>
+      struct table
+      : table_blocks< Generator, 0U
+                    , Generator::size<=TableBlockSize
+                        ? 1U
+                        : (Generator::size+TableBlockSize-1U)/TableBlockSize
+                    >
+      {};
+
+    /// @brief Returns bits, one per char value in [first, last), set for
+    /// each word character; last-first must be no more than 64.
+      template <class WordChars>
+      constexpr std::uint64_t word_char_bits(unsigned first, unsigned last)
+      {
+        return last-first==1U
+                ? (WordChars::is_word_char(static_cast<unsigned char>(first)) ? 1U : 0U)
+                : word_char_bits<WordChars>(first, first+(last-first)/2U)
+                  | word_char_bits<WordChars>(first+(last-first)/2U, last)
+                                                  << ((last-first)/2U);
+      }
+
+    /// @brief Word characters of WordChars as a 256 bit set held in scalar
+    /// constants, as reading an element of a table such as
+    /// char_class::table<WordChars>::is_word_char can, during constant
+    /// evaluation, cost time proportional to the size of the table.
+      template <class WordChars>
+      struct word_char_set
+      {
+        static constexpr std::uint64_t bits0{word_char_bits<WordChars>(0U, 64U)};
+        static constexpr std::uint64_t bits1{word_char_bits<WordChars>(64U, 128U)};
+        static constexpr std::uint64_t bits2{word_char_bits<WordChars>(128U, 192U)};
+        static constexpr std::uint64_t bits3{word_char_bits<WordChars>(192U, 256U)};
+
+        static constexpr bool contains(unsigned char chr)
+        {
+          return (( chr<64U ? bits0 : chr<128U ? bits1 : chr<192U ? bits2 : bits3
+                  ) >> (chr%64U) & 1U
+                 )!=0U;
+        }
+      };
+
+      template <class WordChars>
+      constexpr bool is_word_char(char chr)
+      {
+        return word_char_set<WordChars>::contains(static_cast<unsigned char>(chr));
+      }
+
+    /// @brief Returns true if a word starts at pos in text.
+      template <class WordChars>
+      constexpr bool is_word_start(char const * text, std::size_t pos)
+      {
+        return is_word_char<WordChars>(text[pos])
+            && (pos==0U || !is_word_char<WordChars>(text[pos-1U]));
+      }
+
+    /// @brief Returns number of words starting in [first, last) of text.
+      template <class WordChars>
+      constexpr std::size_t count_words
+      ( char const * text
+      , std::size_t first
+      , std::size_t last
+      )
+      {
+        return last-first==0U ? 0U
+             : last-first==1U ? (is_word_start<WordChars>(text, first) ? 1U : 0U)
+             : count_words<WordChars>(text, first, midpoint(first, last))
+               + count_words<WordChars>(text, midpoint(first, last), last);
+      }
+
+    /// @brief Returns bits, one per char value in [64*word, 64*word+64), set
+    /// for each char value occurring in [first, last) of text.
+      constexpr std::uint64_t char_presence
+      ( char const * text
+      , std::size_t first
+      , std::size_t last
+      , std::size_t word
+      )
+      {
+        return last-first==0U ? 0U
+             : last-first==1U
+                ? ( static_cast<unsigned char>(text[first])/64U==word
+                      ? std::uint64_t{1U}<<(static_cast<unsigned char>(text[first])%64U)
+                      : 0U
+                  )
+             : char_presence(text, first, midpoint(first, last), word)
+               | char_presence(text, midpoint(first, last), last, word);
+      }
+
+    /// @brief Returns number of occurrences of chr in [first, last) of text.
+      constexpr std::size_t count_char
+      ( char const * text
+      , std::size_t first
+      , std::size_t last
+      , unsigned char chr
+      )
+      {
+        return last-first==0U ? 0U
+             : last-first==1U ? (static_cast<unsigned char>(text[first])==chr ? 1U : 0U)
+             : count_char(text, first, midpoint(first, last), chr)
+               + count_char(text, midpoint(first, last), last, chr);
+      }
+
+    /// @brief Returns the last index in [first, last) of non-decreasing
+    /// values having a value not greater than n; values[first] must be.
+      constexpr std::size_t find_last_not_greater
+      ( std::size_t const * values
+      , std::size_t n
+      , std::size_t first
+      , std::size_t last
+      )
+      {
+        return last-first==1U ? first
+             : values[midpoint(first, last)]<=n
+                ? find_last_not_greater(values, n, midpoint(first, last), last)
+                : find_last_not_greater(values, n, first, midpoint(first, last));
+      }
+
+    /// @brief Returns position of the start of the n-th (0 based) word
+    /// starting at or after pos in text; there must be more than n such words
+    /// within the BlockSize block containing pos.
+      template <class WordChars>
+      constexpr std::size_t nth_word_start_from
+      ( char const * text
+      , std::size_t n
+      , std::size_t pos
+      )
+      {
+        return !is_word_start<WordChars>(text, pos)
+                ? nth_word_start_from<WordChars>(text, n, pos+1U)
+             : n==0U ? pos
+             : nth_word_start_from<WordChars>(text, n-1U, pos+1U);
+      }
+
+      template <class WordChars>
+      constexpr std::size_t nth_word_start_in_block
+      ( char const * text
+      , std::size_t const * words_before_block
+      , std::size_t n
+      , std::size_t block
+      )
+      {
+        return nth_word_start_from<WordChars>
+                ( text, n-words_before_block[block], block*BlockSize);
+      }
+
+    /// @brief Returns position of the start of the n-th (0 based) word in
+    /// text having words_before_block[b] words before its b-th block.
+      template <class WordChars>
+      constexpr std::size_t nth_word_start
+      ( char const * text
+      , std::size_t const * words_before_block
+      , std::size_t number_of_blocks
+      , std::size_t n
+      )
+      {
+        return nth_word_start_in_block<WordChars>
+                ( text, words_before_block, n
+                , find_last_not_greater(words_before_block, n, 0U, number_of_blocks)
+                );
+      }
+
+    /// @brief Returns position of first non-word character at or after pos.
+      template <class WordChars>
+      constexpr std::size_t find_word_end
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return pos<size && is_word_char<WordChars>(text[pos])
+                ? find_word_end<WordChars>(text, size, pos+1U)
+                : pos;
+      }
+
+      constexpr unsigned fold(char chr)
+      {
+        return 'A'<=static_cast<unsigned char>(chr)
+            && static_cast<unsigned char>(chr)<='Z'
+                ? static_cast<unsigned char>(chr)+('a'-'A')
+                : static_cast<unsigned char>(chr);
+      }
+
+      constexpr std::uint64_t key_byte
+      ( char const * word
+      , std::size_t size
+      , std::size_t i
+      )
+      {
+        return i<size ? std::uint64_t{fold(word[i])} << (56U-8U*i) : 0U;
+      }
+
+    /// @brief Returns a word's key: as basic_packed_word<8>'s packed integer,
+    /// the first KeyBytes case folded bytes most significant first then the
+    /// length, or LongWordKey for longer words. Keys order as the words do
+    /// unless both are long and equal, when their remaining bytes decide.
+      constexpr std::uint64_t word_key(char const * word, std::size_t size)
+      {
+        return key_byte(word, size, 0U) | key_byte(word, size, 1U)
+             | key_byte(word, size, 2U) | key_byte(word, size, 3U)
+             | key_byte(word, size, 4U) | key_byte(word, size, 5U)
+             | key_byte(word, size, 6U)
+             | (size<=KeyBytes ? std::uint64_t{size} : LongWordKey);
+      }
+
+    /// @brief Compares two words with [A-Z] folded to [a-z] as unsigned char
+    /// values, shorter words first: the order of text_info word keys.
+    /// @returns Negative, zero or positive as lhs is less than, equal to or
+    ///          greater than rhs.
+      constexpr int compare_folded
+      ( char const * lhs
+      , std::size_t lhs_size
+      , char const * rhs
+      , std::size_t rhs_size
+      )
+      {
+        return lhs_size==0U ? (rhs_size==0U ? 0 : -1)
+             : rhs_size==0U ? 1
+             : fold(*lhs)!=fold(*rhs) ? (fold(*lhs)<fold(*rhs) ? -1 : 1)
+             : compare_folded(lhs+1, lhs_size-1U, rhs+1, rhs_size-1U);
+      }
+
+      constexpr std::size_t pick(std::size_t a, std::size_t b, bool take_a)
+      {
+        return take_a ? a : b;
+      }
+    } // namespace static_analysis
+
+  /// @brief View of one compile time analysed chunk's data.
+  ///
+  /// The word_* arrays have an entry per word in the chunk: the positions
+  /// of each word's start and end in text in order of appearance, and the
+  /// word indexes ordered by case folded word, so occurrences of a word are
+  /// adjacent.
+    struct static_chunk_view
+    {
+      char const *        text;
+      std::size_t         size;
+      std::size_t         word_count;
+      std::size_t const * char_counts;  ///< NumberOfCharCounts entries
+      std::size_t const * word_starts;
+      std::size_t const * word_ends;
+      std::size_t const * words_by_word;
+
+      constexpr std::size_t char_occurrence(char chr) const
+      {
+        return char_counts[static_cast<unsigned char>(chr)];
+      }
+
+    /// @brief Returns occurrences of word, [A-Z] being folded to [a-z].
+      std::size_t word_occurrence(std::string const & word) const
+      {
+        auto compare([this, &word](std::size_t w)
+                      {
+                        return static_analysis::compare_folded
+                                ( text+word_starts[w], word_ends[w]-word_starts[w]
+                                , word.data(), word.size()
+                                );
+                      }
+                    );
+        auto first(std::lower_bound
+                    ( words_by_word, words_by_word+word_count, 0
+                    , [&compare](std::size_t w, int) { return compare(w)<0; }
+                    ));
+        auto last(std::upper_bound
+                    ( first, words_by_word+word_count, 0
+                    , [&compare](int, std::size_t w) { return compare(w)>0; }
+                    ));
+        return static_cast<std::size_t>(last-first);
+      }
+    };
+
+  /// @brief Compile time analysis of one chunk of text: sizes.
+  /// @param Source     Type with a constexpr static char array member text
+  ///                   initialised by a string literal.
+  /// @param WordChars  Word character class (see tokenizers.h).
+    template <class Source, class WordChars>
+    struct static_chunk_sizes
+    {
+      static constexpr char const * text() { return Source::text; }
+
+      static constexpr std::size_t size{sizeof(Source::text)-1U};
+      static constexpr std::size_t word_count
+                {static_analysis::count_words<WordChars>(Source::text, 0U, size)};
+      static constexpr std::size_t padded_word_count
+                {static_analysis::power_of_two_not_less(word_count)};
+      static constexpr std::size_t number_of_blocks
+                {(size+static_analysis::BlockSize-1U)/static_analysis::BlockSize};
+    };
+
+    template < class Source
+             , class WordChars
+             , class BlockIndices = typename char_class::make_indices
+                    <static_chunk_sizes<Source, WordChars>::number_of_blocks>::type
+             >
+    struct static_chunk_blocks;
+
+  /// @brief Compile time analysis of one chunk of text: char values present
+  /// and numbers of words starting before each BlockSize block. The
+  /// words_before_block array has a final extra entry so is never empty.
+    template <class Source, class WordChars, std::size_t... B>
+    struct static_chunk_blocks<Source, WordChars, char_class::indices<B...>>
+    : static_chunk_sizes<Source, WordChars>
+    {
+      typedef static_chunk_sizes<Source, WordChars> sizes;
+
+      static constexpr std::uint64_t chars_present[NumberOfCharCounts/64U]
+                = { static_analysis::char_presence(Source::text, 0U, sizes::size, 0U)
+                  , static_analysis::char_presence(Source::text, 0U, sizes::size, 1U)
+                  , static_analysis::char_presence(Source::text, 0U, sizes::size, 2U)
+                  , static_analysis::char_presence(Source::text, 0U, sizes::size, 3U)
+                  };
+
+      static constexpr std::size_t words_before_block[sizeof...(B)+1U]
+                = { static_analysis::count_words<WordChars>
+                      (Source::text, 0U, B*static_analysis::BlockSize)...
+                  , sizes::word_count
+                  };
+
+      static constexpr bool is_present(unsigned char chr)
+      {
+        return (chars_present[chr/64U] & std::uint64_t{1U}<<(chr%64U))!=0U;
+      }
+    };
+
+    template <class Source, class WordChars, std::size_t... B>
+    constexpr std::uint64_t static_chunk_blocks
+            <Source, WordChars, char_class::indices<B...>>
+              ::chars_present[NumberOfCharCounts/64U];
+
+    template <class Source, class WordChars, std::size_t... B>
+    constexpr std::size_t static_chunk_blocks
+            <Source, WordChars, char_class::indices<B...>>
+              ::words_before_block[sizeof...(B)+1U];
+
+  /// @brief Compile time analysis of one chunk of text: tables of word start
+  /// and end positions and keys, in order of appearance, and word ordering.
+    template <class Source, class WordChars>
+    struct static_chunk_words : static_chunk_blocks<Source, WordChars>
+    {
+      typedef static_chunk_blocks<Source, WordChars> blocks;
+
+      struct start_generator
+      {
+        typedef std::size_t value_type;
+        static constexpr std::size_t size{blocks::word_count};
+
+        static constexpr value_type value(std::size_t i)
+        {
+          return static_analysis::nth_word_start<WordChars>
+                  ( Source::text, blocks::words_before_block
+                  , blocks::number_of_blocks, i
+                  );
+        }
+      };
+      typedef static_analysis::table<start_generator> starts;
+
+      struct end_generator
+      {
+        typedef std::size_t value_type;
+        static constexpr std::size_t size{blocks::word_count};
+
+        static constexpr value_type value(std::size_t i)
+        {
+          return static_analysis::find_word_end<WordChars>
+                                  (Source::text, blocks::size, starts::at(i));
+        }
+      };
+      typedef static_analysis::table<end_generator> ends;
+
+      struct key_generator
+      {
+        typedef std::uint64_t value_type;
+        static constexpr std::size_t size{blocks::word_count};
+
+        static constexpr value_type value(std::size_t i)
+        {
+          return static_analysis::word_key
+                  (Source::text+starts::at(i), ends::at(i)-starts::at(i));
+        }
+      };
+      typedef static_analysis::table<key_generator> keys;
+
+    /// @brief Compares words j and k by key then, for equal long words'
+    /// keys, remaining bytes.
+      static constexpr int compare(std::size_t j, std::size_t k)
+      {
+        return keys::at(j)!=keys::at(k) ? (keys::at(j)<keys::at(k) ? -1 : 1)
+             : (keys::at(j) & 0xFFU)!=static_analysis::LongWordKey ? 0
+             : static_analysis::compare_folded
+                ( Source::text+starts::at(j)+static_analysis::KeyBytes
+                , ends::at(j)-starts::at(j)-static_analysis::KeyBytes
+                , Source::text+starts::at(k)+static_analysis::KeyBytes
+                , ends::at(k)-starts::at(k)-static_analysis::KeyBytes
+                );
+      }
+
+    /// @brief Returns true if word a orders before word b: by folded word
+    /// then by position. Indexes of word_count or more are padding, ordering
+    /// after all words.
+      static constexpr bool before(std::size_t a, std::size_t b)
+      {
+        return a>=blocks::word_count ? false
+             : b>=blocks::word_count ? true
+             : compare(a, b)<(a<b ? 1 : 0);
+      }
+    };
+
+  /// @brief Stage of a compile time bitonic sort of a chunk's words, giving
+  /// the word indexes ordered by Words::before. Each of the log2(P)*(log2(P)+1)/2
+  /// stages, where P is Words::padded_word_count, compare-exchanges every
+  /// element with one other so ordering a chunk's words costs O(P log2(P)^2)
+  /// word comparisons rather than a comparison per pair of words.
+  /// @param Words  static_chunk_words specialisation.
+  /// @param K      Size of bitonic sequences being merged, or 1 for the
+  ///               unsorted (identity) order.
+  /// @param J      Compare-exchange distance, 0 for the unsorted order.
+    template <class Words, std::size_t K, std::size_t J>
+    struct static_word_sort
+    {
+      typedef typename std::conditional
+                < 2U*J<K
+                , static_word_sort<Words, K, 2U*J>
+                , typename std::conditional
+                    < K==2U
+                    , static_word_sort<Words, 1U, 0U>
+                    , static_word_sort<Words, K/2U, 1U>
+                    >::type
+                >::type                                 previous;
+
+      typedef std::size_t value_type;
+      static constexpr std::size_t size{Words::padded_word_count};
+
+      static constexpr value_type exchange
+      ( std::size_t i
+      , std::size_t a
+      , std::size_t b
+      )
+      {
+        return static_analysis::pick
+                ( a, b
+                , ((i<(i^J))==((i&K)==0U))==Words::before(a, b)
+                );
+      }
+
+      static constexpr value_type value(std::size_t i)
+      {
+        return exchange(i, previous::at(i), previous::at(i^J));
+      }
+
+      static constexpr value_type at(std::size_t i)
+      {
+        return static_analysis::table<static_word_sort>::at(i);
+      }
+    };
+
+    template <class Words>
+    struct static_word_sort<Words, 1U, 0U>
+    {
+      static constexpr std::size_t at(std::size_t i) { return i; }
+    };
+
+    template < class Source
+             , class WordChars
+             , class WordIndices = typename char_class::make_indices
+                    <static_chunk_sizes<Source, WordChars>::word_count>::type
+             , class CharIndices = typename char_class::make_indices
+                    <NumberOfCharCounts>::type
+             >
+    struct static_chunk;
+
+  /// @brief Compile time analysed data of one chunk of text, in arrays
+  /// viewed by static_chunk_view.
+  ///
+  /// Characters are counted only for char values present in the text. The
+  /// word arrays have a final extra entry so they are never empty.
+  /// @param Source     Type with a constexpr static char array member text
+  ///                   initialised by a string literal.
+  /// @param WordChars  Word character class (see tokenizers.h).
+    template < class Source, class WordChars
+             , std::size_t... W, std::size_t... C
+             >
+    struct static_chunk< Source, WordChars
+                       , char_class::indices<W...>, char_class::indices<C...>
+                       >
+    : static_chunk_words<Source, WordChars>
+    {
+      typedef static_chunk_words<Source, WordChars> words;
+      typedef static_word_sort
+                < words
+                , words::padded_word_count
+                , words::word_count<=1U ? 0U : 1U
+                >                                   sorted_words;
+
+      static constexpr std::size_t char_counts[NumberOfCharCounts]
+                = { ( words::is_present(C)
+                        ? static_analysis::count_char
+                            (Source::text, 0U, words::size, C)
+                        : 0U
+                    )...
+                  };
+
+      static constexpr std::size_t word_starts[sizeof...(W)+1U]
+                = { words::starts::at(W)..., words::size };
+
+      static constexpr std::size_t word_ends[sizeof...(W)+1U]
+                = { words::ends::at(W)..., words::size };
+
+      static constexpr std::size_t words_by_word[sizeof...(W)+1U]
+                = { sorted_words::at(W)..., sizeof...(W) };
+
+      static constexpr static_chunk_view view()
+      {
+        return static_chunk_view{ Source::text, words::size
+                                , words::word_count, char_counts
+                                , word_starts, word_ends, words_by_word
+                                };
+      }
+    };
+
+    template <class Source, class WordChars, std::size_t... W, std::size_t... C>
+    constexpr std::size_t static_chunk
+            < Source, WordChars
+            , char_class::indices<W...>, char_class::indices<C...>
+            >::char_counts[NumberOfCharCounts];
+
+    template <class Source, class WordChars, std::size_t... W, std::size_t... C>
+    constexpr std::size_t static_chunk
+            < Source, WordChars
+            , char_class::indices<W...>, char_class::indices<C...>
+            >::word_starts[sizeof...(W)+1U];
+
+    template <class Source, class WordChars, std::size_t... W, std::size_t... C>
+    constexpr std::size_t static_chunk
+            < Source, WordChars
+            , char_class::indices<W...>, char_class::indices<C...>
+            >::word_ends[sizeof...(W)+1U];
+
+    template <class Source, class WordChars, std::size_t... W, std::size_t... C>
+    constexpr std::size_t static_chunk
+            < Source, WordChars
+            , char_class::indices<W...>, char_class::indices<C...>
+            >::words_by_word[sizeof...(W)+1U];
+
+  /// @brief Read only text information analysed at compile time.
+  ///
+  /// Provides the query operations of text_info, words being split and
+  /// case folded as a text_info using a basic_tokenizer<WordChars> policy
+  /// would. Queries not involving words are constexpr.
+  ///
+  /// @param WordChars  Word character class (see tokenizers.h).
+  /// @param Sources    Chunk text source types, in chunk order.
+    template <class WordChars, class... Sources>
+    class basic_static_text_info
+    {
+      static_assert( sizeof...(Sources)!=0U
+                   , "Static text information requires at least one chunk."
+                   );
+
+      static constexpr static_chunk_view chunks[sizeof...(Sources)]
+                          = { static_chunk<Sources, WordChars>::view()... };
+
+      static constexpr std::uint64_t sum_char_counts(std::size_t first, std::size_t last)
+      {
+        return last-first==1U ? chunks[first].size
+             : sum_char_counts(first, static_analysis::midpoint(first, last))
+               + sum_char_counts(static_analysis::midpoint(first, last), last);
+      }
+
+      static constexpr std::uint64_t sum_word_counts(std::size_t first, std::size_t last)
+      {
+        return last-first==1U ? chunks[first].word_count
+             : sum_word_counts(first, static_analysis::midpoint(first, last))
+               + sum_word_counts(static_analysis::midpoint(first, last), last);
+      }
+
+      static constexpr std::uint64_t sum_char_occurrences
+      ( char chr
+      , std::size_t first
+      , std::size_t last
+      )
+      {
+        return last-first==1U ? chunks[first].char_occurrence(chr)
+             : sum_char_occurrences(chr, first, static_analysis::midpoint(first, last))
+               + sum_char_occurrences(chr, static_analysis::midpoint(first, last), last);
+      }
+
+      static constexpr static_chunk_view const & chunk(std::size_t chunk_index)
+      {
+        return chunk_index<sizeof...(Sources)
+                ? chunks[chunk_index]
+                : throw std::out_of_range{"Static text chunk index out of range."};
+      }
+
+    public:
+      typedef std::size_t   chunk_index_type;
+      typedef std::size_t   chunk_count_type;
+      typedef std::size_t   chunk_size_type;
+      typedef std::uint64_t total_size_type;
+      typedef WordChars     word_chars_type;
+
+      constexpr basic_static_text_info() {}
+
+    /// @brief Returns number of text chunks.
+      constexpr chunk_count_type number_of_chunks() const
+      {
+        return sizeof...(Sources);
+      }
+
+    /// @brief Returns copy of a chunk's text.
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+      std::string chunk_text(chunk_index_type chunk_index) const
+      {
+        return std::string(chunk(chunk_index).text, chunk(chunk_index).size);
+      }
+
+    /// @brief Returns number of characters in a chunk.
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+      constexpr chunk_size_type chunk_char_count(chunk_index_type chunk_index) const
+      {
+        return chunk(chunk_index).size;
+      }
+
+    /// @brief Returns number of words in a chunk.
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+      constexpr chunk_size_type chunk_word_count(chunk_index_type chunk_index) const
+      {
+        return chunk(chunk_index).word_count;
+      }
+
+    /// @brief Returns occurrence of a character in a chunk.
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+      constexpr chunk_size_type chunk_char_occurrence
+      ( chunk_index_type chunk_index
+      , char chr
+      ) const
+      {
+        return chunk(chunk_index).char_occurrence(chr);
+      }
+
+    /// @brief Returns occurrence of a word in a chunk.
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+      chunk_size_type chunk_word_occurrence
+      ( chunk_index_type chunk_index
+      , std::string const & word
+      ) const
+      {
+        return chunk(chunk_index).word_occurrence(word);
+      }
+
+    /// @brief Returns concatenation of all chunks' text.
+      std::string text() const
+      {
+        std::string all;
+        all.reserve(char_count());
+        for (auto const & c : chunks)
+          {
+            all.append(c.text, c.size);
+          }
+        return all;
+      }
+
+    /// @brief Returns number of characters in all chunks.
+      constexpr total_size_type char_count() const
+      {
+        return sum_char_counts(0U, sizeof...(Sources));
+      }
+
+    /// @brief Returns number of words in all chunks.
+      constexpr total_size_type word_count() const
+      {
+        return sum_word_counts(0U, sizeof...(Sources));
+      }
+
+    /// @brief Returns occurrence of a character in all chunks.
+      constexpr total_size_type char_occurrence(char chr) const
+      {
+        return sum_char_occurrences(chr, 0U, sizeof...(Sources));
+      }
+
+    /// @brief Returns occurrence of a word in all chunks.
+      total_size_type word_occurrence(std::string const & word) const
+      {
+        total_size_type occurrences{0U};
+        for (auto const & c : chunks)
+          {
+            occurrences += c.word_occurrence(word);
+          }
+        return occurrences;
+      }
+    };
+
+    template <class WordChars, class... Sources>
+    constexpr static_chunk_view basic_static_text_info<WordChars, Sources...>
+                                    ::chunks[sizeof...(Sources)];
+
+  /// @brief Static text information splitting words as text_info does by
+  /// default (i.e. at the separators of separator_word_chars).
+    template <class... Sources>
+    using static_text_info
+                  = basic_static_text_info<separator_word_chars, Sources...>;
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_STATIC_TEXT_INFO_H
@@ -0,0 +1,55 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file append_only_vector-unittests.cpp
+/// @brief Tests for append_only_vector class template.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "append_only_vector.h"
+#include "catch.hpp"
+#include <string>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/append_only_vector/default constructed"
+         , "A default constructed append_only_vector is empty"
+         )
+{
+  append_only_vector<int> v;
+  CHECK(v.size()==0U);
+}
+
+TEST_CASE("blog/sies/append_only_vector/append across segments"
+         , "Appending many elements retains all values in order"
+         )
+{
+  append_only_vector<std::string, 1U> v;
+  for (int i{0}; i!=1000; ++i)
+    {
+      v.push_back(std::to_string(i));
+    }
+  REQUIRE(v.size()==1000U);
+  for (int i{0}; i!=1000; ++i)
+    {
+      CHECK(v[i]==std::to_string(i));
+    }
+}
+
+TEST_CASE("blog/sies/append_only_vector/elements do not move"
+         , "Appending elements does not change addresses of existing elements"
+         )
+{
+  append_only_vector<int, 2U> v;
+  v.push_back(7);
+  auto first(&v[0]);
+  for (int i{0}; i!=100; ++i)
+    {
+      v.push_back(int{i});
+    }
+  CHECK(&v[0]==first);
+  CHECK(v[0]==7);
+}
@@ -0,0 +1,140 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file chunk_staging-unittests.cpp
+/// @brief Tests for staging of text chunks by producer threads.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "chunk_staging.h"
+#include "catch.hpp"
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/chunk_staging/empty"
+         , "A staging area with no handles has no chunks to take"
+         )
+{
+  chunk_staging staging;
+  CHECK(staging.number_open()==0U);
+  CHECK(staging.number_staged()==0U);
+  CHECK(staging.take_ordered().empty());
+}
+
+TEST_CASE("blog/sies/chunk_staging/take ordered"
+         , "Chunks from several handles are taken in sequence number order"
+         )
+{
+  chunk_staging staging;
+  {
+    auto h1(staging.open());
+    auto h2(staging.open());
+    auto h3(staging.open());
+    CHECK(staging.number_open()==3U);
+    h1.add_text_chunk(4U, "e");
+    h1.add_text_chunk(0U, "a");
+    h2.add_text_chunk(1U, "b");
+    h2.add_text_chunk(3U, "d");
+    h1.add_text_chunk(2U, "c");
+    CHECK(h1.size()==3U);
+    h2.submit();
+    CHECK(h2.submitted());
+    CHECK(staging.number_open()==2U);
+    CHECK(staging.number_staged()==2U);
+    CHECK_THROWS_AS(h2.add_text_chunk(5U, "f"), std::logic_error);
+    CHECK_THROWS_AS(staging.take_ordered(), std::logic_error);
+  }
+  CHECK(staging.number_open()==0U);
+  CHECK(staging.number_staged()==5U);
+  auto chunks(staging.take_ordered());
+  REQUIRE(chunks.size()==5U);
+  for (std::uint64_t i{0U}; i!=chunks.size(); ++i)
+    {
+      CHECK(chunks[i].first==i);
+      CHECK(chunks[i].second==std::string(1U, char('a'+i)));
+    }
+  CHECK(staging.number_staged()==0U);
+  CHECK(staging.take_ordered().empty());
+}
+
+TEST_CASE("blog/sies/chunk_staging/moved handles"
+         , "Moved handles transfer their batch and open state"
+         )
+{
+  chunk_staging staging;
+  auto h1(staging.open());
+  h1.add_text_chunk(1U, "b");
+  auto h2(std::move(h1));
+  CHECK(h1.submitted());
+  CHECK(h2.size()==1U);
+  CHECK(staging.number_open()==1U);
+  auto h3(staging.open());
+  h3.add_text_chunk(0U, "a");
+  h3 = std::move(h2);
+  CHECK(staging.number_open()==1U);
+  CHECK(staging.number_staged()==1U);
+  h3.submit();
+  h3.submit();
+  CHECK(staging.number_open()==0U);
+  auto chunks(staging.take_ordered());
+  REQUIRE(chunks.size()==2U);
+  CHECK(chunks[0].second=="a");
+  CHECK(chunks[1].second=="b");
+}
+
+TEST_CASE("blog/sies/chunk_staging/duplicate sequence numbers"
+         , "Taking chunks having the same sequence number throws"
+         )
+{
+  chunk_staging staging;
+  {
+    auto h1(staging.open());
+    auto h2(staging.open());
+    h1.add_text_chunk(7U, "x");
+    h2.add_text_chunk(7U, "y");
+  }
+  CHECK_THROWS_AS(staging.take_ordered(), std::invalid_argument);
+  CHECK(staging.number_staged()==0U);
+}
+
+TEST_CASE("blog/sies/chunk_staging/producer threads"
+         , "Handles filled concurrently by producer threads merge in order"
+         )
+{
+  unsigned const producers{4U};
+  unsigned const per_producer{250U};
+  chunk_staging staging;
+  std::vector<std::thread> threads;
+  for (unsigned p{0U}; p!=producers; ++p)
+    {
+      threads.emplace_back
+        ( [p](chunk_staging::handle h)
+          {
+            for (unsigned i{0U}; i!=per_producer; ++i)
+              {
+                auto sequence_number(i*producers+p);
+                h.add_text_chunk(sequence_number, std::to_string(sequence_number));
+              }
+          }
+        , staging.open()
+        );
+    }
+  for (auto & t : threads)
+    {
+      t.join();
+    }
+  auto chunks(staging.take_ordered());
+  REQUIRE(chunks.size()==producers*per_producer);
+  for (std::uint64_t i{0U}; i!=chunks.size(); ++i)
+    {
+      CHECK(chunks[i].first==i);
+      CHECK(chunks[i].second==std::to_string(i));
+    }
+}
@@ -0,0 +1,112 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file chunk_text_cache-unittests.cpp
+/// @brief Tests for chunk_text_cache class.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "chunk_text_cache.h"
+#include "catch.hpp"
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/chunk_text_cache/zero capacity"
+         , "A cache cannot be created with no entries"
+         )
+{
+  CHECK_THROWS_AS(chunk_text_cache{0U}, std::invalid_argument);
+}
+
+TEST_CASE("blog/sies/chunk_text_cache/find after insert"
+         , "Inserted text is found until replaced by an entry in the same slot"
+         )
+{
+  chunk_text_cache cache{4U};
+  std::string txt{"unchanged"};
+  CHECK_FALSE(cache.find(1U, txt));
+  CHECK(txt=="unchanged");
+  cache.insert(1U, "one");
+  CHECK(cache.find(1U, txt));
+  CHECK(txt=="one");
+  CHECK_FALSE(cache.find(5U, txt));
+  cache.insert(5U, "five");
+  CHECK(cache.find(5U, txt));
+  CHECK(txt=="five");
+  CHECK_FALSE(cache.find(1U, txt));
+  cache.insert(2U, "two");
+  CHECK(cache.find(2U, txt));
+  CHECK(cache.find(5U, txt));
+}
+
+TEST_CASE("blog/sies/chunk_text_cache/many replacements"
+         , "Replacing entries many times, so retired entries are reclaimed, "
+           "leaves the latest entries cached"
+         )
+{
+  chunk_text_cache cache{3U};
+  for (unsigned i{0U}; i!=10U*chunk_text_cache::RetireBatch; ++i)
+    {
+      cache.insert(i, std::to_string(i));
+    }
+  auto last(10U*chunk_text_cache::RetireBatch-1U);
+  std::string txt;
+  for (auto i=last-2U; i<=last; ++i)
+    {
+      CHECK(cache.find(i, txt));
+      CHECK(txt==std::to_string(i));
+    }
+}
+
+TEST_CASE("blog/sies/chunk_text_cache/concurrent find and insert"
+         , "Lookups running concurrently with insertions only ever find the "
+           "text inserted for the chunk requested"
+         )
+{
+  unsigned const NumberOfChunks{64U};
+  chunk_text_cache cache{16U};
+  std::atomic<bool> stop{false};
+  std::atomic<unsigned> mismatches{0U};
+  auto text_for([](unsigned i){ return std::string(100U+i, 'a'+i%26U); });
+  std::vector<std::thread> threads;
+  for (unsigned t{0U}; t!=4U; ++t)
+    {
+      threads.push_back(std::thread([&,t]()
+        {
+          std::string txt;
+          unsigned i{t};
+          while (!stop)
+            {
+              i = (i+7U)%NumberOfChunks;
+              if (cache.find(i, txt))
+                {
+                  if (txt!=text_for(i))
+                    {
+                      ++mismatches;
+                    }
+                }
+              else
+                {
+                  cache.insert(i, text_for(i));
+                }
+            }
+        }));
+    }
+  for (unsigned n{0U}; n!=20000U; ++n)
+    {
+      cache.insert(n%NumberOfChunks, text_for(n%NumberOfChunks));
+    }
+  stop = true;
+  for (auto & th : threads)
+    {
+      th.join();
+    }
+  CHECK(mismatches==0U);
+}
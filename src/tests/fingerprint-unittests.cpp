@@ -0,0 +1,56 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file fingerprint-unittests.cpp
+/// @brief Tests for text content fingerprints.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "fingerprint.h"
+#include "catch.hpp"
+#include <string>
+#include <set>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  std::uint64_t fingerprint(std::string const & text)
+  {
+    return text_fingerprint(text.data(), text.size());
+  }
+}
+
+TEST_CASE("blog/sies/fingerprint/equal text"
+         , "Equal text has equal fingerprints wherever it is held"
+         )
+{
+  std::string const text{"The quick brown fox jumps over the lazy dog."};
+  std::string const padded{"xx" + text};
+  CHECK(fingerprint(text)==fingerprint(std::string{text}));
+  CHECK(fingerprint(text)==text_fingerprint(padded.data()+2U, text.size()));
+  CHECK(fingerprint("")==text_fingerprint(nullptr, 0U));
+}
+
+TEST_CASE("blog/sies/fingerprint/different text"
+         , "Small differences in text give different fingerprints"
+         )
+{
+  std::string const text{"The quick brown fox jumps over the lazy dog."};
+  std::set<std::uint64_t> fingerprints;
+  for (std::size_t size{0U}; size<=text.size(); ++size)
+    {
+      CHECK(fingerprints.insert(fingerprint(text.substr(0U, size))).second);
+    }
+  for (std::size_t pos{0U}; pos!=text.size(); ++pos)
+    {
+      auto changed(text);
+      changed[pos] ^= 1;
+      CHECK(fingerprints.insert(fingerprint(changed)).second);
+    }
+  CHECK(fingerprint(std::string(1U, '\0'))!=fingerprint(std::string(2U, '\0')));
+  CHECK(fingerprint("abc")!=fingerprint(std::string{"abc\0", 4U}));
+}
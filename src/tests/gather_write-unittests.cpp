@@ -0,0 +1,178 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file gather_write-unittests.cpp
+/// @brief Tests for gather_write and the text writing operations using it.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "gather_write.h"
+#include "text_registry.h"
+#include "text_image.h"
+#include "atomic-policies.h"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include <system_error>
+#include <cstdio>
+#include <climits>
+#include <unistd.h>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+/// @brief Temporary file, removed on destruction.
+  struct temp_file
+  {
+    std::FILE * file;
+
+    temp_file() : file{std::tmpfile()} {}
+    ~temp_file() { std::fclose(file); }
+
+    int fd() const { return ::fileno(file); }
+
+    std::string contents() const
+    {
+      std::string result;
+      ::lseek(fd(), 0, SEEK_SET);
+      char block[4096];
+      ssize_t n;
+      while ((n=::read(fd(), block, sizeof(block)))>0)
+        {
+          result.append(block, n);
+        }
+      return result;
+    }
+  };
+
+  std::string const chunks[] = { "The quick brownie crossed the road."
+                               , ""
+                               , "Then it slept."
+                               , "A quick sleep."
+                               };
+}
+
+TEST_CASE("blog/sies/gather_write/more regions than IOV_MAX"
+         , "All regions are written, in order, even if there are more than one "
+           "writev call can take"
+         )
+{
+  temp_file out;
+  std::string const text{"0123456789"};
+  std::size_t const count{IOV_MAX*2U+3U};
+  std::vector<iovec> iov(count);
+  std::string expected;
+  for (std::size_t i{0U}; i!=count; ++i)
+    {
+      iov[i].iov_base = const_cast<char *>(text.data()+i%text.size());
+      iov[i].iov_len = 1U + i%3U;
+      expected.append(text.data()+i%text.size(), 1U + i%3U);
+    }
+  CHECK(gather_write(out.fd(), iov.data(), iov.size())==expected.size());
+  CHECK(out.contents()==expected);
+}
+
+TEST_CASE("blog/sies/gather_write/bad file descriptor"
+         , "Failing writes are reported by throwing std::system_error"
+         )
+{
+  char data[] = "x";
+  iovec iov{data, 1U};
+  CHECK_THROWS_AS(gather_write(-1, &iov, 1U), std::system_error);
+}
+
+TEST_CASE("blog/sies/text_info::write_chunks_text/ranges"
+         , "Writing chunk ranges writes the same text as chunk_text and text "
+           "return, and invalid ranges are rejected"
+         )
+{
+  text_info ti;
+  for (auto const & c : chunks)
+    {
+      ti.add_text_chunk(c);
+    }
+  {
+    temp_file out;
+    CHECK(ti.write_text(out.fd())==ti.text().size());
+    CHECK(out.contents()==ti.text());
+  }
+  {
+    temp_file out;
+    CHECK(ti.write_chunks_text(out.fd(), 1U, 3U)==chunks[2].size()+chunks[3].size());
+    CHECK(out.contents()==chunks[2]+chunks[3]);
+  }
+  {
+    temp_file out;
+    CHECK(ti.write_chunks_text(out.fd(), 4U, 0U)==0U);
+    CHECK(out.contents()=="");
+  }
+  CHECK_THROWS_AS(ti.write_chunks_text(1, 2U, 3U), std::out_of_range);
+  CHECK_THROWS_AS(ti.write_chunks_text(1, 5U, 0U), std::out_of_range);
+}
+
+TEST_CASE("blog/sies/text_info::write_chunks_text/compressed batches"
+         , "Compressed chunks written in batches, including ones larger than "
+           "a batch, are written whole and in order"
+         )
+{
+  text_info_options opts;
+  opts.compress_text = true;
+  text_info ti{opts};
+  for (unsigned i{0U}; i!=3000U; ++i)
+    {
+      ti.add_text_chunk(chunks[i%4U] + std::to_string(i));
+      if (i%1000U==500U)
+        {
+          ti.add_text_chunk(std::string(3U<<20U, char('a'+i%26U)) + "end");
+        }
+    }
+  temp_file out;
+  auto text(ti.text());
+  CHECK(ti.write_text(out.fd())==text.size());
+  CHECK(out.contents()==text);
+}
+
+TEST_CASE("blog/sies/text_registry::write_text/after setup"
+         , "A set up text_registry writes its text"
+         )
+{
+  text_registry<non_atomic> reg;
+  for (auto const & c : chunks)
+    {
+      reg.add_text_chunk(c);
+    }
+  reg.setup_complete();
+  temp_file out;
+  CHECK(reg.write_text(out.fd())==reg.text().size());
+  CHECK(out.contents()==reg.text());
+  CHECK_THROWS_AS(reg.write_chunks_text(1, 0U, 5U), std::out_of_range);
+}
+
+TEST_CASE("blog/sies/text_image_view::write_chunks_text/ranges"
+         , "A text image writes the same chunk text as the text_info it was "
+           "made from"
+         )
+{
+  text_info ti;
+  for (auto const & c : chunks)
+    {
+      ti.add_text_chunk(c);
+    }
+  auto image(text_image_builder{ti}.make());
+  text_image_view view{image.data(), image.size()*sizeof(image[0])};
+  {
+    temp_file out;
+    CHECK(view.write_text(out.fd())==ti.text().size());
+    CHECK(out.contents()==ti.text());
+  }
+  {
+    temp_file out;
+    CHECK(view.write_chunks_text(out.fd(), 0U, 2U)==chunks[0].size());
+    CHECK(out.contents()==chunks[0]);
+  }
+  CHECK_THROWS_AS(view.write_chunks_text(1, 3U, 2U), std::out_of_range);
+}
@@ -0,0 +1,86 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file huge_page_region-unittests.cpp
+/// @brief Tests for huge_page_region class and frozen_text_image class.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Huge page availability depends on the host so tests only check that the
+/// backing obtained is no more preferred than that requested.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "huge_page_region.h"
+#include "frozen_text_image.h"
+#include "rnd_text_info_maker.h"
+#include "catch.hpp"
+#include <cstring>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/huge_page_region/size and alignment"
+         , "Regions are zero filled and, if huge pages are requested, huge "
+           "page aligned and sized in huge pages"
+         )
+{
+  auto const HugePageSize(huge_page_region::HugePageSize);
+  page_backing const preferences[] = { page_backing::transparent_huge
+                                     , page_backing::explicit_huge
+                                     };
+  for (auto preferred : preferences)
+    {
+      huge_page_region region{HugePageSize+1U, preferred};
+      CHECK(region.size()==2U*HugePageSize);
+      CHECK(reinterpret_cast<std::uintptr_t>(region.data())%HugePageSize==0U);
+      CHECK(static_cast<int>(region.backing())<=static_cast<int>(preferred));
+      auto bytes(static_cast<char *>(region.data()));
+      CHECK(bytes[0]==0);
+      CHECK(bytes[region.size()-1U]==0);
+      std::memset(bytes, 'x', region.size());
+      CHECK(bytes[region.size()-1U]=='x');
+    }
+  huge_page_region standard{HugePageSize+1U, page_backing::standard};
+  CHECK(standard.size()>HugePageSize);
+  CHECK(standard.size()<2U*HugePageSize);
+  CHECK(standard.backing()==page_backing::standard);
+  huge_page_region empty{0U, page_backing::standard};
+  CHECK(empty.size()!=0U);
+  CHECK(empty.size()<HugePageSize);
+}
+
+TEST_CASE("blog/sies/page_backing/to_string"
+         , "Each page backing has a distinct description"
+         )
+{
+  CHECK(std::string{to_string(page_backing::standard)}=="standard pages");
+  CHECK( std::string{to_string(page_backing::transparent_huge)}
+      =="transparent huge pages"
+       );
+  CHECK(std::string{to_string(page_backing::explicit_huge)}=="explicit huge pages");
+}
+
+TEST_CASE("blog/sies/frozen_text_image/same answers as text_info"
+         , "A frozen image answers queries as the text_info it was made from "
+           "and reports the memory it uses"
+         )
+{
+  rnd_text_info_maker make_rnd_text_info(20U,20U, 50U,100U, 2U,5U);
+  auto pti(make_rnd_text_info());
+  frozen_text_image frozen{*pti};
+  auto const & view(frozen.view());
+  REQUIRE(view.number_of_chunks()==pti->number_of_chunks());
+  CHECK(view.text()==pti->text());
+  CHECK(view.word_count()==pti->word_count());
+  CHECK(view.char_occurrence('a')==pti->char_occurrence('a'));
+  CHECK(view.chunk_word_count(7U)==pti->chunk_word_count(7U));
+  auto report(frozen.memory_report());
+  CHECK(report.image_size==view.size());
+  CHECK(report.mapped_size%huge_page_region::HugePageSize==0U);
+  frozen_text_image standard{*pti, page_backing::standard};
+  CHECK(standard.memory_report().backing==page_backing::standard);
+  CHECK(standard.view().text()==pti->text());
+  CHECK(report.mapped_size>=report.image_size);
+  CHECK(report.describe().find(to_string(report.backing))!=std::string::npos);
+}
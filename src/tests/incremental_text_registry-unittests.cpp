@@ -0,0 +1,147 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file incremental_text_registry-unittests.cpp
+/// @brief Tests for incremental_text_registry.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "incremental_text_registry.h"
+#include "atomic-policies.h"
+#include "catch.hpp"
+#include <thread>
+
+using namespace dibase::blog::sies;
+
+typedef incremental_text_registry
+        < atomic
+        , std::memory_order_release
+        , std::memory_order_acquire
+        > registry_type;
+
+TEST_CASE("blog/sies/incremental_text_registry/default constructed object"
+         , "A default constructed incremental_text_registry has no chunks"
+         )
+{
+  registry_type tr;
+  CHECK(tr.number_of_chunks()==0U);
+  CHECK_THROWS_AS(tr.chunk_text(0U), std::out_of_range);
+  CHECK(tr.text()=="");
+  CHECK(tr.char_count()==0U);
+  CHECK(tr.word_count()==0U);
+  CHECK(tr.char_occurrence(' ')==0U);
+  CHECK(tr.word_occurrence("hello")==0U);
+  CHECK(!tr.complete());
+}
+
+TEST_CASE("blog/sies/incremental_text_registry/unpublished chunks not visible"
+         , "Chunks added but not published are not visible to queries"
+         )
+{
+  registry_type tr;
+  tr.add_text_chunk("Hello world!");
+  CHECK(tr.number_of_chunks()==0U);
+  CHECK_THROWS_AS(tr.chunk_text(0U), std::out_of_range);
+  tr.publish_chunks();
+  CHECK(tr.number_of_chunks()==1U);
+  CHECK(tr.chunk_text(0U)=="Hello world!");
+}
+
+TEST_CASE("blog/sies/incremental_text_registry/published prefix queries"
+         , "Queries report results for published prefix of chunks"
+         )
+{
+  registry_type tr;
+  tr.add_text_chunk("Hello!");
+  tr.add_text_chunk("hELLO there.");
+  tr.publish_chunks();
+  tr.add_text_chunk("not yet hello");
+  CHECK(tr.number_of_chunks()==2U);
+  CHECK(tr.chunk_char_count(1U)==12U);
+  CHECK(tr.chunk_word_count(1U)==2U);
+  CHECK(tr.chunk_char_occurrence(0U,'!')==1U);
+  CHECK(tr.chunk_word_occurrence(1U,"Hello")==1U);
+  CHECK(tr.text()=="Hello!hELLO there.");
+  CHECK(tr.char_count()==18U);
+  CHECK(tr.word_count()==3U);
+  CHECK(tr.char_occurrence('l')==2U);
+  CHECK(tr.word_occurrence("hello")==2U);
+  tr.setup_complete();
+  CHECK(tr.complete());
+  CHECK(tr.word_occurrence("hello")==3U);
+  CHECK(tr.word_count()==6U);
+}
+
+TEST_CASE("blog/sies/incremental_text_registry/prefix is consistent"
+         , "A prefix object reports the same chunks after later publishing"
+         )
+{
+  registry_type tr;
+  tr.add_text_chunk("one");
+  tr.publish_chunks();
+  auto before(tr.published_prefix());
+  tr.add_text_chunk("two");
+  tr.publish_chunks();
+  CHECK(before.number_of_chunks()==1U);
+  CHECK(before.text()=="one");
+  CHECK(tr.published_prefix().text()=="onetwo");
+}
+
+TEST_CASE("blog/sies/incremental_text_registry/mutation restrictions"
+         , "Mutating operations invalid from non-creator threads or once"
+           " setup complete, queries valid from any thread at any time"
+         )
+{
+  registry_type tr;
+  tr.add_text_chunk("Hello");
+  tr.publish_chunks();
+  std::thread([&tr](){CHECK_THROWS_AS(tr.add_text_chunk("oops!"), call_context_violation);}).join();
+  std::thread([&tr](){CHECK_THROWS_AS(tr.publish_chunks(), call_context_violation);}).join();
+  std::thread([&tr](){CHECK(tr.word_occurrence("hello")==1U);}).join();
+  tr.setup_complete();
+  CHECK_THROWS_AS(tr.add_text_chunk("oops!"), call_context_violation);
+  CHECK_THROWS_AS(tr.publish_chunks(), call_context_violation);
+  CHECK_THROWS_AS(tr.setup_complete(), call_context_violation);
+}
+
+TEST_CASE("blog/sies/incremental_text_registry/concurrent append and read"
+         , "Readers observe a monotonically advancing, consistent prefix"
+           " while the creator appends and publishes"
+         )
+{
+  unsigned const NumberOfChunks{2000U};
+  registry_type tr;
+  unsigned failures{0U};
+  std::thread reader([&tr,&failures]()
+    {
+      registry_type::chunk_count_type last{0U};
+      while (!tr.complete() || last!=tr.number_of_chunks())
+        {
+          auto p(tr.published_prefix());
+          auto n(p.number_of_chunks());
+          if ( n<last
+            || p.word_count()!=n
+            || (n!=0U && p.chunk_word_occurrence(n-1U,"chunk")!=1U)
+             )
+            {
+              ++failures;
+            }
+          last = n;
+        }
+    });
+  for (auto i=0U; i!=NumberOfChunks; ++i)
+    {
+      tr.add_text_chunk("chunk ");
+      if (i%7U==0U)
+        {
+          tr.publish_chunks();
+        }
+    }
+  tr.setup_complete();
+  reader.join();
+  CHECK(failures==0U);
+  CHECK(tr.word_count()==NumberOfChunks);
+}
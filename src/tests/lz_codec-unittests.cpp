@@ -0,0 +1,92 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file lz_codec-unittests.cpp
+/// @brief Tests for lz_compress and lz_decompress.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "lz_codec.h"
+#include "rnd_text_info_maker.h"
+#include "catch.hpp"
+#include <random>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/lz_codec/empty"
+         , "Empty data compresses to nothing and decompresses back to nothing"
+         )
+{
+  CHECK(lz_compress(std::string{}).empty());
+  CHECK(lz_decompress(std::string{}, 0U).empty());
+}
+
+TEST_CASE("blog/sies/lz_codec/round trip"
+         , "Compressing then decompressing yields the original data"
+         )
+{
+  std::string const texts[] = { "a", "abc", "abcd", "abcdabcd"
+                              , std::string(1000U, 'x')
+                              , std::string(14U, 'y') + std::string(300U, 'z')
+                              , "The quick brownie crossed the road. "
+                                "The quick brownie crossed the road again."
+                              };
+  for (auto const & t : texts)
+    {
+      CHECK(lz_decompress(lz_compress(t), t.size())==t);
+    }
+  std::minstd_rand rnd{7U};
+  std::string noise;
+  for (int i{0}; i!=100000; ++i)
+    {
+      noise += static_cast<char>(rnd());
+    }
+  CHECK(lz_decompress(lz_compress(noise), noise.size())==noise);
+}
+
+TEST_CASE("blog/sies/lz_codec/decompress appending"
+         , "Decompressing into a string appends to its existing contents"
+         )
+{
+  std::string const first{"abcdabcdabcd"};
+  std::string const second(300U, 'z');
+  std::string out{"prefix"};
+  lz_decompress(lz_compress(first).data(), lz_compress(first).size(), first.size(), out);
+  lz_decompress(lz_compress(second).data(), lz_compress(second).size(), second.size(), out);
+  CHECK(out=="prefix"+first+second);
+  auto bad(lz_compress(second));
+  CHECK_THROWS_AS(lz_decompress(bad.data(), bad.size(), second.size()+1U, out), lz_codec_error);
+}
+
+TEST_CASE("blog/sies/lz_codec/text compresses"
+         , "Repetitive and word based text is smaller when compressed"
+         )
+{
+  std::string const repeated(10000U, 'x');
+  CHECK(lz_compress(repeated).size()<100U);
+  rnd_text_info_maker make_rnd_text_info(1U,1U, 2000U,2000U, 2U,7U);
+  auto text(make_rnd_text_info()->text());
+  auto compressed(lz_compress(text));
+  CHECK(compressed.size()<text.size());
+  CHECK(lz_decompress(compressed, text.size())==text);
+}
+
+TEST_CASE("blog/sies/lz_codec/corrupt data rejected"
+         , "Decompressing invalid data or to the wrong size throws"
+         )
+{
+  std::string const text{"abcabcabcabcabcabcabcabc"};
+  auto compressed(lz_compress(text));
+  CHECK_THROWS_AS(lz_decompress(compressed, text.size()-1U), lz_codec_error);
+  CHECK_THROWS_AS(lz_decompress(compressed, text.size()+1U), lz_codec_error);
+  CHECK_THROWS_AS( lz_decompress(compressed.substr(0U, compressed.size()-1U)
+                                , text.size())
+                 , lz_codec_error
+                 );
+  std::string bad_offset{"\x14" "abcd" "\x09\x00", 7U};
+  CHECK_THROWS_AS(lz_decompress(bad_offset, 16U), lz_codec_error);
+  CHECK_THROWS_AS(lz_decompress(std::string{"\xf0"}, 20U), lz_codec_error);
+}
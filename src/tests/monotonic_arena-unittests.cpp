@@ -0,0 +1,123 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file monotonic_arena-unittests.cpp
+/// @brief Tests for monotonic_arena class and arena_allocator class template.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "monotonic_arena.h"
+#include "text_registry.h"
+#include "atomic-policies.h"
+#include "catch.hpp"
+#include <vector>
+#include <map>
+#include <cstdint>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/monotonic_arena/allocate"
+         , "Allocations are aligned, do not overlap and grow the arena as needed"
+         )
+{
+  monotonic_arena arena{256U};
+  CHECK(arena.bytes_reserved()==0U);
+  auto a(static_cast<char *>(arena.allocate(3U, 1U)));
+  auto b(static_cast<char *>(arena.allocate(8U, 8U)));
+  CHECK(reinterpret_cast<std::uintptr_t>(b)%8U==0U);
+  CHECK(b>=a+3);
+  CHECK(arena.bytes_allocated()==11U);
+  auto reserved(arena.bytes_reserved());
+  CHECK(reserved>=256U);
+  auto big(static_cast<char *>(arena.allocate(10000U, 16U)));
+  CHECK(reinterpret_cast<std::uintptr_t>(big)%16U==0U);
+  big[0] = big[9999] = 'x';
+  CHECK(arena.bytes_reserved()>=reserved+10000U);
+  arena.deallocate(big, 10000U);
+  CHECK(arena.bytes_allocated()==10011U);
+}
+
+TEST_CASE("blog/sies/arena_allocator/containers"
+         , "Containers allocate from an allocator's arena, or from the heap if "
+           "it has none"
+         )
+{
+  monotonic_arena arena;
+  arena_allocator<int> alloc{&arena};
+  std::vector<int, arena_allocator<int>> v(alloc);
+  for (int i{0}; i!=1000; ++i)
+    {
+      v.push_back(i);
+    }
+  CHECK(v[999]==999);
+  CHECK(arena.bytes_allocated()>=1000U*sizeof(int));
+  typedef std::pair<int const, int> pair_type;
+  std::map<int, int, std::less<int>, arena_allocator<pair_type>> m(alloc);
+  m[1] = 2;
+  CHECK(m.get_allocator()==alloc);
+  CHECK(m.get_allocator().resource()==&arena);
+
+  auto allocated(arena.bytes_allocated());
+  std::vector<int, arena_allocator<int>> heap_v;
+  heap_v.assign(100U, 7);
+  CHECK(heap_v.get_allocator().resource()==nullptr);
+  CHECK(heap_v.get_allocator()!=alloc);
+  CHECK(arena.bytes_allocated()==allocated);
+}
+
+TEST_CASE("blog/sies/basic_text_info/arena allocated"
+         , "A text_info built in an arena gives the same answers as one using "
+           "the heap and queries do not allocate from the arena"
+         )
+{
+  typedef basic_text_info<default_counter_widths, arena_allocator<char>>
+                                                          arena_text_info;
+  std::string const chunks[] = { "The quick brownie crossed the road."
+                               , "Then it slept, then slept again."
+                               , "Long enough to not fit a short string buffer."
+                               };
+  monotonic_arena arena;
+  {
+    arena_text_info ti{arena_allocator<char>{&arena}};
+    text_info reference;
+    for (auto const & c : chunks)
+      {
+        ti.add_text_chunk(c);
+        reference.add_text_chunk(c);
+      }
+    CHECK(ti.get_allocator().resource()==&arena);
+    CHECK(ti.chunk_data(0U).word_occ_map.get_allocator().resource()==&arena);
+    auto allocated(arena.bytes_allocated());
+    CHECK(allocated>0U);
+    CHECK(ti.text()==reference.text());
+    CHECK(ti.chunk_text(2U)==chunks[2]);
+    CHECK(ti.word_occurrence("Then")==reference.word_occurrence("Then"));
+    CHECK(ti.chunk_word_occurrence(2U,"short")==1U);
+    CHECK(ti.char_occurrence('e')==reference.char_occurrence('e'));
+    CHECK(ti.word_count()==reference.word_count());
+    CHECK(arena.bytes_allocated()==allocated);
+  }
+  CHECK(arena.bytes_reserved()!=0U);
+}
+
+TEST_CASE("blog/sies/basic_text_registry/arena allocated"
+         , "A text_registry may be built in an arena"
+         )
+{
+  typedef basic_text_info<compact_counter_widths, arena_allocator<char>>
+                                                          arena_text_info;
+  monotonic_arena arena;
+  text_info_options opts;
+  opts.compress_text = true;
+  basic_text_registry<arena_text_info, non_atomic>
+                                    reg{opts, arena_allocator<char>{&arena}};
+  reg.add_text_chunk("Words words words words words words words.");
+  reg.add_text_chunk("Other words.");
+  reg.setup_complete();
+  CHECK(reg.word_occurrence("words")==8U);
+  CHECK(reg.chunk_text(1U)=="Other words.");
+  CHECK(reg.text_data().get_allocator().resource()==&arena);
+}
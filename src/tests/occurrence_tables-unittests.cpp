@@ -0,0 +1,176 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file occurrence_tables-unittests.cpp
+/// @brief Tests for occurrence table policies and table types.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "occurrence_tables.h"
+#include "text_image.h"
+#include "monotonic_arena.h"
+#include "catch.hpp"
+#include <map>
+#include <string>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  template <class Table>
+  std::map<typename Table::key_type, unsigned> as_map(Table const & table)
+  {
+    std::map<typename Table::key_type, unsigned> result;
+    for (auto const & entry : table)
+      {
+        result[entry.first] = entry.second;
+      }
+    return result;
+  }
+
+  template <class Tables>
+  void check_table_policy()
+  {
+    typedef typename Tables::template table_type
+                          <std::string, unsigned, std::allocator<char>> table;
+    table words;
+    CHECK(words.size()==0U);
+    CHECK(words.find("missing")==words.end());
+    std::map<std::string, unsigned> expected;
+    for (unsigned i{0U}; i!=1000U; ++i)
+      {
+        auto key(std::to_string(i*7919U%211U));
+        ++words[key];
+        ++expected[key];
+      }
+    CHECK(words.size()==expected.size());
+    CHECK(as_map(words)==expected);
+    for (auto const & e : expected)
+      {
+        auto pos(words.find(e.first));
+        REQUIRE(pos!=words.end());
+        CHECK(pos->second==e.second);
+      }
+    CHECK(words.find("211")==words.end());
+
+    table same;
+    for (auto e=expected.rbegin(); e!=expected.rend(); ++e)
+      {
+        same[e->first] = e->second;
+      }
+    CHECK(same==words);
+    ++same["extra"];
+    CHECK(same!=words);
+
+    typedef typename Tables::template table_type
+                          <char, std::uint16_t, std::allocator<char>> char_table;
+    char_table chars;
+    for (int c{-128}; c!=128; ++c)
+      {
+        chars[static_cast<char>(c)] = static_cast<std::uint16_t>(c+128);
+      }
+    CHECK(chars.size()==256U);
+    CHECK(chars.find('\0')->second==128U);
+    CHECK(chars.find('\xff')->second==127U);
+  }
+
+  template <class Tables>
+  void check_text_info_policy()
+  {
+    typedef basic_text_info<default_counter_widths, std::allocator<char>, Tables>
+                                                              policy_text_info;
+    std::string const chunks[] = { "The cat sat on the mat. THE END."
+                                 , ""
+                                 , "\xC2\xA3" "5 for the hat"
+                                 };
+    text_info reference;
+    policy_text_info ti;
+    for (auto const & c : chunks)
+      {
+        reference.add_text_chunk(c);
+        ti.add_text_chunk(c);
+      }
+    CHECK(ti.word_occurrence("the")==reference.word_occurrence("the"));
+    CHECK(ti.word_occurrence("dog")==0U);
+    CHECK(ti.char_occurrence('t')==reference.char_occurrence('t'));
+    CHECK(ti.chunk_word_occurrence(2U,"HAT")==1U);
+    CHECK(ti.chunk_char_occurrence(0U,'.')==2U);
+    CHECK( ti.chunk_data(0U).word_occ_map.size()
+        ==reference.chunk_data(0U).word_occ_map.size()
+         );
+    typedef typename policy_text_info::chunk_info chunk_info;
+    CHECK(chunk_info{chunks[0]}==ti.chunk_data(0U));
+    CHECK(chunk_info{chunks[2]}!=ti.chunk_data(0U));
+
+    text_image_builder ref_image{reference};
+    basic_text_image_builder<policy_text_info> image{ti};
+    REQUIRE(image.size()==ref_image.size());
+    std::vector<char> ref_bytes(ref_image.size());
+    std::vector<char> bytes(image.size());
+    ref_image.write(ref_bytes.data());
+    image.write(bytes.data());
+    CHECK(bytes==ref_bytes);
+  }
+}
+
+TEST_CASE("blog/sies/occurrence_tables/map"
+         , "std::map tables count, find, iterate and compare"
+         )
+{
+  check_table_policy<map_occurrence_tables>();
+  check_text_info_policy<map_occurrence_tables>();
+}
+
+TEST_CASE("blog/sies/occurrence_tables/sorted vector"
+         , "Sorted vector tables count, find, iterate in key order and compare"
+         )
+{
+  check_table_policy<sorted_vector_occurrence_tables>();
+  check_text_info_policy<sorted_vector_occurrence_tables>();
+  sorted_vector_occurrence_table<std::string, unsigned, std::allocator<char>> t;
+  t["b"] = 2U;
+  t["c"] = 3U;
+  t["a"] = 1U;
+  std::string keys;
+  for (auto const & e : t)
+    {
+      keys += e.first;
+    }
+  CHECK(keys=="abc");
+}
+
+TEST_CASE("blog/sies/occurrence_tables/hash"
+         , "Hash tables count, find, iterate and compare independent of "
+           "insertion order"
+         )
+{
+  check_table_policy<hash_occurrence_tables>();
+  check_text_info_policy<hash_occurrence_tables>();
+}
+
+TEST_CASE("blog/sies/occurrence_tables/arena allocation"
+         , "Table entries, and string keys, are allocated from an arena"
+         )
+{
+  monotonic_arena arena;
+  typedef hash_occurrence_table
+              < std::basic_string< char, std::char_traits<char>
+                                 , arena_allocator<char>
+                                 >
+              , unsigned, arena_allocator<char>
+              >                                               arena_table;
+  arena_table table{arena_table::allocator_type{&arena}};
+  arena_table::key_type key( "a much longer than short string key"
+                          , arena_allocator<char>{&arena}
+                          );
+  ++table[key];
+  auto after_insert(arena.bytes_allocated());
+  CHECK(after_insert>0U);
+  CHECK(table.find(key)->first.get_allocator().resource()==&arena);
+  ++table[key];
+  CHECK(table.find(key)->second==2U);
+  CHECK(arena.bytes_allocated()==after_insert);
+}
@@ -0,0 +1,220 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file packed_word-unittests.cpp
+/// @brief Tests for basic_packed_word class template.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "packed_word.h"
+#include "monotonic_arena.h"
+#include "text_info.h"
+#include "catch.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <new>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  template <class Word>
+  void check_ordering_and_round_trip()
+  {
+    std::vector<std::string> words
+        { "", "a", "ab", std::string("ab\0", 3U), "abc", "b", "zzzzzzz"
+        , "abcdefg", "abcdefgh", "abcdefghijklmno", "abcdefghijklmnop"
+        , "abcdefghijklmnopq", "abcdefghijklmnoq", "\xC2\xA3" "5"
+        , "averyveryverylongwordindeed", "averyveryverylongwordindeee"
+        };
+    std::sort(words.begin(), words.end());
+    for (std::size_t i{0U}; i!=words.size(); ++i)
+      {
+        Word wi(words[i]);
+        CHECK(wi.size()==words[i].size());
+        CHECK(wi.str()==words[i]);
+        CHECK(wi.is_inline()==(words[i].size()<=Word::MaxInlineSize));
+        CHECK(Word(wi)==wi);
+        for (std::size_t j{0U}; j!=words.size(); ++j)
+          {
+            Word wj(words[j]);
+            CHECK((wi==wj)==(i==j));
+            CHECK((wi<wj)==(i<j));
+            if (i==j)
+              {
+                CHECK(wi.hash()==wj.hash());
+              }
+          }
+      }
+  }
+}
+
+TEST_CASE("blog/sies/basic_packed_word/16 byte"
+         , "Words order as strings do, round trip, and only long words are "
+           "held out of line"
+         )
+{
+  CHECK(packed_word::MaxInlineSize==15U);
+  check_ordering_and_round_trip<packed_word>();
+}
+
+TEST_CASE("blog/sies/basic_packed_word/8 byte"
+         , "8 byte packed words hold up to 7 bytes inline"
+         )
+{
+  CHECK(basic_packed_word<8U>::MaxInlineSize==7U);
+  check_ordering_and_round_trip<basic_packed_word<8U>>();
+}
+
+TEST_CASE("blog/sies/basic_packed_word/folded"
+         , "Folded words have [A-Z] replaced by [a-z], inline and out of line"
+         )
+{
+  std::string const word("The-QUICK-brown-FOX-JUMPED");
+  auto short_key(packed_word::folded(word.data(), 9U));
+  CHECK(short_key==packed_word{"the-quick"});
+  auto long_key(packed_word::folded(word.data(), word.size()));
+  CHECK(long_key==packed_word{tolower(word)});
+  CHECK(long_key.str()==tolower(word));
+}
+
+TEST_CASE("blog/sies/basic_packed_word/copy and move"
+         , "Copies and moves preserve the word; moved from words are empty "
+           "or still valid"
+         )
+{
+  packed_word long_word{"antidisestablishmentarianism"};
+  packed_word copy{long_word};
+  packed_word moved{std::move(copy)};
+  CHECK(moved==long_word);
+  CHECK(copy.empty());
+  CHECK(copy.str()=="");
+  CHECK(copy==packed_word{});
+  packed_word assigned{"x"};
+  assigned = long_word;
+  CHECK(assigned==long_word);
+  assigned = packed_word{"y"};
+  CHECK(assigned.str()=="y");
+  assigned = std::move(moved);
+  CHECK(assigned==long_word);
+  CHECK(moved.empty());
+  CHECK(moved.str()=="");
+  moved = "z";
+  CHECK(moved.str()=="z");
+}
+
+namespace
+{
+// Allocator that throws std::bad_alloc while its failing flag is set.
+// Allocators sharing a flag compare equal.
+  template <typename T>
+  class failing_allocator
+  {
+    template <typename U> friend class failing_allocator;
+
+    bool const * failing;
+
+  public:
+    typedef T value_type;
+
+    explicit failing_allocator(bool const * f) noexcept : failing{f} {}
+
+    template <typename U>
+    failing_allocator(failing_allocator<U> const & other) noexcept
+    : failing{other.failing}
+    {}
+
+    T * allocate(std::size_t n)
+    {
+      if (*failing)
+        {
+          throw std::bad_alloc{};
+        }
+      return static_cast<T *>(::operator new(n*sizeof(T)));
+    }
+
+    void deallocate(T * p, std::size_t) { ::operator delete(p); }
+
+    template <typename U>
+    bool operator==(failing_allocator<U> const & other) const noexcept
+    {
+      return failing==other.failing;
+    }
+
+    template <typename U>
+    bool operator!=(failing_allocator<U> const & other) const noexcept
+    {
+      return failing!=other.failing;
+    }
+  };
+}
+
+TEST_CASE("blog/sies/basic_packed_word/failed copy"
+         , "A word is unchanged if allocating a copy's tail fails"
+         )
+{
+  typedef basic_packed_word<16U, failing_allocator<char>> failing_word;
+  bool failing{false};
+  bool other_failing{false};
+  failing_allocator<char> alloc{&failing};
+  std::string const long_text{"a word too long to pack"};
+  std::string const other_text{"another word too long to pack"};
+  failing_word long_word(long_text.data(), long_text.size(), alloc);
+  failing_word other_word( other_text.data(), other_text.size()
+                         , failing_allocator<char>{&other_failing}
+                         );
+  failing_word short_word("short", 5U, alloc);
+  failing_word target(other_text.data(), other_text.size(), alloc);
+  failing = true;
+  CHECK_THROWS_AS(short_word = long_word, std::bad_alloc);
+  CHECK(short_word.str()=="short");
+  CHECK(short_word.size()==5U);
+  CHECK_THROWS_AS(target = long_word, std::bad_alloc);
+  CHECK(target.str()==other_text);
+  CHECK_THROWS_AS(target = std::move(other_word), std::bad_alloc);
+  CHECK(target.str()==other_text);
+  CHECK(other_word.str()==other_text);
+  CHECK_THROWS_AS(failing_word{long_word}, std::bad_alloc);
+  CHECK_THROWS_AS( failing_word(long_text.data(), long_text.size(), alloc)
+                 , std::bad_alloc
+                 );
+  target = short_word;
+  CHECK(target.str()=="short");
+  failing = false;
+  target = long_word;
+  CHECK(target.str()==long_text);
+}
+
+TEST_CASE("blog/sies/basic_packed_word/arena"
+         , "Only long words allocate, from the word's allocator"
+         )
+{
+  typedef basic_packed_word<16U, arena_allocator<char>> arena_word;
+  monotonic_arena arena;
+  arena_allocator<char> alloc{&arena};
+  arena_word short_word("short", 5U, alloc);
+  CHECK(arena.bytes_allocated()==0U);
+  arena_word long_word("a word too long to pack", 23U, alloc);
+  CHECK(arena.bytes_allocated()>=8U);
+  arena_word copy(long_word);
+  CHECK(copy.get_allocator().resource()==&arena);
+  CHECK(copy.str()=="a word too long to pack");
+}
+
+TEST_CASE("blog/sies/text_info/packed word keys"
+         , "Word tables hold packed keys and find long and short words in any "
+           "case"
+         )
+{
+  text_info ti;
+  ti.add_text_chunk("Supercalifragilistic SUPERCALIFRAGILISTIC word Word");
+  CHECK(ti.chunk_data(0U).word_occ_map.size()==2U);
+  CHECK(ti.chunk_word_occurrence(0U,"supercalifragilistic")==2U);
+  CHECK(ti.chunk_word_occurrence(0U,"WORD")==2U);
+  CHECK(ti.word_occurrence("supercalifragilisti")==0U);
+  CHECK(ti.chunk_data(0U).word_occ_map.find("word")->first.is_inline());
+}
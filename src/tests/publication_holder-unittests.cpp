@@ -0,0 +1,163 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file publication_holder-unittests.cpp
+/// @brief Tests for publication_holder class template.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "publication_holder.h"
+#include "text_registry.h"
+#include "atomic-policies.h"
+#include "catch.hpp"
+#include <thread>
+#include <vector>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  struct counted
+  {
+    static int live;
+    int value;
+    explicit counted(int v) : value{v} { ++live; }
+    ~counted() { --live; }
+  };
+  int counted::live{0};
+
+  typedef std::unique_ptr<counted const> counted_ptr;
+}
+
+TEST_CASE("blog/sies/publication_holder/nothing published"
+         , "Pinning a holder with nothing published yields a null version"
+         )
+{
+  publication_holder<counted> holder{1U};
+  auto rdr(holder.register_reader());
+  auto guard(rdr.pin());
+  CHECK(!guard);
+  CHECK(guard.get()==nullptr);
+}
+
+TEST_CASE("blog/sies/publication_holder/publish then read"
+         , "Pinning a holder after publishing yields the published version"
+         )
+{
+  publication_holder<counted> holder{1U};
+  holder.publish(counted_ptr{new counted{42}});
+  auto rdr(holder.register_reader());
+  auto guard(rdr.pin());
+  REQUIRE(guard);
+  CHECK(guard->value==42);
+}
+
+TEST_CASE("blog/sies/publication_holder/unpinned retired version reclaimed"
+         , "Republishing with no pinned readers reclaims the old version"
+         )
+{
+  {
+    publication_holder<counted> holder{2U};
+    holder.publish(counted_ptr{new counted{1}});
+    holder.publish(counted_ptr{new counted{2}});
+    CHECK(counted::live==1);
+    CHECK(holder.reclaim()==0U);
+  }
+  CHECK(counted::live==0);
+}
+
+TEST_CASE("blog/sies/publication_holder/pinned retired version kept"
+         , "A version pinned by a reader is not reclaimed until unpinned"
+         )
+{
+  publication_holder<counted> holder{2U};
+  holder.publish(counted_ptr{new counted{1}});
+  auto rdr(holder.register_reader());
+  {
+    auto guard(rdr.pin());
+    holder.publish(counted_ptr{new counted{2}});
+    CHECK(counted::live==2);
+    CHECK(holder.reclaim()==1U);
+    CHECK(guard->value==1);
+    auto nested(rdr.pin());
+    CHECK(nested->value==2);
+  }
+  CHECK(holder.reclaim()==0U);
+  CHECK(counted::live==1);
+  CHECK(rdr.pin()->value==2);
+}
+
+TEST_CASE("blog/sies/publication_holder/reader slots exhausted"
+         , "Registering more readers than slots throws; released slots reused"
+         )
+{
+  publication_holder<counted> holder{1U};
+  {
+    auto rdr(holder.register_reader());
+    CHECK_THROWS_AS(holder.register_reader(), reader_slots_exhausted);
+  }
+  auto rdr(holder.register_reader());
+  CHECK(!rdr.pin());
+}
+
+TEST_CASE("blog/sies/publication_holder/concurrent swaps of registries"
+         , "Readers always see a complete published text_registry while"
+           " an updater repeatedly publishes new versions"
+         )
+{
+  typedef text_registry
+          < atomic
+          , std::memory_order_release
+          , std::memory_order_acquire
+          >                                       registry_type;
+  typedef std::unique_ptr<registry_type const>    registry_ptr;
+  auto make_registry([](unsigned n) -> registry_ptr
+                     {
+                       std::unique_ptr<registry_type> p{new registry_type};
+                       for (auto i=0U; i!=n; ++i)
+                         {
+                           p->add_text_chunk("word ");
+                         }
+                       p->setup_complete();
+                       return registry_ptr{p.release()};
+                     }
+                    );
+  unsigned const NumberOfReaders{4U};
+  unsigned const NumberOfVersions{200U};
+  publication_holder<registry_type> holder{NumberOfReaders};
+  holder.publish(make_registry(1U));
+  std::atomic<bool> done{false};
+  std::atomic<unsigned> failures{0U};
+  std::vector<std::thread> readers;
+  for (auto r=0U; r!=NumberOfReaders; ++r)
+    {
+      readers.push_back(std::thread([&]()
+        {
+          auto rdr(holder.register_reader());
+          while (!done.load())
+            {
+              auto guard(rdr.pin());
+              if ( guard->word_count()!=guard->number_of_chunks()
+                || guard->word_occurrence("word")!=guard->word_count()
+                 )
+                {
+                  ++failures;
+                }
+            }
+        }));
+    }
+  for (auto v=2U; v<=NumberOfVersions; ++v)
+    {
+      holder.publish(make_registry(v%20U+1U));
+    }
+  done.store(true);
+  for (auto & t : readers)
+    {
+      t.join();
+    }
+  CHECK(failures.load()==0U);
+  CHECK(holder.reclaim()==0U);
+}
@@ -0,0 +1,101 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file query_protocol-unittests.cpp
+/// @brief Tests for query_protocol encoding, decoding and execution.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "query_protocol.h"
+#include "text_info.h"
+#include "catch.hpp"
+
+using namespace dibase::blog::sies;
+using namespace dibase::blog::sies::query_protocol;
+
+TEST_CASE("blog/sies/query_protocol/request round trip"
+         , "An encoded request decodes to the same request"
+         )
+{
+  std::string buffer;
+  append_request(buffer, request{7U, opcode::chunk_word_occurrence, 3U, '\0', "Word"});
+  append_request(buffer, request{8U, opcode::char_occurrence, 0U, 'z', ""});
+  request req;
+  auto used(parse_request(buffer.data(), buffer.size(), req));
+  REQUIRE(used!=0U);
+  CHECK(req.id==7U);
+  CHECK(req.op==opcode::chunk_word_occurrence);
+  CHECK(req.chunk_index==3U);
+  CHECK(req.word=="Word");
+  auto used2(parse_request(buffer.data()+used, buffer.size()-used, req));
+  CHECK(used+used2==buffer.size());
+  CHECK(req.id==8U);
+  CHECK(req.op==opcode::char_occurrence);
+  CHECK(req.chr=='z');
+}
+
+TEST_CASE("blog/sies/query_protocol/partial request"
+         , "Parsing an incomplete request frame consumes nothing"
+         )
+{
+  std::string buffer;
+  append_request(buffer, request{1U, opcode::word_occurrence, 0U, '\0', "word"});
+  request req;
+  for (std::size_t size{0U}; size!=buffer.size(); ++size)
+    {
+      CHECK(parse_request(buffer.data(), size, req)==0U);
+    }
+}
+
+TEST_CASE("blog/sies/query_protocol/malformed requests"
+         , "Malformed frames decode as invalid requests, over-long ones throw"
+         )
+{
+  std::string buffer;
+  append_request(buffer, request{9U, opcode::chunk_text, 1U, '\0', ""});
+  buffer.resize(buffer.size()-1U);
+  buffer[0] = static_cast<char>(buffer[0]-1);
+  request req;
+  CHECK(parse_request(buffer.data(), buffer.size(), req)==buffer.size());
+  CHECK(req.op==opcode::invalid);
+  CHECK(req.id==9U);
+  CHECK(execute(text_info{}, req).result==status::bad_request);
+  std::string too_long(4U, '\xff');
+  CHECK_THROWS_AS(parse_request(too_long.data(), too_long.size(), req), query_protocol_error);
+}
+
+TEST_CASE("blog/sies/query_protocol/execute and respond"
+         , "Executed requests give same results as direct queries and"
+           " responses round trip"
+         )
+{
+  text_info ti;
+  ti.add_text_chunk("Hello world. Hello!");
+  auto count_resp(execute(ti, request{1U, opcode::word_occurrence, 0U, '\0', "HELLO"}));
+  CHECK(count_resp.result==status::ok);
+  CHECK(count_resp.count==2U);
+  auto text_resp(execute(ti, request{2U, opcode::chunk_text, 0U, '\0', ""}));
+  CHECK(text_resp.text==ti.chunk_text(0U));
+  auto range_resp(execute(ti, request{3U, opcode::chunk_text, 1U, '\0', ""}));
+  CHECK(range_resp.result==status::out_of_range);
+
+  std::string buffer;
+  append_response(buffer, count_resp, opcode::word_occurrence);
+  append_response(buffer, text_resp, opcode::chunk_text);
+  append_response(buffer, range_resp, opcode::chunk_text);
+  response resp;
+  std::size_t pos{0U};
+  pos += parse_response(buffer.data(), buffer.size(), opcode::word_occurrence, resp);
+  CHECK(resp.id==1U);
+  CHECK(resp.count==2U);
+  pos += parse_response(buffer.data()+pos, buffer.size()-pos, opcode::chunk_text, resp);
+  CHECK(resp.id==2U);
+  CHECK(resp.text==ti.chunk_text(0U));
+  pos += parse_response(buffer.data()+pos, buffer.size()-pos, opcode::chunk_text, resp);
+  CHECK(resp.id==3U);
+  CHECK(resp.result==status::out_of_range);
+  CHECK(pos==buffer.size());
+}
@@ -0,0 +1,153 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file shared_text_image-unittests.cpp
+/// @brief Tests for text images in POSIX shared memory.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "shared_text_image.h"
+#include "text_registry.h"
+#include "catch.hpp"
+#include <system_error>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  template <class T>
+  struct no_sync
+  {
+    T data;
+    explicit no_sync(T d) : data{d} {}
+    void store(T d) { data = d; }
+    T load() const { return data; }
+  };
+
+  std::string test_image_name()
+  {
+    return "/sies-unittest-" + std::to_string(::getpid());
+  }
+}
+
+TEST_CASE("blog/sies/shared_text_image/export then map"
+         , "A published registry exported to shared memory can be mapped"
+           " and queried, and removed once done with"
+         )
+{
+  text_registry<no_sync> tr;
+  tr.add_text_chunk("Hello, shared world!");
+  tr.add_text_chunk("hello again");
+  tr.setup_complete();
+  auto name(test_image_name());
+  remove_shared_text_image(name);
+  export_shared_text_image(name, tr.text_data());
+  {
+    shared_text_image image{name};
+    CHECK(image.view().number_of_chunks()==2U);
+    CHECK(image.view().text()==tr.text());
+    CHECK(image.view().word_occurrence("HELLO")==2U);
+    CHECK(image.view().chunk_word_count(1U)==2U);
+  }
+  CHECK(remove_shared_text_image(name));
+  CHECK_FALSE(remove_shared_text_image(name));
+  CHECK_THROWS_AS(shared_text_image{name}, std::system_error);
+}
+
+TEST_CASE("blog/sies/shared_text_image/export compacted"
+         , "A compacted registry's image exported to shared memory has all"
+           " of the registry's chunks"
+         )
+{
+  text_info_options compacting;
+  compacting.compact_on_publish = true;
+  compacting.compress_text = true;
+  text_registry<no_sync> tr{compacting};
+  tr.add_text_chunk("Hello, shared world!");
+  tr.add_text_chunk("hello again");
+  tr.setup_complete();
+  REQUIRE(tr.compacted_image()!=nullptr);
+  CHECK_THROWS_AS(tr.text_data(), std::logic_error);
+  auto name(test_image_name());
+  remove_shared_text_image(name);
+  export_shared_text_image(name, tr.compacted_image()->view());
+  {
+    shared_text_image image{name};
+    CHECK(image.view().number_of_chunks()==2U);
+    CHECK(image.view().text()==tr.text());
+    CHECK(image.view().word_occurrence("HELLO")==2U);
+    CHECK(image.view().chunk_text(1U)=="hello again");
+  }
+  CHECK(remove_shared_text_image(name));
+}
+
+TEST_CASE("blog/sies/shared_text_image/export exclusive"
+         , "Exporting to an existing shared memory object name fails"
+         )
+{
+  text_info ti;
+  auto name(test_image_name());
+  remove_shared_text_image(name);
+  export_shared_text_image(name, ti);
+  CHECK_THROWS_AS(export_shared_text_image(name, ti), std::system_error);
+  CHECK(remove_shared_text_image(name));
+}
+
+TEST_CASE("blog/sies/shared_text_image/unwritten object"
+         , "Mapping a shared memory object not yet written by its exporter"
+           " is refused"
+         )
+{
+  auto name(test_image_name());
+  remove_shared_text_image(name);
+  int fd{::shm_open(name.c_str(), O_RDWR|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR)};
+  REQUIRE(fd!=-1);
+  CHECK_THROWS_AS(shared_text_image{name}, bad_text_image);
+  text_info ti;
+  ti.add_text_chunk("text");
+  text_image_builder builder{ti};
+  REQUIRE(::ftruncate(fd, builder.size())==0);
+  CHECK_THROWS_AS(shared_text_image{name}, bad_text_image);
+  ::close(fd);
+  CHECK(remove_shared_text_image(name));
+}
+
+TEST_CASE("blog/sies/shared_text_image/other process"
+         , "A text image exported by one process is queryable by another"
+         )
+{
+  text_info ti;
+  ti.add_text_chunk("one two two three three three");
+  auto name(test_image_name());
+  remove_shared_text_image(name);
+  export_shared_text_image(name, ti);
+  auto pid(::fork());
+  REQUIRE(pid!=-1);
+  if (pid==0)
+    {
+      int status{1};
+      try
+        {
+          shared_text_image image{name};
+          status = image.view().word_occurrence("three")==3U ? 0 : 2;
+        }
+      catch (...)
+        {
+        }
+      ::_exit(status);
+    }
+  int status{-1};
+  ::waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status));
+  CHECK(WEXITSTATUS(status)==0);
+  remove_shared_text_image(name);
+}
@@ -0,0 +1,142 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file static_text_info-unittests.cpp
+/// @brief Tests for compile time analysed static text information.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "static_text_info.h"
+#include "text_info.h"
+#include "catch.hpp"
+#include <string>
+#include <stdexcept>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  struct prose
+  {
+    static constexpr char text[]
+        = "The quick brown fox jumps over the lazy dog. THE DOG sleeps; "
+          "the fox doesn't. Internationalisation, internationalization and "
+          "INTERNATIONALISATIONS differ from international, internationally "
+          "and Internationalisation. \xC2\xA3" "5 for caf\xC3\xA9 au lait!\n";
+  };
+  constexpr char prose::text[];
+
+  struct empty
+  {
+    static constexpr char text[] = "";
+  };
+  constexpr char empty::text[];
+
+  struct separators_only
+  {
+    static constexpr char text[] = " .,;\t\n-- ";
+  };
+  constexpr char separators_only::text[];
+
+  struct one_word
+  {
+    static constexpr char text[] = "word";
+  };
+  constexpr char one_word::text[];
+
+  typedef static_text_info<prose, empty, separators_only, one_word> reference;
+  constexpr reference ref{};
+
+  static_assert(ref.number_of_chunks()==4U, "Chunks counted at compile time");
+  static_assert( ref.char_count()==sizeof(prose::text)+sizeof(separators_only::text)
+                                  +sizeof(one_word::text)-3U
+               , "Characters counted at compile time"
+               );
+  static_assert(ref.chunk_word_count(2U)==0U, "Words counted at compile time");
+  static_assert(ref.chunk_word_count(3U)==1U, "Words counted at compile time");
+  static_assert(ref.chunk_char_occurrence(3U, 'o')==1U, "Compile time query");
+  static_assert(ref.char_occurrence('\n')==2U, "Compile time query");
+
+  void add_reference_chunks(text_info & ti)
+  {
+    for (std::size_t i{0U}; i!=ref.number_of_chunks(); ++i)
+      {
+        ti.add_text_chunk(ref.chunk_text(i));
+      }
+  }
+}
+
+TEST_CASE("blog/sies/static_text_info/matches text_info"
+         , "Static text information gives the results text_info does"
+         )
+{
+  text_info ti;
+  add_reference_chunks(ti);
+  REQUIRE(ref.number_of_chunks()==ti.number_of_chunks());
+  CHECK(ref.text()==ti.text());
+  CHECK(ref.char_count()==ti.char_count());
+  CHECK(ref.word_count()==ti.word_count());
+  for (int chr{-128}; chr!=128; ++chr)
+    {
+      CHECK(ref.char_occurrence(static_cast<char>(chr))
+                                    ==ti.char_occurrence(static_cast<char>(chr)));
+    }
+  for (std::size_t i{0U}; i!=ref.number_of_chunks(); ++i)
+    {
+      CHECK(ref.chunk_text(i)==ti.chunk_text(i));
+      CHECK(ref.chunk_char_count(i)==ti.chunk_char_count(i));
+      CHECK(ref.chunk_word_count(i)==ti.chunk_word_count(i));
+      CHECK(ref.chunk_char_occurrence(i, 'o')==ti.chunk_char_occurrence(i, 'o'));
+      for (auto const & w : ti.chunk_data(i).word_occ_map)
+        {
+          auto word(w.first.str());
+          CHECK(ref.chunk_word_occurrence(i, word)==w.second);
+          CHECK(ref.word_occurrence(word)==ti.word_occurrence(word));
+        }
+    }
+}
+
+TEST_CASE("blog/sies/static_text_info/words"
+         , "Static text information word queries fold case and split words"
+         )
+{
+  CHECK(ref.word_occurrence("the")==4U);
+  CHECK(ref.word_occurrence("THE")==4U);
+  CHECK(ref.word_occurrence("dog")==2U);
+  CHECK(ref.word_occurrence("internationalisation")==2U);
+  CHECK(ref.word_occurrence("Internationalization")==1U);
+  CHECK(ref.word_occurrence("internationalisations")==1U);
+  CHECK(ref.word_occurrence("internationa")==0U);
+  CHECK(ref.word_occurrence("caf\xC3\xA9")==1U);
+  CHECK(ref.word_occurrence("doesn")==1U);
+  CHECK(ref.word_occurrence("doesn't")==0U);
+  CHECK(ref.word_occurrence("cat")==0U);
+  CHECK(ref.word_occurrence("")==0U);
+  CHECK(ref.chunk_word_occurrence(3U, "word")==1U);
+  CHECK(ref.chunk_word_occurrence(1U, "word")==0U);
+}
+
+TEST_CASE("blog/sies/static_text_info/word chars"
+         , "Static text information splits words using its word characters"
+         )
+{
+  constexpr basic_static_text_info<alnum_apostrophe_word_chars, prose> apostrophes{};
+  CHECK(apostrophes.word_occurrence("doesn't")==1U);
+  CHECK(apostrophes.word_occurrence("doesn")==0U);
+  CHECK(apostrophes.word_occurrence("caf")==1U);
+  CHECK(apostrophes.word_count()==ref.chunk_word_count(0U)-1U);
+}
+
+TEST_CASE("blog/sies/static_text_info/bad index"
+         , "Static text information chunk queries check the chunk index"
+         )
+{
+  CHECK_THROWS_AS(ref.chunk_text(4U), std::out_of_range);
+  CHECK_THROWS_AS(ref.chunk_char_count(4U), std::out_of_range);
+  CHECK_THROWS_AS(ref.chunk_word_count(4U), std::out_of_range);
+  CHECK_THROWS_AS(ref.chunk_char_occurrence(4U, 'a'), std::out_of_range);
+  CHECK_THROWS_AS(ref.chunk_word_occurrence(4U, "a"), std::out_of_range);
+}
@@ -0,0 +1,169 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file text_image-unittests.cpp
+/// @brief Tests for text_image_builder and text_image_view.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "text_image.h"
+#include "rnd_text_info_maker.h"
+#include "catch.hpp"
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/text_image/empty text_info"
+         , "An image of an empty text_info has no chunks, text or counts"
+         )
+{
+  text_info ti;
+  auto image(text_image_builder{ti}.make());
+  text_image_view view{image.data(), image.size()*sizeof(image[0])};
+  CHECK(view.number_of_chunks()==0U);
+  CHECK(view.text()=="");
+  CHECK(view.char_count()==0U);
+  CHECK(view.word_count()==0U);
+  CHECK(view.char_occurrence('a')==0U);
+  CHECK(view.word_occurrence("a")==0U);
+  CHECK_THROWS_AS(view.chunk_text(0U), std::out_of_range);
+}
+
+TEST_CASE("blog/sies/text_image/same answers as text_info"
+         , "An image view answers all queries as the text_info it was made from"
+         )
+{
+  text_info ti;
+  std::string const chunks[] = { "The quick brownie crossed the road."
+                               , ""
+                               , "'123'>.|z-@123?y*xx:y+\n; 123 xx;/123 xx::<<<<"
+                               , "THE END \xa3\xff"
+                               };
+  for (auto const & c : chunks)
+    {
+      ti.add_text_chunk(c);
+    }
+  auto image(text_image_builder{ti}.make());
+  text_image_view view{image.data(), image.size()*sizeof(image[0])};
+  REQUIRE(view.number_of_chunks()==ti.number_of_chunks());
+  CHECK(view.text()==ti.text());
+  CHECK(view.char_count()==ti.char_count());
+  CHECK(view.word_count()==ti.word_count());
+  for (int c{-128}; c!=128; ++c)
+    {
+      CHECK(view.char_occurrence(char(c))==ti.char_occurrence(char(c)));
+    }
+  std::string const words[] = {"the", "THE", "road", "123", "xx", "z", "nosuch", ""};
+  for (auto const & w : words)
+    {
+      CHECK(view.word_occurrence(w)==ti.word_occurrence(w));
+    }
+  for (text_info::chunk_index_type i{0U}; i!=ti.number_of_chunks(); ++i)
+    {
+      CHECK(view.chunk_text(i)==ti.chunk_text(i));
+      CHECK(view.chunk_char_count(i)==ti.chunk_char_count(i));
+      CHECK(view.chunk_word_count(i)==ti.chunk_word_count(i));
+      for (int c{-128}; c!=128; ++c)
+        {
+          CHECK(view.chunk_char_occurrence(i,char(c))==ti.chunk_char_occurrence(i,char(c)));
+        }
+      for (auto const & w : words)
+        {
+          CHECK(view.chunk_word_occurrence(i,w)==ti.chunk_word_occurrence(i,w));
+        }
+    }
+}
+
+TEST_CASE("blog/sies/text_image/position independent"
+         , "An image copied to a different address gives the same answers"
+         )
+{
+  auto pti((rnd_text_info_maker{5,10, 10,50, 1,4})());
+  text_image_builder builder{*pti};
+  std::vector<std::uint64_t> moved(builder.size()/sizeof(std::uint64_t));
+  {
+    auto image(builder.make());
+    std::memcpy(moved.data(), image.data(), builder.size());
+  }
+  text_image_view view{moved.data(), builder.size()};
+  CHECK(view.text()==pti->text());
+  CHECK(view.word_count()==pti->word_count());
+  CHECK(view.word_occurrence("ee")==pti->word_occurrence("ee"));
+}
+
+TEST_CASE("blog/sies/text_image/invalid images rejected"
+         , "Constructing a view of something not a valid image throws"
+         )
+{
+  text_info ti;
+  ti.add_text_chunk("text");
+  auto image(text_image_builder{ti}.make());
+  auto size(image.size()*sizeof(image[0]));
+  CHECK_THROWS_AS((text_image_view{image.data(), 4U}), bad_text_image);
+  CHECK_THROWS_AS((text_image_view{image.data(), size-8U}), bad_text_image);
+  image[0] = 0U;
+  CHECK_THROWS_AS((text_image_view{image.data(), size}), bad_text_image);
+}
+
+TEST_CASE("blog/sies/text_image/out of bounds offsets rejected"
+         , "Constructing a view of an image with a section, chunk or word"
+           " outside the image throws"
+         )
+{
+  text_info ti;
+  ti.add_text_chunk("some text");
+  ti.add_text_chunk("more text");
+  auto const good(text_image_builder{ti}.make());
+  auto size(good.size()*sizeof(good[0]));
+  CHECK_NOTHROW((text_image_view{good.data(), size}));
+  std::size_t const header_fields[] = {6U, 7U, 8U, 9U};
+  auto const chunks(good[7]/8U);
+  std::size_t const chunk_fields[] = {chunks, chunks+3U, chunks+5U, chunks+6U
+                                     , chunks+7U
+                                     };
+  std::size_t const word_fields[] = {good[8]/8U, good[8]/8U+1U};
+  for (auto const & fields : { std::vector<std::size_t>( std::begin(header_fields)
+                                                       , std::end(header_fields)
+                                                       )
+                             , std::vector<std::size_t>( std::begin(chunk_fields)
+                                                       , std::end(chunk_fields)
+                                                       )
+                             , std::vector<std::size_t>( std::begin(word_fields)
+                                                       , std::end(word_fields)
+                                                       )
+                             }
+      )
+    {
+      for (auto field : fields)
+        {
+          for (std::uint64_t bad : {std::uint64_t(size), ~std::uint64_t{0U}})
+            {
+              auto image(good);
+              image[field] = bad;
+              CHECK_THROWS_AS((text_image_view{image.data(), size}), bad_text_image);
+            }
+        }
+    }
+}
+
+TEST_CASE("blog/sies/text_image/compressed text_info"
+         , "An image of a text_info holding compressed text contains the text"
+         )
+{
+  text_info_options opts;
+  opts.compress_text = true;
+  text_info ti{opts};
+  ti.add_text_chunk("Compressed text, compressed text, compressed text.");
+  ti.add_text_chunk("");
+  ti.add_text_chunk("More text.");
+  auto image(text_image_builder{ti}.make());
+  text_image_view view{image.data(), image.size()*sizeof(image[0])};
+  CHECK(view.text()==ti.text());
+  CHECK(view.chunk_text(2U)=="More text.");
+  CHECK(view.word_occurrence("compressed")==3U);
+}
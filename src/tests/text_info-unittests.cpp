@@ -15,7 +15,14 @@
 /// @author Ralph E. McArdell
 
 #include "text_info.h"
+#include "worker_pool.h"
+#include "monotonic_arena.h"
 #include "catch.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <limits>
+#include <new>
 
 using namespace dibase::blog::sies;
 
@@ -214,6 +221,9 @@ TEST_CASE("blog/sies/text_info::chunk_info/construct with wordy string"
   expected.chunk = "The quick brownie crossed the road.";
   expected.char_count = expected.chunk.size();
   expected.word_count = 6;
+  expected.fingerprint = text_fingerprint( expected.chunk.data()
+                                         , expected.chunk.size()
+                                         );
   expected.char_occ_map[' '] = 5;
   expected.char_occ_map['.'] = 1;
   expected.char_occ_map['T'] = 1;
@@ -241,6 +251,20 @@ TEST_CASE("blog/sies/text_info::chunk_info/construct with wordy string"
   CHECK(text_info::chunk_info{expected.chunk}==expected);
 }
 
+TEST_CASE("blog/sies/text_info::chunk_info/construct with fingerprint"
+         ,"Constructing a text_info::chunk_info object with its text's"
+          " fingerprint collects the same values as computing it"
+         )
+{
+  std::string const text{"The quick brownie crossed the road."};
+  auto print(text_fingerprint(text.data(), text.size()));
+  text_info::chunk_info ci{ text, print
+                          , text_info::allocator_type{}, true
+                          };
+  CHECK(ci==text_info::chunk_info{text});
+  CHECK(ci.fingerprint==print);
+}
+
 
 TEST_CASE("blog/sies/text_info::number_of_chunks/default constructed object"
          ,"A default constructed text_info object has no chunks"
@@ -668,3 +692,778 @@ TEST_CASE("blog/sies/text_info::word_occurrence/many chunks"
 }
 
 
+
+TEST_CASE("blog/sies/text_info/compressed text"
+         , "A text_info holding chunk text compressed, with or without a cache, "
+           "gives the same answers as one holding text uncompressed"
+         )
+{
+  std::string const chunk_text[]={ "The quick brownie crossed the road."
+                                 , ""
+                                 , "Then it slept, then it slept again, then it "
+                                   "slept again and again and again."
+                                 , "A quick sleep."
+                                 };
+  text_info plain;
+  text_info_options opts;
+  opts.compress_text = true;
+  text_info compressed{opts};
+  opts.text_cache_capacity = 0U;
+  text_info uncached{opts};
+  for (auto const & c : chunk_text)
+    {
+      plain.add_text_chunk(c);
+      compressed.add_text_chunk(c);
+      uncached.add_text_chunk(c);
+    }
+  CHECK(compressed.stored_text_size()<plain.stored_text_size());
+  CHECK(plain.stored_text_size()==plain.char_count());
+  for (int pass{0}; pass!=2; ++pass) // 2nd pass served from cache
+    {
+      for (text_info::chunk_index_type i{0U}; i!=plain.number_of_chunks(); ++i)
+        {
+          CHECK(compressed.chunk_text(i)==chunk_text[i]);
+          CHECK(uncached.chunk_text(i)==chunk_text[i]);
+          CHECK(compressed.chunk_word_occurrence(i,"again")
+                            ==plain.chunk_word_occurrence(i,"again"));
+        }
+      CHECK(compressed.text()==plain.text());
+      CHECK(uncached.text()==plain.text());
+    }
+  CHECK(compressed.char_count()==plain.char_count());
+  CHECK(compressed.word_count()==plain.word_count());
+  CHECK(compressed.word_occurrence("then")==plain.word_occurrence("then"));
+  CHECK(compressed.chunk_data(2U).chunk.empty());
+  CHECK_THROWS_AS(compressed.chunk_text(4U), std::out_of_range);
+}
+
+TEST_CASE("blog/sies/basic_text_info/narrow counters"
+         , "Per-chunk counts use the chunk counter type, totals the total "
+           "counter type, and chunks too large for the chunk counter type are "
+           "rejected"
+         )
+{
+  typedef basic_text_info<small_counter_widths> small_text_info;
+  static_assert( sizeof(small_text_info::chunk_size_type)==2U
+               , "Expected 16 bit chunk counts"
+               );
+  static_assert( sizeof(small_text_info::chunk_info::word_occ_map_type
+                                          ::mapped_type)==2U
+               , "Expected 16 bit word count table entries"
+               );
+  small_text_info ti;
+  std::string const max_chunk(65535U, 'a');
+  ti.add_text_chunk(max_chunk);
+  ti.add_text_chunk(max_chunk);
+  CHECK(ti.chunk_char_count(1U)==65535U);
+  CHECK(ti.chunk_char_occurrence(1U,'a')==65535U);
+  CHECK(ti.char_count()==2U*65535U);
+  CHECK(ti.char_occurrence('a')==2U*65535U);
+  CHECK_THROWS_AS(ti.add_text_chunk(max_chunk+"a"), chunk_too_large);
+  CHECK(ti.number_of_chunks()==2U);
+
+  basic_text_info<compact_counter_widths> compact;
+  compact.add_text_chunk("one two two");
+  CHECK(compact.word_occurrence("two")==2U);
+  CHECK(compact.word_count()==3U);
+}
+
+TEST_CASE("blog/sies/text_info/chunk range counts"
+         , "Character and word counts of a range of chunks sum the chunks' "
+           "counts"
+         )
+{
+  text_info ti;
+  ti.add_text_chunk("One two.");
+  ti.add_text_chunk("Three four five!");
+  ti.add_text_chunk("Six");
+  CHECK(ti.char_count(0U,3U)==ti.char_count());
+  CHECK(ti.word_count(0U,3U)==ti.word_count());
+  CHECK(ti.char_count(1U,2U)==19U);
+  CHECK(ti.word_count(1U,2U)==4U);
+  CHECK(ti.char_count(3U,0U)==0U);
+  CHECK(ti.word_count(2U,0U)==0U);
+  CHECK_THROWS_AS(ti.char_count(2U,2U), std::out_of_range);
+  CHECK_THROWS_AS(ti.word_count(4U,0U), std::out_of_range);
+}
+
+TEST_CASE("blog/sies/text_info/char count columns"
+         , "Holding per-character counts in columns gives the same "
+           "occurrences as the per-chunk maps"
+         )
+{
+  text_info_options opts;
+  opts.char_count_columns = true;
+  text_info columns{opts};
+  text_info maps;
+  std::string const chunks[] = {"Hello World!", "", "\xC2\xA3 llama"};
+  for (auto const & c : chunks)
+    {
+      columns.add_text_chunk(c);
+      maps.add_text_chunk(c);
+    }
+  for (int chr{-128}; chr!=128; ++chr)
+    {
+      CHECK(columns.char_occurrence(chr)==maps.char_occurrence(chr));
+      for (auto i=0U; i!=maps.number_of_chunks(); ++i)
+        {
+          CHECK( columns.chunk_char_occurrence(i,chr)
+              ==maps.chunk_char_occurrence(i,chr)
+               );
+        }
+    }
+  CHECK(columns.char_occurrence('l')==5U);
+  CHECK_THROWS_AS(columns.chunk_char_occurrence(3U,'l'), std::out_of_range);
+  columns.clear();
+  CHECK(columns.char_occurrence('l')==0U);
+}
+
+TEST_CASE("blog/sies/text_info/occurrence totals"
+         , "Totals kept as chunks are added match totals summed over chunks"
+         )
+{
+  text_info_options opts;
+  opts.occurrence_totals = true;
+  basic_text_info< default_counter_widths, std::allocator<char>
+                 , hash_occurrence_tables
+                 > totals{opts};
+  text_info sums;
+  std::string const chunks[] = { "Hello World!", "", "\xC2\xA3 llama hello"
+                               , "internationalisation INTERNATIONALISATION"
+                               };
+  for (auto const & c : chunks)
+    {
+      totals.add_text_chunk(c);
+      sums.add_text_chunk(c);
+      CHECK(totals.char_count()==sums.char_count(0U, sums.number_of_chunks()));
+      CHECK(totals.word_count()==sums.word_count(0U, sums.number_of_chunks()));
+    }
+  for (int chr{-128}; chr!=128; ++chr)
+    {
+      CHECK(totals.char_occurrence(chr)==sums.char_occurrence(chr));
+    }
+  for (auto word : {"hello", "HELLO", "world", "llama", "internationalisation", "x", ""})
+    {
+      CHECK(totals.word_occurrence(word)==sums.word_occurrence(word));
+    }
+  CHECK(totals.word_occurrence("Internationalisation")==2U);
+  text_stats_query query;
+  query.chars = {'l', 'o'};
+  query.words = {"hello"};
+  auto stats(totals.stats(query));
+  CHECK(stats.char_occurrences[0]==8U);
+  CHECK(stats.char_occurrences[1]==5U);
+  CHECK(stats.word_occurrences[0]==2U);
+  CHECK(stats.text.empty());
+  totals.clear();
+  CHECK(totals.char_count()==0U);
+  CHECK(totals.word_count()==0U);
+  CHECK(totals.char_occurrence('l')==0U);
+  CHECK(totals.word_occurrence("hello")==0U);
+  totals.add_text_chunk("Hello");
+  CHECK(totals.word_occurrence("hello")==1U);
+  CHECK(totals.char_count()==5U);
+}
+
+TEST_CASE("blog/sies/text_info/lazy analysis"
+         , "Chunks analysed on first query give the results of eager analysis"
+         )
+{
+  std::string const chunks[] = { "Hello World!", "", "\xC2\xA3 llama hello"
+                               , "The quick brown fox. THE END"
+                               };
+  text_info eager;
+  for (auto const & c : chunks)
+    {
+      eager.add_text_chunk(c);
+    }
+  text_info_options lazy_opts;
+  lazy_opts.lazy_analysis = true;
+  text_info_options columns{lazy_opts};
+  columns.char_count_columns = true;
+  text_info_options compressed{lazy_opts};
+  compressed.compress_text = true;
+  text_info_options totals{lazy_opts};
+  totals.occurrence_totals = true;
+  for (auto const & opts : {lazy_opts, columns, compressed, totals})
+    {
+      text_info lazy{opts};
+      for (auto const & c : chunks)
+        {
+          lazy.add_text_chunk(c);
+        }
+      CHECK(lazy.char_count()==eager.char_count());
+      CHECK(lazy.chunk_word_count(3U)==eager.chunk_word_count(3U));
+      CHECK(lazy.word_count(0U, 2U)==eager.word_count(0U, 2U));
+      CHECK(lazy.word_count()==eager.word_count());
+      for (auto i=0U; i!=eager.number_of_chunks(); ++i)
+        {
+          CHECK(lazy.chunk_text(i)==eager.chunk_text(i));
+          CHECK(lazy.chunk_char_count(i)==eager.chunk_char_count(i));
+          CHECK(lazy.chunk_word_count(i)==eager.chunk_word_count(i));
+          CHECK(lazy.chunk_char_occurrence(i,'l')==eager.chunk_char_occurrence(i,'l'));
+          CHECK(lazy.chunk_word_occurrence(i,"THE")==eager.chunk_word_occurrence(i,"THE"));
+          CHECK(lazy.chunk_data(i).word_occ_map==eager.chunk_data(i).word_occ_map);
+        }
+      for (int chr{-128}; chr!=128; ++chr)
+        {
+          CHECK(lazy.char_occurrence(chr)==eager.char_occurrence(chr));
+        }
+      CHECK(lazy.word_occurrence("hello")==2U);
+      CHECK_THROWS_AS(lazy.chunk_word_count(4U), std::out_of_range);
+      CHECK_THROWS_AS(lazy.chunk_char_occurrence(4U,'l'), std::out_of_range);
+      lazy.clear();
+      CHECK(lazy.word_count()==0U);
+      lazy.add_text_chunk("hello again");
+      CHECK(lazy.word_occurrence("hello")==1U);
+    }
+}
+
+TEST_CASE("blog/sies/text_info/lazy analysis concurrent queries"
+         , "Chunks analysed on first query are analysed once by one thread"
+         )
+{
+  text_info_options opts;
+  opts.lazy_analysis = true;
+  opts.occurrence_totals = true;
+  text_info lazy{opts};
+  text_info eager;
+  for (auto i=0U; i!=64U; ++i)
+    {
+      std::string chunk(i%7U+1U, 'a');
+      chunk += " b cc b " + std::to_string(i);
+      lazy.add_text_chunk(chunk);
+      eager.add_text_chunk(chunk);
+    }
+  std::vector<std::thread> threads;
+  std::vector<text_info::total_size_type> word_counts(8U);
+  std::vector<text_info::total_size_type> bs(8U);
+  for (auto t=0U; t!=8U; ++t)
+    {
+      threads.emplace_back
+        ( [&lazy, &word_counts, &bs, t]()
+          {
+            for (auto i=0U; i!=lazy.number_of_chunks(); ++i)
+              {
+                lazy.chunk_word_count((i+t*8U)%lazy.number_of_chunks());
+              }
+            word_counts[t] = lazy.word_count();
+            bs[t] = lazy.word_occurrence("b");
+          }
+        );
+    }
+  for (auto & t : threads)
+    {
+      t.join();
+    }
+  for (auto t=0U; t!=8U; ++t)
+    {
+      CHECK(word_counts[t]==eager.word_count());
+      CHECK(bs[t]==eager.word_occurrence("b"));
+    }
+}
+
+TEST_CASE("blog/sies/text_info/deduplicate chunks"
+         , "Chunks with identical text share storage but answer as before"
+         )
+{
+  std::string const header{"Copyright (c) Example Limited. All rights reserved."};
+  std::string const chunks[] = { header, "Hello World!", header, "", header
+                               , "hello world", "", "Hello World!"
+                               };
+  text_info plain;
+  for (auto const & c : chunks)
+    {
+      plain.add_text_chunk(c);
+    }
+  text_info_options dedup;
+  dedup.deduplicate_chunks = true;
+  text_info_options compressed{dedup};
+  compressed.compress_text = true;
+  text_info_options lazy{dedup};
+  lazy.lazy_analysis = true;
+  lazy.char_count_columns = true;
+  text_info_options totals{dedup};
+  totals.occurrence_totals = true;
+  for (auto const & opts : {dedup, compressed, lazy, totals})
+    {
+      text_info shared{opts};
+      for (auto const & c : chunks)
+        {
+          shared.add_text_chunk(c);
+        }
+      REQUIRE(shared.number_of_chunks()==plain.number_of_chunks());
+      CHECK(shared.text()==plain.text());
+      CHECK(shared.char_count()==plain.char_count());
+      CHECK(shared.word_count()==plain.word_count());
+      CHECK(shared.word_count(1U, 3U)==plain.word_count(1U, 3U));
+      for (auto i=0U; i!=plain.number_of_chunks(); ++i)
+        {
+          CHECK(shared.chunk_text(i)==plain.chunk_text(i));
+          CHECK(shared.chunk_char_count(i)==plain.chunk_char_count(i));
+          CHECK(shared.chunk_word_count(i)==plain.chunk_word_count(i));
+          CHECK(shared.chunk_char_occurrence(i,'l')==plain.chunk_char_occurrence(i,'l'));
+          CHECK(shared.chunk_word_occurrence(i,"hello")==plain.chunk_word_occurrence(i,"hello"));
+        }
+      CHECK(shared.char_occurrence('e')==plain.char_occurrence('e'));
+      CHECK(shared.word_occurrence("rights")==3U);
+      CHECK(shared.word_occurrence("world")==plain.word_occurrence("world"));
+      CHECK(&shared.chunk_data(0U)==&shared.chunk_data(4U));
+      CHECK(&shared.chunk_data(1U)==&shared.chunk_data(7U));
+      CHECK(&shared.chunk_data(1U)!=&shared.chunk_data(5U));
+      CHECK(shared.stored_text_size()<plain.stored_text_size());
+      CHECK_THROWS_AS(shared.chunk_text(8U), std::out_of_range);
+      shared.clear();
+      shared.add_text_chunk(header);
+      CHECK(shared.number_of_chunks()==1U);
+      CHECK(shared.text()==header);
+    }
+  text_info shared{dedup};
+  shared.add_text_chunk(header);
+  shared.add_text_chunk(header);
+  CHECK(shared.stored_text_size()==header.size());
+}
+
+TEST_CASE("blog/sies/text_info/fingerprints and digest"
+         , "Chunk fingerprints and text digests compare chunks as integers"
+         )
+{
+  text_info a;
+  text_info b;
+  CHECK(a.digest()==b.digest());
+  CHECK(a.digest()==EmptyDigest);
+  for (auto c : {"Hello World!", "", "The END"})
+    {
+      a.add_text_chunk(c);
+      b.add_text_chunk(c);
+    }
+  CHECK(a.digest()==b.digest());
+  CHECK(a.chunk_fingerprint(2U)==text_fingerprint("The END", 7U));
+  CHECK(a.chunk_fingerprint(1U)==text_info::chunk_info{}.fingerprint);
+  CHECK(a.chunk_data(0U)==b.chunk_data(0U));
+  CHECK(a.chunk_data(0U)!=b.chunk_data(2U));
+  CHECK(a.chunk_data(0U).matches(b.chunk_data(0U)));
+  CHECK_FALSE(a.chunk_data(0U).matches(b.chunk_data(2U)));
+  CHECK(differing_chunks(a, b).empty());
+  CHECK_THROWS_AS(a.chunk_fingerprint(3U), std::out_of_range);
+
+  text_info c;
+  for (auto t : {"Hello World!", "The END", ""})
+    {
+      c.add_text_chunk(t);
+    }
+  CHECK(c.digest()!=a.digest());
+  CHECK(differing_chunks(a, c)==(std::vector<std::uint64_t>{1U, 2U}));
+  c.add_text_chunk("More");
+  CHECK(differing_chunks(c, a)==(std::vector<std::uint64_t>{1U, 2U, 3U}));
+
+  text_info_options opts;
+  opts.deduplicate_chunks = true;
+  opts.compress_text = true;
+  text_info d{opts};
+  for (auto t : {"Hello World!", "", "The END"})
+    {
+      d.add_text_chunk(t);
+    }
+  CHECK(d.digest()==a.digest());
+  CHECK(differing_chunks(a, d).empty());
+  d.clear();
+  CHECK(d.digest()==EmptyDigest);
+}
+
+namespace
+{
+  std::string wordy_text(std::size_t number_of_words)
+  {
+    std::string const words[] = { "The", "quick", "BROWN", "fox's", "caf\xC3\xA9"
+                                , "internationalisation", "Internationalisation"
+                                , "a", "\xC2\xA3" "5", "don't", "x_y", "jumped"
+                                };
+    std::string const separators[] = {" ", ", ", ".\n", "  ", "-", "\t"};
+    std::string text;
+    for (std::size_t i{0U}; i!=number_of_words; ++i)
+      {
+        text += words[(i*7U+i/5U)%12U];
+        text += separators[(i*5U+i/3U)%6U];
+      }
+    return text;
+  }
+
+  template <class TextInfo>
+  void check_parallel_analysis(std::string const & text, std::size_t workers)
+  {
+    typedef typename TextInfo::chunk_info chunk_info;
+    worker_pool pool{workers};
+    chunk_info serial{text};
+    chunk_info parallel{text, typename TextInfo::allocator_type{}, false};
+    parallel.analyse_in_parallel( text.data(), text.size()
+                                , typename TextInfo::allocator_type{}, pool
+                                );
+    CHECK(parallel.word_count==serial.word_count);
+    CHECK(parallel.char_occ_map==serial.char_occ_map);
+    CHECK(parallel.word_occ_map==serial.word_occ_map);
+    CHECK(parallel==serial);
+  }
+}
+
+TEST_CASE("blog/sies/text_info/parallel analysis"
+         , "Chunks analysed in parallel segments match serial analysis"
+         )
+{
+  typedef basic_text_info< default_counter_widths, std::allocator<char>
+                         , hash_occurrence_tables
+                         > hash_text_info;
+  typedef basic_text_info< default_counter_widths, std::allocator<char>
+                         , map_occurrence_tables, alnum_apostrophe_tokenizer
+                         > apostrophe_text_info;
+  for (std::size_t workers : {1U, 3U, 8U})
+    {
+      for (auto text : {wordy_text(20000U), wordy_text(3U), std::string{"word"}
+                       , std::string{" ., "}, std::string{}
+                       }
+          )
+        {
+          check_parallel_analysis<text_info>(text, workers);
+          check_parallel_analysis<hash_text_info>(text, workers);
+          check_parallel_analysis<apostrophe_text_info>(text, workers);
+        }
+    }
+
+  text_info_options opts;
+  opts.parallel_analysis_threshold = 1U;
+  text_info parallel{opts};
+  opts.parallel_analysis_threshold = 0U;
+  text_info serial{opts};
+  for (auto text : {wordy_text(5000U), std::string{}, wordy_text(7U)})
+    {
+      parallel.add_text_chunk(text);
+      serial.add_text_chunk(text);
+    }
+  CHECK(parallel.word_count()==serial.word_count());
+  for (auto i=0U; i!=serial.number_of_chunks(); ++i)
+    {
+      CHECK(parallel.chunk_data(i)==serial.chunk_data(i));
+    }
+}
+
+TEST_CASE("blog/sies/text_info/append"
+         , "Appending objects' chunks matches adding their text to one object"
+         )
+{
+  std::string const chunks[] = { "Hello World!", "", "the cat sat on the mat"
+                               , "Hello World!", wordy_text(50U), "hello world"
+                               };
+  text_info whole;
+  for (auto const & c : chunks)
+    {
+      whole.add_text_chunk(c);
+    }
+  text_info_options compressed;
+  compressed.compress_text = true;
+  text_info_options lazy;
+  lazy.lazy_analysis = true;
+  text_info_options dedup;
+  dedup.deduplicate_chunks = true;
+  dedup.compress_text = true;
+  text_info_options totals;
+  totals.occurrence_totals = true;
+  totals.char_count_columns = true;
+  auto const all_options = {text_info_options{}, compressed, lazy, dedup, totals};
+  for (auto const & part_opts : all_options)
+    {
+      for (auto const & opts : all_options)
+        {
+          for (bool move : {false, true})
+            {
+              text_info first{part_opts};
+              text_info second{part_opts};
+              for (auto i=0U; i!=3U; ++i)
+                {
+                  first.add_text_chunk(chunks[i]);
+                  second.add_text_chunk(chunks[i+3U]);
+                }
+              if (part_opts.lazy_analysis)
+                {
+                  CHECK(second.chunk_word_count(1U)==whole.chunk_word_count(4U));
+                }
+              text_info merged{opts};
+              merged.append(first);
+              if (move)
+                {
+                  merged.append(std::move(second));
+                  CHECK(second.number_of_chunks()==0U);
+                }
+              else
+                {
+                  merged.append(second);
+                  CHECK(second.number_of_chunks()==3U);
+                }
+              CHECK(first.number_of_chunks()==3U);
+              REQUIRE(merged.number_of_chunks()==whole.number_of_chunks());
+              CHECK(merged.text()==whole.text());
+              CHECK(merged.digest()==whole.digest());
+              CHECK(merged.char_count()==whole.char_count());
+              CHECK(merged.word_count()==whole.word_count());
+              CHECK(merged.char_occurrence('o')==whole.char_occurrence('o'));
+              CHECK(merged.word_occurrence("hello")==whole.word_occurrence("hello"));
+              CHECK(merged.word_occurrence("the")==whole.word_occurrence("the"));
+              for (auto i=0U; i!=whole.number_of_chunks(); ++i)
+                {
+                  CHECK(merged.chunk_text(i)==whole.chunk_text(i));
+                  CHECK(merged.chunk_word_count(i)==whole.chunk_word_count(i));
+                  CHECK(merged.chunk_char_occurrence(i,'l')==whole.chunk_char_occurrence(i,'l'));
+                  CHECK(merged.chunk_word_occurrence(i,"world")==whole.chunk_word_occurrence(i,"world"));
+                }
+              if (opts.deduplicate_chunks)
+                {
+                  CHECK(&merged.chunk_data(0U)==&merged.chunk_data(3U));
+                }
+              else if (!opts.compress_text && !part_opts.compress_text)
+                {
+                  CHECK(merged.chunk_data(4U)==whole.chunk_data(4U));
+                }
+            }
+        }
+    }
+
+  text_info self;
+  self.add_text_chunk("a b");
+  self.add_text_chunk("c");
+  self.append(self);
+  self.append(std::move(self));
+  CHECK(self.number_of_chunks()==8U);
+  CHECK(self.text()=="a bca bca bca bc");
+  CHECK(self.word_count()==12U);
+}
+
+TEST_CASE("blog/sies/text_info/append between arenas"
+         , "Chunks appended from another arena's object are copied to this arena"
+         )
+{
+  typedef basic_text_info<default_counter_widths, arena_allocator<char>>
+                                                          arena_text_info;
+  monotonic_arena source_arena;
+  monotonic_arena target_arena;
+  arena_text_info merged{arena_allocator<char>{&target_arena}};
+  {
+    arena_text_info source{arena_allocator<char>{&source_arena}};
+    source.add_text_chunk("Words longer than sixteen characters: incomprehensibilities");
+    source.add_text_chunk("short words");
+    merged.append(std::move(source));
+  }
+  auto used(target_arena.bytes_allocated());
+  CHECK(used!=0U);
+  REQUIRE(merged.number_of_chunks()==2U);
+  CHECK(merged.word_occurrence("INCOMPREHENSIBILITIES")==1U);
+  CHECK(merged.word_count()==8U);
+  CHECK(merged.chunk_text(1U)=="short words");
+}
+
+namespace
+{
+// Allocator that throws std::bad_alloc once a shared allocation budget is
+// used up. Allocators sharing a budget compare equal.
+  template <typename T>
+  class budget_allocator
+  {
+    template <typename U> friend class budget_allocator;
+
+    std::size_t * budget;
+
+  public:
+    typedef T value_type;
+
+    budget_allocator() noexcept : budget{nullptr} {}
+    explicit budget_allocator(std::size_t * b) noexcept : budget{b} {}
+
+    template <typename U>
+    budget_allocator(budget_allocator<U> const & other) noexcept
+    : budget{other.budget}
+    {}
+
+    T * allocate(std::size_t n)
+    {
+      if (budget!=nullptr)
+        {
+          if (*budget==0U)
+            {
+              throw std::bad_alloc{};
+            }
+          --*budget;
+        }
+      return static_cast<T *>(::operator new(n*sizeof(T)));
+    }
+
+    void deallocate(T * p, std::size_t) { ::operator delete(p); }
+
+    template <typename U>
+    bool operator==(budget_allocator<U> const & other) const noexcept
+    {
+      return budget==other.budget;
+    }
+
+    template <typename U>
+    bool operator!=(budget_allocator<U> const & other) const noexcept
+    {
+      return budget!=other.budget;
+    }
+  };
+}
+
+TEST_CASE("blog/sies/text_info/append move failure"
+         , "If moving another object's chunks fails the other object is left"
+           " unchanged or empty and this object keeps whole chunks"
+         )
+{
+  typedef basic_text_info<default_counter_widths, budget_allocator<char>>
+                                                          budget_text_info;
+  std::string const chunks[] = { "Words longer than sixteen characters: "
+                                 "incomprehensibilities"
+                               , "short words", "", wordy_text(20U)
+                               };
+  text_info_options compressed;
+  compressed.compress_text = true;
+  for (auto const & opts : {text_info_options{}, compressed})
+    {
+      bool appended{false};
+      for (std::size_t allowed{0U}; !appended; ++allowed)
+        {
+          std::size_t budget{std::numeric_limits<std::size_t>::max()};
+          budget_allocator<char> alloc{&budget};
+          budget_text_info merged{opts, alloc};
+          merged.add_text_chunk("first");
+          budget_text_info source{alloc};
+          for (auto const & c : chunks)
+            {
+              source.add_text_chunk(c);
+            }
+          budget = allowed;
+          try
+            {
+              merged.append(std::move(source));
+              appended = true;
+            }
+          catch (std::bad_alloc &)
+            {
+            }
+          budget = std::numeric_limits<std::size_t>::max();
+          auto n(merged.number_of_chunks());
+          if (n==1U && source.number_of_chunks()!=0U)
+            { // Failed before anything was taken from source
+              REQUIRE(source.number_of_chunks()==4U);
+              CHECK(source.text()==chunks[0]+chunks[1]+chunks[2]+chunks[3]);
+              CHECK(source.word_occurrence("words")==2U);
+            }
+          else
+            {
+              CHECK(source.number_of_chunks()==0U);
+              CHECK(source.char_count()==0U);
+              CHECK(source.word_count()==0U);
+              CHECK(source.text()=="");
+              CHECK(source.word_occurrence("words")==0U);
+            }
+          REQUIRE(n>=1U);
+          REQUIRE(n<=5U);
+          std::string expected{"first"};
+          std::size_t words{1U};
+          for (auto i=1U; i!=n; ++i)
+            {
+              CHECK(merged.chunk_text(i)==chunks[i-1U]);
+              expected += chunks[i-1U];
+              words += merged.chunk_word_count(i);
+            }
+          CHECK(merged.text()==expected);
+          CHECK(merged.char_count()==expected.size());
+          CHECK(merged.word_count()==words);
+          CHECK(appended==(n==5U));
+        }
+    }
+}
+
+TEST_CASE("blog/sies/text_info/parallel reduction"
+         , "Aggregate queries reduced in parallel match serial reduction"
+         )
+{
+  text_info_options serial_opts;
+  serial_opts.parallel_reduction_threshold = 0U;
+  text_info_options parallel_opts;
+  parallel_opts.parallel_reduction_threshold = 1U;
+  text_info_options columns{parallel_opts};
+  columns.char_count_columns = true;
+  text_info_options lazy{parallel_opts};
+  lazy.lazy_analysis = true;
+  text_info serial{serial_opts};
+  for (auto i=0U; i!=100U; ++i)
+    {
+      serial.add_text_chunk(wordy_text(i%13U) + (i%3U==0U ? " Hello" : ""));
+    }
+  text_stats_query query;
+  query.chars = {'e', 'z', ' '};
+  query.words = {"hello", "missing"};
+  auto expected(serial.stats(query));
+  for (auto const & opts : {parallel_opts, columns, lazy})
+    {
+      text_info parallel{opts};
+      parallel.append(serial);
+      CHECK(parallel.char_count(3U, 90U)==serial.char_count(3U, 90U));
+      CHECK(parallel.word_count(1U, 99U)==serial.word_count(1U, 99U));
+      CHECK(parallel.word_count(5U, 0U)==0U);
+      CHECK(parallel.char_occurrence('e')==serial.char_occurrence('e'));
+      CHECK(parallel.word_occurrence("hello")==serial.word_occurrence("hello"));
+      CHECK(parallel.word_occurrence("hello")==34U);
+      auto stats(parallel.stats(query));
+      CHECK(stats.char_occurrences==expected.char_occurrences);
+      CHECK(stats.word_occurrences==expected.word_occurrences);
+      CHECK(stats.word_count==expected.word_count);
+    }
+}
+
+TEST_CASE("blog/sies/text_info/concurrent parallel reduction"
+         , "Several threads querying over the reduction threshold at once get"
+           " the same results as serial queries"
+         )
+{
+  text_info_options serial_opts;
+  serial_opts.parallel_reduction_threshold = 0U;
+  text_info_options parallel_opts;
+  parallel_opts.parallel_reduction_threshold = 1U;
+  text_info serial{serial_opts};
+  text_info parallel{parallel_opts};
+  for (auto i=0U; i!=500U; ++i)
+    {
+      auto text(wordy_text(i%17U) + (i%4U==0U ? " Hello" : ""));
+      serial.add_text_chunk(text);
+      parallel.add_text_chunk(text);
+    }
+  text_stats_query query;
+  query.chars = {'e', ' '};
+  query.words = {"hello", "the"};
+  auto expected(serial.stats(query));
+  std::atomic<unsigned> mismatches{0U};
+  std::vector<std::thread> readers;
+  for (auto t=0U; t!=4U; ++t)
+    {
+      readers.emplace_back([&]()
+                           {
+                             for (auto n=0U; n!=200U; ++n)
+                               {
+                                 auto stats(parallel.stats(query));
+                                 if ( stats.char_occurrences
+                                         !=expected.char_occurrences
+                                   || stats.word_occurrences
+                                         !=expected.word_occurrences
+                                   || parallel.word_count(7U, 400U)
+                                         !=serial.word_count(7U, 400U)
+                                    )
+                                   {
+                                     ++mismatches;
+                                   }
+                               }
+                           });
+    }
+  for (auto & r : readers)
+    {
+      r.join();
+    }
+  CHECK(mismatches==0U);
+}
@@ -0,0 +1,164 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file text_kernels-unittests.cpp
+/// @brief Tests for text kernel variants and their selection.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "text_kernels.h"
+#include "text_info.h"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <stdexcept>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  text_kernel_isa const AllVariants[] = { text_kernel_isa::scalar
+                                        , text_kernel_isa::sse42
+                                        , text_kernel_isa::avx2
+                                        , text_kernel_isa::avx512
+                                        };
+
+/// @brief Random text mixing words, separators, high and control bytes.
+  std::string random_text(std::minstd_rand & rnd, std::size_t size)
+  {
+    static char const Alphabet[] = "aBcDeFgHiZ09 .,\t\n-_\xC2\xA3\xAC\xE9\x01";
+    std::uniform_int_distribution<std::size_t> pick(0U, sizeof(Alphabet)-1U);
+    std::string text(size, ' ');
+    for (auto & chr : text)
+      {
+        chr = Alphabet[pick(rnd)];  // includes the terminating '\0'
+      }
+    return text;
+  }
+}
+
+TEST_CASE("blog/sies/text_kernels/separators"
+         , "Word separators are the documented characters' UTF-8 bytes"
+         )
+{
+  std::string const separators(" \t\n\r!\"$%^&*()_-+={}[]:;@'#~?/>.<,\\|`"
+                               "\xC2\xA3\xAC");
+  for (int chr{-128}; chr!=128; ++chr)
+    {
+      CHECK( is_word_separator(static_cast<char>(chr))
+          ==(chr!=0 && separators.find(static_cast<char>(chr))!=std::string::npos)
+           );
+    }
+}
+
+TEST_CASE("blog/sies/text_kernels/variants agree"
+         , "Every supported variant gives the scalar variant's results"
+         )
+{
+  REQUIRE(text_kernel_isa_supported(text_kernel_isa::scalar));
+  auto const & scalar(text_kernels_for(text_kernel_isa::scalar));
+  std::minstd_rand rnd;
+  for (auto isa : AllVariants)
+    {
+      if (!text_kernel_isa_supported(isa))
+        {
+          CHECK_THROWS_AS(text_kernels_for(isa), std::invalid_argument);
+          continue;
+        }
+      auto const & k(text_kernels_for(isa));
+      CHECK(k.isa==isa);
+      for (std::size_t size : {0U, 1U, 15U, 16U, 17U, 63U, 64U, 65U, 200U, 3000U})
+        {
+          auto text(random_text(rnd, size+3U).substr(3U)); // unaligned data
+          for (std::size_t pos{0U}; pos<=size; ++pos)
+            {
+              CHECK( k.find_word_start(text.data(), size, pos)
+                  ==scalar.find_word_start(text.data(), size, pos)
+                   );
+              CHECK( k.find_word_end(text.data(), size, pos)
+                  ==scalar.find_word_end(text.data(), size, pos)
+                   );
+            }
+          auto lower(text);
+          auto expected_lower(text);
+          if (size!=0U)
+            {
+              k.tolower(&lower[0], size);
+              scalar.tolower(&expected_lower[0], size);
+            }
+          CHECK(lower==expected_lower);
+          std::vector<std::uint64_t> counts(NumberOfCharCounts, 1U);
+          std::vector<std::uint64_t> expected_counts(NumberOfCharCounts, 1U);
+          k.count_chars(text.data(), size, counts.data());
+          scalar.count_chars(text.data(), size, expected_counts.data());
+          CHECK(counts==expected_counts);
+        }
+    }
+}
+
+TEST_CASE("blog/sies/text_kernels/scalar results"
+         , "Scalar kernels find words, lowercase and count as expected"
+         )
+{
+  auto const & k(text_kernels_for(text_kernel_isa::scalar));
+  std::string const text("  Hello,\xC2\xA3World!");
+  CHECK(k.find_word_start(text.data(), text.size(), 0U)==2U);
+  CHECK(k.find_word_end(text.data(), text.size(), 2U)==7U);
+  CHECK(k.find_word_start(text.data(), text.size(), 7U)==10U);
+  CHECK(k.find_word_end(text.data(), text.size(), 10U)==15U);
+  CHECK(k.find_word_start(text.data(), text.size(), 15U)==text.size());
+  std::string lower(text);
+  k.tolower(&lower[0], lower.size());
+  CHECK(lower=="  hello,\xC2\xA3world!");
+  std::uint64_t counts[NumberOfCharCounts] = {};
+  k.count_chars(text.data(), text.size(), counts);
+  CHECK(counts['l']==3U);
+  CHECK(counts[0xC2]==1U);
+}
+
+TEST_CASE("blog/sies/text_kernels/named"
+         , "Kernels are found by variant name, unknown names are rejected"
+         )
+{
+  CHECK(text_kernels_named("scalar").isa==text_kernel_isa::scalar);
+  for (auto isa : { text_kernel_isa::sse42, text_kernel_isa::avx2
+                  , text_kernel_isa::avx512
+                  }
+      )
+    {
+      if (text_kernel_isa_supported(isa))
+        {
+          CHECK(text_kernels_named(to_string(isa)).isa==isa);
+        }
+      else
+        {
+          CHECK_THROWS_AS( text_kernels_named(to_string(isa))
+                         , std::invalid_argument
+                         );
+        }
+    }
+  CHECK_THROWS_AS(text_kernels_named("sse42"), std::invalid_argument);
+  CHECK_THROWS_AS(text_kernels_named(""), std::invalid_argument);
+}
+
+TEST_CASE("blog/sies/text_kernels/active"
+         , "The active kernels are a supported variant and are used by "
+           "split_next_word"
+         )
+{
+  auto const & active(active_text_kernels());
+  CHECK(text_kernel_isa_supported(active.isa));
+  CHECK(std::strlen(to_string(active.isa))>0U);
+  std::string const text("A \xC2\xA3" "5 note, \xC3\xA9t\xC3\xA9!");
+  std::string::size_type pos{0U};
+  CHECK(split_next_word(text, pos)=="A");
+  CHECK(split_next_word(text, pos)=="5");
+  CHECK(split_next_word(text, pos)=="note");
+  CHECK(split_next_word(text, pos)=="\xC3\xA9t\xC3\xA9");
+  CHECK(split_next_word(text, pos)=="");
+}
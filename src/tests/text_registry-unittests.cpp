@@ -138,3 +138,262 @@ TEST_CASE("blog/sies/text_registry::number_of_chunks/noncreator access after set
   std::thread([&tr](){CHECK(tr.word_occurrence("hello")==1U);}).join();
 }
 
+
+TEST_CASE("blog/sies/basic_text_registry/narrow counters"
+         , "A registry with 32 bit chunk counters returns 64 bit totals"
+         )
+{
+  basic_text_registry<basic_text_info<compact_counter_widths>, no_sync> tr;
+  static_assert( std::is_same< decltype(tr.char_count())
+                             , std::uint64_t
+                             >::value
+               , "Expected 64 bit totals"
+               );
+  tr.add_text_chunk("Some words, some more words.");
+  tr.add_text_chunk("More.");
+  tr.setup_complete();
+  CHECK(tr.word_count()==6U);
+  CHECK(tr.char_count()==33U);
+  CHECK(tr.word_occurrence("more")==2U);
+  CHECK(tr.chunk_word_occurrence(0U,"words")==2U);
+}
+
+TEST_CASE("blog/sies/text_registry/compact on publish"
+         , "A registry compacted on publish answers as an uncompacted one does"
+         )
+{
+  std::string const chunks[] = { "The quick brown fox."
+                               , "Jumped over the lazy dog!"
+                               , "The END"
+                               };
+  text_info_options compacting;
+  compacting.compact_on_publish = true;
+  compacting.compress_text = true;
+  text_registry<no_sync> plain;
+  text_registry<no_sync> tr{compacting};
+  for (auto const & c : chunks)
+    {
+      plain.add_text_chunk(c);
+      tr.add_text_chunk(c);
+    }
+  CHECK(tr.compacted_image()==nullptr);
+  plain.setup_complete();
+  tr.setup_complete();
+  REQUIRE(tr.compacted_image()!=nullptr);
+  CHECK_THROWS_AS(tr.text_data(), std::logic_error);
+  CHECK(tr.compacted_image()->memory_report().backing==page_backing::standard);
+  REQUIRE(tr.number_of_chunks()==plain.number_of_chunks());
+  CHECK(tr.text()==plain.text());
+  CHECK(tr.char_count()==plain.char_count());
+  CHECK(tr.word_count()==plain.word_count());
+  CHECK(tr.char_occurrence('e')==plain.char_occurrence('e'));
+  CHECK(tr.word_occurrence("the")==plain.word_occurrence("the"));
+  for (auto i=0U; i!=tr.number_of_chunks(); ++i)
+    {
+      CHECK(tr.chunk_text(i)==plain.chunk_text(i));
+      CHECK(tr.chunk_char_count(i)==plain.chunk_char_count(i));
+      CHECK(tr.chunk_word_count(i)==plain.chunk_word_count(i));
+      CHECK(tr.chunk_char_occurrence(i,'o')==plain.chunk_char_occurrence(i,'o'));
+      CHECK(tr.chunk_word_occurrence(i,"THE")==plain.chunk_word_occurrence(i,"THE"));
+    }
+  CHECK_THROWS_AS(tr.chunk_text(3U), std::out_of_range);
+}
+
+TEST_CASE("blog/sies/text_registry/chunk range counts"
+         , "Ranged counts are the same whether or not a registry is compacted"
+         )
+{
+  text_info_options compacting;
+  compacting.compact_on_publish = true;
+  text_registry<no_sync> plain;
+  text_registry<no_sync> tr{compacting};
+  for (auto c : {"a b c", "dd ee", "", "f"})
+    {
+      plain.add_text_chunk(c);
+      tr.add_text_chunk(c);
+    }
+  plain.setup_complete();
+  tr.setup_complete();
+  for (auto first=0U; first<=4U; ++first)
+    {
+      for (auto count=0U; count<=4U-first; ++count)
+        {
+          CHECK(tr.char_count(first,count)==plain.char_count(first,count));
+          CHECK(tr.word_count(first,count)==plain.word_count(first,count));
+        }
+    }
+  CHECK(tr.char_count(1U,3U)==6U);
+  CHECK(tr.word_count(0U,2U)==5U);
+  CHECK_THROWS_AS(tr.char_count(1U,4U), std::out_of_range);
+  CHECK_THROWS_AS(plain.word_count(5U,0U), std::out_of_range);
+}
+
+TEST_CASE("blog/sies/text_registry/stats"
+         , "A stats query gives the results of the separate queries"
+         )
+{
+  text_stats_query query;
+  query.chars = {'e', 'o', '!', 'z'};
+  query.words = {"the", "DOG", "cat"};
+  query.include_text = true;
+  text_info_options columns;
+  columns.char_count_columns = true;
+  text_info_options compressed;
+  compressed.compress_text = true;
+  text_info_options compacting;
+  compacting.compact_on_publish = true;
+  for (auto const & opts : {text_info_options{}, columns, compressed, compacting})
+    {
+      text_registry<no_sync> tr{opts};
+      for (auto c : {"The quick brown fox.", "Jumped over the lazy dog!", "", "The END"})
+        {
+          tr.add_text_chunk(c);
+        }
+      for (bool published : {false, true})
+        {
+          if (published)
+            {
+              tr.setup_complete();
+            }
+          auto stats(tr.stats(query));
+          CHECK(stats.number_of_chunks==tr.number_of_chunks());
+          CHECK(stats.char_count==tr.char_count());
+          CHECK(stats.word_count==tr.word_count());
+          REQUIRE(stats.char_occurrences.size()==query.chars.size());
+          for (std::size_t i{0U}; i!=query.chars.size(); ++i)
+            {
+              CHECK(stats.char_occurrences[i]==tr.char_occurrence(query.chars[i]));
+            }
+          REQUIRE(stats.word_occurrences.size()==query.words.size());
+          for (std::size_t i{0U}; i!=query.words.size(); ++i)
+            {
+              CHECK(stats.word_occurrences[i]==tr.word_occurrence(query.words[i]));
+            }
+          CHECK(stats.text==tr.text());
+          CHECK(tr.stats(text_stats_query{}).text.empty());
+        }
+      CHECK(tr.stats(query).word_occurrences[0]==3U);
+      std::thread([&tr,&query](){CHECK(tr.stats(query).char_count==52U);}).join();
+    }
+  text_registry<no_sync> tr;
+  tr.add_text_chunk("Hello");
+  std::thread([&tr](){CHECK_THROWS_AS(tr.stats(text_stats_query{}), call_context_violation);}).join();
+}
+
+TEST_CASE("blog/sies/text_registry/digest"
+         , "Registry digests and fingerprints match those of its text_info"
+         )
+{
+  text_info reference;
+  text_info_options compacting;
+  compacting.compact_on_publish = true;
+  text_registry<no_sync> plain;
+  text_registry<no_sync> tr{compacting};
+  for (auto c : {"a b c", "dd ee", "", "f"})
+    {
+      reference.add_text_chunk(c);
+      plain.add_text_chunk(c);
+      tr.add_text_chunk(c);
+    }
+  CHECK(tr.digest()==reference.digest());
+  plain.setup_complete();
+  tr.setup_complete();
+  CHECK(plain.digest()==reference.digest());
+  CHECK(tr.digest()==reference.digest());
+  CHECK(differing_chunks(tr, reference).empty());
+  CHECK(differing_chunks(plain, tr).empty());
+  CHECK(tr.chunk_fingerprint(1U)==reference.chunk_fingerprint(1U));
+  CHECK_THROWS_AS(tr.chunk_fingerprint(4U), std::out_of_range);
+  reference.add_text_chunk("g");
+  CHECK(differing_chunks(tr, reference)==std::vector<std::uint64_t>{4U});
+  std::thread([&tr](){CHECK(tr.digest()!=EmptyDigest);}).join();
+}
+
+TEST_CASE("blog/sies/text_registry/staged producers"
+         , "Chunks staged by producer threads are added in sequence order"
+         )
+{
+  text_info reference;
+  for (unsigned i{0U}; i!=40U; ++i)
+    {
+      reference.add_text_chunk("chunk " + std::to_string(i));
+    }
+  text_registry<no_sync> tr;
+  tr.add_text_chunk("first");
+  std::vector<std::thread> producers;
+  for (unsigned p{0U}; p!=4U; ++p)
+    {
+      producers.emplace_back
+        ( [p](text_registry<no_sync>::staging_handle h)
+          {
+            for (unsigned i{p}; i<40U; i+=4U)
+              {
+                h.add_text_chunk(i, "chunk " + std::to_string(i));
+              }
+          }
+        , tr.open_staging()
+        );
+    }
+  for (auto & p : producers)
+    {
+      p.join();
+    }
+  tr.setup_complete();
+  REQUIRE(tr.number_of_chunks()==41U);
+  CHECK(tr.chunk_text(0U)=="first");
+  for (unsigned i{0U}; i!=40U; ++i)
+    {
+      CHECK(tr.chunk_fingerprint(i+1U)==reference.chunk_fingerprint(i));
+    }
+  CHECK(tr.word_count()==81U);
+}
+
+TEST_CASE("blog/sies/text_registry/staging exclusive setup"
+         , "Staging handles are opened and merged by the creator thread only"
+         )
+{
+  text_registry<no_sync> tr;
+  std::thread([&tr]()
+              {
+                CHECK_THROWS_AS(tr.open_staging(), call_context_violation);
+              }
+             ).join();
+  auto h(tr.open_staging());
+  h.add_text_chunk(0U, "a");
+  CHECK_THROWS_AS(tr.setup_complete(), std::logic_error);
+  h.submit();
+  tr.setup_complete();
+  CHECK(tr.number_of_chunks()==1U);
+  CHECK_THROWS_AS(tr.open_staging(), call_context_violation);
+}
+
+TEST_CASE("blog/sies/text_registry/append"
+         , "text_info objects built on other threads may be appended in setup"
+         )
+{
+  std::vector<text_info> parts(3U);
+  std::vector<std::thread> builders;
+  for (unsigned p{0U}; p!=parts.size(); ++p)
+    {
+      builders.emplace_back( [p, &parts]()
+                             {
+                               parts[p].add_text_chunk("part " + std::to_string(p));
+                               parts[p].add_text_chunk("more words");
+                             }
+                           );
+    }
+  for (auto & b : builders)
+    {
+      b.join();
+    }
+  text_registry<no_sync> tr;
+  tr.append(parts[0U]);
+  tr.append(std::move(parts[1U]));
+  tr.append(parts[2U]);
+  CHECK(parts[1U].number_of_chunks()==0U);
+  tr.setup_complete();
+  CHECK(tr.number_of_chunks()==6U);
+  CHECK(tr.word_count()==12U);
+  CHECK(tr.chunk_text(4U)=="part 2");
+  CHECK_THROWS_AS(tr.append(parts[0U]), call_context_violation);
+}
@@ -0,0 +1,148 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file tokenizers-unittests.cpp
+/// @brief Tests for tokenizer policies and their use by text_info.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "tokenizers.h"
+#include "text_info.h"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+
+using namespace dibase::blog::sies;
+
+namespace
+{
+  static_assert( char_class::table<ascii_alnum_word_chars>::is_word_char['a']
+              && char_class::table<ascii_alnum_word_chars>::is_word_char['Z']
+              && char_class::table<ascii_alnum_word_chars>::is_word_char['7']
+              && !char_class::table<ascii_alnum_word_chars>::is_word_char['\'']
+              && !char_class::table<ascii_alnum_word_chars>::is_word_char[0xE9]
+               , "ASCII alnum table generated at compile time"
+               );
+
+  static_assert( char_class::table<alnum_apostrophe_word_chars>::is_word_char['\'']
+              && !char_class::table<alnum_apostrophe_word_chars>::is_word_char['-']
+               , "Alnum plus apostrophe table generated at compile time"
+               );
+
+  static_assert( !char_class::table<separator_word_chars>::is_word_char[' ']
+              && !char_class::table<separator_word_chars>::is_word_char[0xA3]
+              && char_class::table<separator_word_chars>::is_word_char[0xE9]
+              && char_class::table<separator_word_chars>::is_word_char['x']
+               , "Separator table generated at compile time"
+               );
+
+  template <class Tokenizer>
+  std::vector<std::string> words(std::string const & text)
+  {
+    std::vector<std::string> result;
+    for (std::size_t pos{0U};;)
+      {
+        auto start(Tokenizer::find_word_start(text.data(), text.size(), pos));
+        if (start==text.size())
+          {
+            break;
+          }
+        pos = Tokenizer::find_word_end(text.data(), text.size(), start);
+        result.push_back(text.substr(start, pos-start));
+      }
+    return result;
+  }
+}
+
+TEST_CASE("blog/sies/tokenizers/ascii alnum"
+         , "ASCII alnum tokenizer splits at every other character"
+         )
+{
+  auto w(words<ascii_alnum_tokenizer>("Don't stop-me now\xE9x"));
+  REQUIRE(w.size()==6U);
+  CHECK(w[0]=="Don");
+  CHECK(w[1]=="t");
+  CHECK(w[2]=="stop");
+  CHECK(w[3]=="me");
+  CHECK(w[4]=="now");
+  CHECK(w[5]=="x");
+}
+
+TEST_CASE("blog/sies/tokenizers/alnum apostrophe"
+         , "Alnum plus apostrophe tokenizer keeps contractions whole"
+         )
+{
+  auto w(words<alnum_apostrophe_tokenizer>("Don't stop-me"));
+  REQUIRE(w.size()==3U);
+  CHECK(w[0]=="Don't");
+  CHECK(w[1]=="stop");
+  CHECK(w[2]=="me");
+}
+
+TEST_CASE("blog/sies/tokenizers/custom"
+         , "Custom word character sets are usable as tokenizers"
+         )
+{
+  typedef basic_tokenizer<ascii_alnum_plus_word_chars<'-','_'>> tokenizer;
+  CHECK(tokenizer::is_word_char('-'));
+  CHECK(tokenizer::is_word_char('_'));
+  CHECK_FALSE(tokenizer::is_word_char('\''));
+  auto w(words<tokenizer>("  well-known snake_case, "));
+  REQUIRE(w.size()==2U);
+  CHECK(w[0]=="well-known");
+  CHECK(w[1]=="snake_case");
+  CHECK(words<tokenizer>("").empty());
+  CHECK(words<tokenizer>(" ,. ").empty());
+}
+
+TEST_CASE("blog/sies/tokenizers/separator"
+         , "Default tokenizer splits words as split_next_word does"
+         )
+{
+  std::string const text{"  The cat's \xC2\xA3" "5 hat-stand\xE9 is_here\n"};
+  std::vector<std::string> expected;
+  std::string::size_type pos{0U};
+  for (auto word(split_next_word(text, pos)); !word.empty()
+      ; word = split_next_word(text, pos))
+    {
+      expected.push_back(word);
+    }
+  CHECK(words<separator_tokenizer>(text)==expected);
+  for (int chr{-128}; chr!=128; ++chr)
+    {
+      CHECK( separator_tokenizer::is_word_char(static_cast<char>(chr))
+          !=is_word_separator(static_cast<char>(chr))
+           );
+    }
+}
+
+TEST_CASE("blog/sies/tokenizers/text_info policy"
+         , "text_info counts words as split by its tokenizer policy"
+         )
+{
+  typedef basic_text_info< default_counter_widths, std::allocator<char>
+                         , map_occurrence_tables, alnum_apostrophe_tokenizer
+                         > apostrophe_text_info;
+  static_assert( std::is_same< apostrophe_text_info::tokenizer_type
+                             , alnum_apostrophe_tokenizer
+                             >::value
+               , "tokenizer_type names the policy"
+               );
+  std::string const chunk{"Don't DON'T don't do_it"};
+  apostrophe_text_info ati;
+  ati.add_text_chunk(chunk);
+  CHECK(ati.word_count()==5U);
+  CHECK(ati.word_occurrence("don't")==3U);
+  CHECK(ati.word_occurrence("do")==1U);
+  CHECK(ati.word_occurrence("it")==1U);
+
+  text_info ti;
+  ti.add_text_chunk(chunk);
+  CHECK(ti.word_count()==8U);
+  CHECK(ti.word_occurrence("don")==3U);
+  CHECK(ti.word_occurrence("t")==3U);
+  CHECK(ti.word_occurrence("don't")==0U);
+}
@@ -0,0 +1,207 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file worker_pool-unittests.cpp
+/// @brief Tests for the worker thread pool.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "worker_pool.h"
+#include "catch.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace dibase::blog::sies;
+
+TEST_CASE("blog/sies/worker_pool/parallel_for"
+         , "parallel_for calls the function once for each index"
+         )
+{
+  for (std::size_t workers : {0U, 1U, 3U})
+    {
+      worker_pool pool{workers};
+      CHECK(pool.size()==workers);
+      CHECK(pool.concurrency()==workers+1U);
+      for (std::size_t count : {0U, 1U, 2U, 7U, 1000U})
+        {
+          std::vector<std::atomic<unsigned>> calls(count);
+          for (auto & c : calls)
+            {
+              c = 0U;
+            }
+          pool.parallel_for(count, [&calls](std::size_t i) { ++calls[i]; });
+          for (auto & c : calls)
+            {
+              CHECK(c==1U);
+            }
+        }
+    }
+}
+
+TEST_CASE("blog/sies/worker_pool/exceptions"
+         , "An exception thrown by a parallel_for function is rethrown"
+         )
+{
+  worker_pool pool{3U};
+  std::atomic<unsigned> calls{0U};
+  CHECK_THROWS_AS
+    ( pool.parallel_for( 100U
+                       , [&calls](std::size_t i)
+                         {
+                           ++calls;
+                           if (i%10U==3U)
+                             {
+                               throw std::runtime_error{"failed"};
+                             }
+                         }
+                       )
+    , std::runtime_error
+    );
+  CHECK(calls==100U);
+  calls = 0U;
+  pool.parallel_for(10U, [&calls](std::size_t) { ++calls; });
+  CHECK(calls==10U);
+}
+
+TEST_CASE("blog/sies/worker_pool/nested"
+         , "A parallel_for called from a parallel_for function runs serially"
+         )
+{
+  worker_pool pool{2U};
+  std::atomic<unsigned> calls{0U};
+  pool.parallel_for( 4U
+                   , [&pool, &calls](std::size_t)
+                     {
+                       pool.parallel_for(5U, [&calls](std::size_t) { ++calls; });
+                     }
+                   );
+  CHECK(calls==20U);
+  CHECK(&worker_pool::shared()==&worker_pool::shared());
+}
+
+TEST_CASE("blog/sies/worker_pool/busy"
+         , "A parallel_for called while the pool runs another thread's call"
+           " runs on the calling thread without waiting"
+         )
+{
+  worker_pool pool{1U};
+  std::atomic<unsigned> started{0U};
+  std::atomic<bool> release{false};
+  auto busy(std::async( std::launch::async
+                      , [&]()
+                        {
+                          pool.parallel_for( 2U
+                                           , [&](std::size_t)
+                                             {
+                                               ++started;
+                                               while (!release)
+                                                 {
+                                                   std::this_thread::yield();
+                                                 }
+                                             }
+                                           );
+                        }
+                      ));
+  while (started==0U)
+    {
+      std::this_thread::yield();
+    }
+  auto other(std::async( std::launch::async
+                       , [&pool]()
+                         {
+                           std::atomic<unsigned> elsewhere{0U};
+                           auto caller(std::this_thread::get_id());
+                           pool.parallel_for
+                             ( 10U
+                             , [&elsewhere, caller](std::size_t)
+                               {
+                                 if (std::this_thread::get_id()!=caller)
+                                   {
+                                     ++elsewhere;
+                                   }
+                               }
+                             );
+                           return elsewhere.load();
+                         }
+                       ));
+  bool const other_done{ other.wait_for(std::chrono::seconds(10))
+                      ==std::future_status::ready
+                       };
+  release = true;
+  busy.get();
+  CHECK(other_done);
+  CHECK(other.get()==0U);
+}
+
+TEST_CASE("blog/sies/worker_pool/parallel_reduce"
+         , "parallel_reduce combines results of sub-ranges covering the range"
+         )
+{
+  for (std::size_t workers : {0U, 1U, 3U})
+    {
+      worker_pool pool{workers};
+      for (std::size_t count : {0U, 1U, 2U, 7U, 1000U})
+        {
+          std::vector<std::atomic<unsigned>> visits(count);
+          for (auto & v : visits)
+            {
+              v = 0U;
+            }
+          auto sum(pool.parallel_reduce
+                    ( count, std::uint64_t{5U}
+                    , [&visits](std::size_t first, std::size_t n)
+                      {
+                        std::uint64_t partial{0U};
+                        for (auto i(first); i!=first+n; ++i)
+                          {
+                            ++visits[i];
+                            partial += i;
+                          }
+                        return partial;
+                      }
+                    , [](std::uint64_t lhs, std::uint64_t rhs) {return lhs+rhs;}
+                    ));
+          CHECK(sum==5U+count*(count-(count!=0U ? 1U : 0U))/2U);
+          for (auto & v : visits)
+            {
+              CHECK(v==1U);
+            }
+        }
+      auto order(pool.parallel_reduce
+                  ( 10U, std::string{}
+                  , [](std::size_t first, std::size_t n)
+                    {
+                      std::string digits;
+                      for (auto i(first); i!=first+n; ++i)
+                        {
+                          digits += char('0'+i);
+                        }
+                      return digits;
+                    }
+                  , [](std::string const & lhs, std::string const & rhs)
+                    {
+                      return lhs+rhs;
+                    }
+                  ));
+      CHECK(order=="0123456789");
+      CHECK_THROWS_AS(pool.parallel_reduce
+                        ( 10U, 0
+                        , [](std::size_t, std::size_t) -> int
+                          {
+                            throw std::runtime_error{"range_fn"};
+                          }
+                        , [](int lhs, int rhs) {return lhs+rhs;}
+                        )
+                     , std::runtime_error
+                     );
+    }
+}
@@ -0,0 +1,316 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file text_image.cpp
+/// @brief Flat, position independent, read-only image of text_info data.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "text_image.h"
+#include "gather_write.h"
+#include <atomic>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace
+    {
+    /// @brief Compare pooled word text with a key, as unsigned chars.
+      int compare_word
+      ( char const * base
+      , image::word const & w
+      , std::string const & key
+      )
+      {
+        auto common(std::min<std::uint64_t>(w.size, key.size()));
+        auto result(std::memcmp(base+w.text_offset, key.data(), common));
+        if (result!=0)
+          {
+            return result;
+          }
+        return w.size<key.size() ? -1 : (w.size==key.size() ? 0 : 1);
+      }
+
+    /// @brief Binary search sorted word table for key.
+      std::uint64_t lookup_word
+      ( char const * base
+      , std::uint64_t words_offset
+      , std::uint64_t number_of_words
+      , std::string const & key
+      )
+      {
+        auto first(reinterpret_cast<image::word const *>(base+words_offset));
+        auto last(first+number_of_words);
+        auto pos(std::lower_bound( first, last, key
+                                 , [base](image::word const & w
+                                         , std::string const & k)
+                                   {
+                                     return compare_word(base, w, k)<0;
+                                   }
+                                 ));
+        return (pos!=last && compare_word(base,*pos,key)==0) ? pos->count : 0U;
+      }
+
+    /// @brief Returns true if count items of item_size bytes at offset lie
+    /// within an image of image_size bytes, without overflowing.
+      bool within
+      ( std::uint64_t offset
+      , std::uint64_t count
+      , std::uint64_t item_size
+      , std::uint64_t image_size
+      )
+      {
+        return  offset<=image_size
+            &&  count<=(image_size-offset)/item_size;
+      }
+
+    /// @brief As within, also requiring offset to be 8 byte aligned.
+      bool within_aligned
+      ( std::uint64_t offset
+      , std::uint64_t count
+      , std::uint64_t item_size
+      , std::uint64_t image_size
+      )
+      {
+        return offset%8U==0U && within(offset, count, item_size, image_size);
+      }
+
+    /// @brief Throws bad_text_image if any of a word table's entries refer
+    /// to text outside the image.
+      void validate_words
+      ( char const * base
+      , std::uint64_t words_offset
+      , std::uint64_t number_of_words
+      , std::uint64_t image_size
+      )
+      {
+        if (!within_aligned(words_offset, number_of_words, sizeof(image::word), image_size))
+          {
+            throw bad_text_image{"Text image word table out of bounds."};
+          }
+        auto first(reinterpret_cast<image::word const *>(base+words_offset));
+        for (auto w=first; w!=first+number_of_words; ++w)
+          {
+            if (!within(w->text_offset, w->size, 1U, image_size))
+              {
+                throw bad_text_image{"Text image word text out of bounds."};
+              }
+          }
+      }
+    } // namespace
+
+    text_image_view::text_image_view
+    ( void const * image
+    , std::uint64_t image_size
+    )
+    : base{static_cast<char const *>(image)}
+    , hdr{static_cast<image::header const *>(image)}
+    {
+      if ( image_size<sizeof(image::header)
+        || std::memcmp(hdr->magic, image::Magic, sizeof(image::Magic))!=0
+         )
+        {
+          throw bad_text_image{"Not a text image."};
+        }
+      if ( hdr->version!=image::Version
+        || hdr->header_size!=sizeof(image::header)
+         )
+        {
+          throw bad_text_image{"Unsupported text image version."};
+        }
+      if (hdr->image_size>image_size)
+        {
+          throw bad_text_image{"Text image truncated."};
+        }
+      std::atomic_thread_fence(std::memory_order_acquire); // Magic written last
+      validate_sections();
+    }
+
+    void text_image_view::validate_sections() const
+    {
+      auto const size(hdr->image_size);
+      if ( !within_aligned(hdr->char_totals_offset, 256U, sizeof(std::uint64_t), size)
+        || !within_aligned( hdr->chunks_offset, hdr->number_of_chunks
+                          , sizeof(image::chunk), size
+                          )
+         )
+        {
+          throw bad_text_image{"Text image section out of bounds."};
+        }
+      validate_words(base, hdr->words_offset, hdr->number_of_words, size);
+      auto recs(reinterpret_cast<image::chunk const *>(base+hdr->chunks_offset));
+      std::uint64_t char_count{0U};
+      for (auto rec=recs; rec!=recs+hdr->number_of_chunks; ++rec)
+        {
+        // Chunk text is contiguous: text and write_chunks_text rely on it.
+          if ( !within(rec->text_offset, rec->char_count, 1U, size)
+            || (rec!=recs && rec->text_offset!=(rec-1)->text_offset+(rec-1)->char_count)
+            || rec->number_of_chars>256U
+            || !within_aligned( rec->chars_offset
+                              , image::align8(rec->number_of_chars)/8U
+                                  + rec->number_of_chars
+                              , sizeof(std::uint64_t), size
+                              )
+             )
+            {
+              throw bad_text_image{"Text image chunk out of bounds."};
+            }
+          validate_words(base, rec->words_offset, rec->number_of_words, size);
+          char_count += rec->char_count;
+        }
+      if (char_count!=hdr->char_count)
+        {
+          throw bad_text_image{"Text image character count inconsistent."};
+        }
+    }
+
+    image::chunk const & text_image_view::chunk_at
+    ( std::uint64_t chunk_index
+    ) const
+    {
+      if (chunk_index>=hdr->number_of_chunks)
+        {
+          throw std::out_of_range{"Text image chunk index out of range."};
+        }
+      return reinterpret_cast<image::chunk const *>
+                                  (base+hdr->chunks_offset)[chunk_index];
+    }
+
+    image::chunk const * text_image_view::chunk_range
+    ( std::uint64_t first
+    , std::uint64_t count
+    ) const
+    {
+      if (first>hdr->number_of_chunks || count>hdr->number_of_chunks-first)
+        {
+          throw std::out_of_range{"Text image chunk range out of range."};
+        }
+      return reinterpret_cast<image::chunk const *>(base+hdr->chunks_offset)
+                                                                    + first;
+    }
+
+    std::string text_image_view::chunk_text
+    ( chunk_index_type chunk_index
+    ) const
+    {
+      auto const & rec(chunk_at(chunk_index));
+      return std::string(base+rec.text_offset, rec.char_count);
+    }
+
+    text_image_view::chunk_size_type text_image_view::chunk_char_count
+    ( chunk_index_type chunk_index
+    ) const
+    {
+      return chunk_at(chunk_index).char_count;
+    }
+
+    text_image_view::chunk_size_type text_image_view::chunk_word_count
+    ( chunk_index_type chunk_index
+    ) const
+    {
+      return chunk_at(chunk_index).word_count;
+    }
+
+    text_image_view::chunk_size_type text_image_view::chunk_char_occurrence
+    ( chunk_index_type chunk_index
+    , char chr
+    ) const
+    {
+      auto const & rec(chunk_at(chunk_index));
+      auto first(reinterpret_cast<unsigned char const *>(base+rec.chars_offset));
+      auto last(first+rec.number_of_chars);
+      auto pos(std::lower_bound(first, last, static_cast<unsigned char>(chr)));
+      if (pos==last || *pos!=static_cast<unsigned char>(chr))
+        {
+          return 0U;
+        }
+      auto counts(reinterpret_cast<std::uint64_t const *>
+                          (base+rec.chars_offset+image::align8(rec.number_of_chars)));
+      return counts[pos-first];
+    }
+
+    text_image_view::chunk_size_type text_image_view::chunk_word_occurrence
+    ( chunk_index_type chunk_index
+    , std::string const & word
+    ) const
+    {
+      auto const & rec(chunk_at(chunk_index));
+      return lookup_word(base, rec.words_offset, rec.number_of_words, tolower(word));
+    }
+
+    std::string text_image_view::text() const
+    {
+      if (hdr->number_of_chunks==0U)
+        {
+          return std::string{};
+        }
+      return std::string(base+chunk_at(0U).text_offset, hdr->char_count);
+    }
+
+    std::uint64_t text_image_view::write_chunks_text
+    ( int fd
+    , chunk_index_type first
+    , chunk_count_type count
+    ) const
+    {
+      chunk_range(first, count);
+      if (count==0U)
+        {
+          return 0U;
+        }
+      auto const & first_rec(chunk_at(first));
+      auto const & last_rec(chunk_at(first+count-1U));
+      iovec iov;
+      iov.iov_base = const_cast<char *>(base+first_rec.text_offset);
+      iov.iov_len = last_rec.text_offset + last_rec.char_count
+                  - first_rec.text_offset;
+      return gather_write(fd, &iov, 1U);
+    }
+
+    text_image_view::chunk_size_type text_image_view::char_count
+    ( chunk_index_type first
+    , chunk_count_type count
+    ) const
+    {
+      auto recs(chunk_range(first, count));
+      std::uint64_t total{0U};
+      for (auto rec=recs; rec!=recs+count; ++rec)
+        {
+          total += rec->char_count;
+        }
+      return total;
+    }
+
+    text_image_view::chunk_size_type text_image_view::word_count
+    ( chunk_index_type first
+    , chunk_count_type count
+    ) const
+    {
+      auto recs(chunk_range(first, count));
+      std::uint64_t total{0U};
+      for (auto rec=recs; rec!=recs+count; ++rec)
+        {
+          total += rec->word_count;
+        }
+      return total;
+    }
+
+    text_image_view::chunk_size_type text_image_view::char_occurrence
+    ( char chr
+    ) const
+    {
+      return reinterpret_cast<std::uint64_t const *>(base+hdr->char_totals_offset)
+                                          [static_cast<unsigned char>(chr)];
+    }
+
+    text_image_view::chunk_size_type text_image_view::word_occurrence
+    ( std::string const & word
+    ) const
+    {
+      return lookup_word(base, hdr->words_offset, hdr->number_of_words, tolower(word));
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
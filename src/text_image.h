@@ -0,0 +1,453 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file text_image.h
+/// @brief Flat, position independent, read-only image of text_info data.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Once setup is complete the data in a text_info never changes, so it may be
+/// written out as a single contiguous image that contains no pointers - only
+/// offsets from the start of the image. Such an image can be placed anywhere
+/// in memory - in a heap buffer, a shared memory segment mapped by several
+/// processes or a memory mapped file - and queried in place through a
+/// text_image_view.
+///
+/// Image layout (all offsets from image start, all sections cache line (64
+/// byte) aligned, ordered as used by queries: fixed size tables needed by
+/// every corpus wide query first, then per-chunk data, then text):
+///   - header
+///   - corpus character totals: 256 std::uint64_t indexed by unsigned char
+///   - chunk records: one image_chunk per chunk
+///   - corpus word index: image_word entries sorted by word
+///   - per-chunk character tables: distinct characters (sorted) followed by
+///     their std::uint64_t counts
+///   - per-chunk word tables: image_word entries sorted by word
+///   - text: all chunks' text concatenated
+///   - word pool: each distinct word's text stored once
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_TEXT_IMAGE_H
+# define DIBASE_BLOG_SIES_TEXT_IMAGE_H
+# include "text_info.h"
+# include <cstdint>
+# include <stdexcept>
+# include <string>
+# include <map>
+# include <vector>
+# include <algorithm>
+# include <cstring>
+# include <atomic>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Specific exception type for malformed or incompatible images
+    class bad_text_image : public std::runtime_error
+    {
+    public:
+    /// @brief Construct from C-string message
+      explicit bad_text_image(char const * what_arg)
+      : std::runtime_error(what_arg)
+      {}
+    };
+
+    namespace image
+    {
+    /// @brief Image header, located at offset 0.
+      struct header
+      {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint64_t image_size;
+        std::uint64_t number_of_chunks;
+        std::uint64_t char_count;
+        std::uint64_t word_count;
+        std::uint64_t char_totals_offset;
+        std::uint64_t chunks_offset;
+        std::uint64_t words_offset;
+        std::uint64_t number_of_words;
+      };
+
+    /// @brief Per-chunk record.
+      struct chunk
+      {
+        std::uint64_t text_offset;
+        std::uint64_t char_count;
+        std::uint64_t word_count;
+        std::uint64_t chars_offset;
+        std::uint64_t number_of_chars;
+        std::uint64_t words_offset;
+        std::uint64_t number_of_words;
+      };
+
+    /// @brief Word table entry: reference into word pool and a count.
+      struct word
+      {
+        std::uint64_t text_offset;
+        std::uint64_t size;
+        std::uint64_t count;
+      };
+
+      char const          Magic[8] = {'S','I','E','S','I','M','G','\0'};
+      std::uint32_t const Version{2U};
+
+    /// @brief Alignment of image sections and of image start.
+      std::uint64_t const SectionAlignment{64U};
+
+      inline std::uint64_t align8(std::uint64_t n)
+      {
+        return (n+7U) & ~std::uint64_t{7U};
+      }
+
+      inline std::uint64_t align_section(std::uint64_t n)
+      {
+        return (n+SectionAlignment-1U) & ~(SectionAlignment-1U);
+      }
+
+    /// @brief Size of a chunk's character table: sorted characters padded to
+    /// 8 bytes followed by their counts.
+      inline std::uint64_t char_table_size(std::uint64_t number_of_chars)
+      {
+        return align8(number_of_chars) + number_of_chars*sizeof(std::uint64_t);
+      }
+
+    /// @brief Section offsets derived from builder sizes.
+      struct layout
+      {
+        std::uint64_t char_totals;
+        std::uint64_t chunks;
+        std::uint64_t words;
+        std::uint64_t chunk_tables;
+        std::uint64_t text;
+        std::uint64_t word_pool;
+        std::uint64_t end;
+
+        layout( std::uint64_t number_of_chunks, std::uint64_t number_of_words
+              , std::uint64_t chunk_tables_size, std::uint64_t text_size
+              , std::uint64_t word_pool_size
+              )
+        : char_totals{align_section(sizeof(header))}
+        , chunks{align_section(char_totals + 256U*sizeof(std::uint64_t))}
+        , words{align_section(chunks + number_of_chunks*sizeof(chunk))}
+        , chunk_tables{align_section(words + number_of_words*sizeof(word))}
+        , text{align_section(chunk_tables + chunk_tables_size)}
+        , word_pool{align_section(text + text_size)}
+        , end{align_section(word_pool + word_pool_size)}
+        {}
+      };
+    } // namespace image
+
+  /// @brief Calculates layout of, and writes, the image of a text_info.
+  ///
+  /// Construction performs the layout pass (including interning the text of
+  /// all distinct words) so the required size is known before the memory to
+  /// hold the image is obtained. The text_info must not be modified between
+  /// construction and calls to write.
+  ///
+  /// @param TextInfo   basic_text_info specialisation images are made of.
+    template <class TextInfo>
+    class basic_text_image_builder
+    {
+      TextInfo const &                      source;
+      std::map<std::string, std::uint64_t>  word_pool; ///< word -> pool offset
+      std::map<std::string, std::uint64_t>  word_totals;
+      std::uint64_t                         chunk_tables_size;
+      std::uint64_t                         text_size;
+      std::uint64_t                         word_pool_size;
+
+      image::layout make_layout() const
+      {
+        return image::layout{ source.number_of_chunks(), word_totals.size()
+                            , chunk_tables_size, text_size, word_pool_size
+                            };
+      }
+
+    public:
+    /// @brief Construct from text_info object to make image of.
+    /// @param ti   Fully setup text_info object.
+      explicit basic_text_image_builder(TextInfo const & ti);
+
+      basic_text_image_builder(basic_text_image_builder const &) = delete;
+      basic_text_image_builder & operator=(basic_text_image_builder const &) = delete;
+      basic_text_image_builder(basic_text_image_builder &&) = delete;
+      basic_text_image_builder & operator=(basic_text_image_builder &&) = delete;
+
+    /// @brief Returns size in bytes of image.
+      std::uint64_t size() const { return make_layout().end; }
+
+    /// @brief Write image to memory at dest.
+    /// The header's magic is written last, after a release fence, so a
+    /// reader concurrently mapping the memory does not accept a partially
+    /// written image.
+    /// @param dest   Cache line (image::SectionAlignment) aligned memory of at
+    ///               least size() bytes. 8 byte aligned memory is sufficient
+    ///               for a valid image.
+      void write(void * dest) const;
+
+    /// @brief Returns image in newly allocated buffer.
+      std::vector<std::uint64_t> make() const
+      {
+        std::vector<std::uint64_t> buffer(size()/sizeof(std::uint64_t));
+        write(buffer.data());
+        return buffer;
+      }
+    };
+
+  /// @brief Builder of images of text_info objects.
+    typedef basic_text_image_builder<text_info>   text_image_builder;
+
+  /// @brief Read-only query access to an image located anywhere in memory.
+  ///
+  /// Provides the same immutable operations as text_info. A view does not
+  /// own the image memory, which must remain mapped and unchanged for the
+  /// lifetime of the view. As an image is never modified, views may be used
+  /// concurrently from any number of threads.
+    class text_image_view
+    {
+      char const *          base;
+      image::header const * hdr;
+
+      void validate_sections() const;
+      image::chunk const & chunk_at(std::uint64_t chunk_index) const;
+      image::chunk const * chunk_range
+                          (std::uint64_t first, std::uint64_t count) const;
+
+    public:
+      typedef text_info::chunk_size_type  chunk_size_type;
+      typedef text_info::chunk_count_type chunk_count_type;
+      typedef text_info::chunk_index_type chunk_index_type;
+
+    /// @brief Construct view of, and validate, image.
+    /// Every section, chunk record and word table entry is checked to lie
+    /// within the image, so queries never read outside it.
+    /// @param image        8 byte aligned start of image.
+    /// @param image_size   Size of memory available at image.
+    /// @throws dibase::blog::sies::bad_text_image if the image header is not
+    ///         valid, the image is larger than image_size or any offset or
+    ///         extent in the image lies outside it.
+      text_image_view(void const * image, std::uint64_t image_size);
+
+    /// @brief Returns size in bytes of image.
+      std::uint64_t size() const { return hdr->image_size; }
+
+    /// @brief Returns start of image.
+      void const * data() const { return base; }
+
+    /// @brief Returns number of text chunks in image.
+      chunk_count_type number_of_chunks() const { return hdr->number_of_chunks; }
+
+    /// @brief Returns copy of a chunk's text.
+    /// @throws std::out_of_range if chunk_index >= number_of_chunks().
+      std::string chunk_text(chunk_index_type chunk_index) const;
+
+    /// @brief Returns number of characters in a chunk.
+    /// @throws std::out_of_range if chunk_index >= number_of_chunks().
+      chunk_size_type chunk_char_count(chunk_index_type chunk_index) const;
+
+    /// @brief Returns number of words in a chunk.
+    /// @throws std::out_of_range if chunk_index >= number_of_chunks().
+      chunk_size_type chunk_word_count(chunk_index_type chunk_index) const;
+
+    /// @brief Returns occurrence of a character in a chunk.
+    /// @throws std::out_of_range if chunk_index >= number_of_chunks().
+      chunk_size_type chunk_char_occurrence
+      ( chunk_index_type chunk_index
+      , char chr
+      ) const;
+
+    /// @brief Returns occurrence of a word in a chunk.
+    /// @throws std::out_of_range if chunk_index >= number_of_chunks().
+      chunk_size_type chunk_word_occurrence
+      ( chunk_index_type chunk_index
+      , std::string const & word
+      ) const;
+
+    /// @brief Returns concatenation of all chunks' text.
+      std::string text() const;
+
+    /// @brief Writes text of a range of chunks to a file.
+    /// Chunk text is contiguous in an image so is written straight from the
+    /// image memory.
+    /// @param fd           File descriptor, in blocking mode, to write to.
+    /// @param first        Index of first chunk to write.
+    /// @param count        Number of chunks to write.
+    /// @returns Number of bytes written.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+    /// @throws std::system_error if writing fails.
+      std::uint64_t write_chunks_text
+      ( int fd
+      , chunk_index_type first
+      , chunk_count_type count
+      ) const;
+
+    /// @brief Writes text of all chunks to a file.
+      std::uint64_t write_text(int fd) const
+      {
+        return write_chunks_text(fd, 0U, number_of_chunks());
+      }
+
+    /// @brief Returns number of characters in all chunks.
+      chunk_size_type char_count() const { return hdr->char_count; }
+
+    /// @brief Returns number of words in all chunks.
+      chunk_size_type word_count() const { return hdr->word_count; }
+
+    /// @brief Returns number of characters in a range of chunks.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+      chunk_size_type char_count
+      ( chunk_index_type first
+      , chunk_count_type count
+      ) const;
+
+    /// @brief Returns number of words in a range of chunks.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+      chunk_size_type word_count
+      ( chunk_index_type first
+      , chunk_count_type count
+      ) const;
+
+    /// @brief Returns occurrence of a character in all chunks.
+      chunk_size_type char_occurrence(char chr) const;
+
+    /// @brief Returns occurrence of a word in all chunks.
+      chunk_size_type word_occurrence(std::string const & word) const;
+    };
+
+    template <class TextInfo>
+    basic_text_image_builder<TextInfo>::basic_text_image_builder
+    ( TextInfo const & ti
+    )
+    : source(ti)
+    , chunk_tables_size{0U}
+    , text_size{0U}
+    , word_pool_size{0U}
+    {
+      for (typename TextInfo::chunk_index_type i{0U}; i!=ti.number_of_chunks(); ++i)
+        {
+          auto const & ci(ti.chunk_data(i));
+          text_size += ci.char_count;
+          chunk_tables_size += image::char_table_size(ci.char_occ_map.size())
+                             + ci.word_occ_map.size()*sizeof(image::word);
+          for (auto const & w : ci.word_occ_map)
+            {
+              auto word(w.first.str());
+              word_pool[word] = 0U;
+              word_totals[word] += w.second;
+            }
+        }
+      for (auto & w : word_pool)
+        {
+          w.second = word_pool_size;
+          word_pool_size += w.first.size();
+        }
+    }
+
+    template <class TextInfo>
+    void basic_text_image_builder<TextInfo>::write(void * dest) const
+    {
+      auto const lo(make_layout());
+      auto base(static_cast<char*>(dest));
+      std::memset(base, 0, lo.end);
+
+      auto hdr(reinterpret_cast<image::header*>(base));
+      hdr->version = image::Version;
+      hdr->header_size = sizeof(image::header);
+      hdr->image_size = lo.end;
+      hdr->number_of_chunks = source.number_of_chunks();
+      hdr->char_totals_offset = lo.char_totals;
+      hdr->chunks_offset = lo.chunks;
+      hdr->words_offset = lo.words;
+      hdr->number_of_words = word_totals.size();
+
+      for (auto const & w : word_pool)
+        {
+          std::memcpy(base+lo.word_pool+w.second, w.first.data(), w.first.size());
+        }
+      auto pool_offset([this,&lo](std::string const & word)
+                       {
+                         return lo.word_pool + word_pool.find(word)->second;
+                       }
+                      );
+      auto corpus_word(reinterpret_cast<image::word*>(base+lo.words));
+      for (auto const & w : word_totals)
+        {
+          *corpus_word++ = image::word{pool_offset(w.first), w.first.size(), w.second};
+        }
+
+      auto char_totals(reinterpret_cast<std::uint64_t*>(base+lo.char_totals));
+      auto chunk_rec(reinterpret_cast<image::chunk*>(base+lo.chunks));
+      auto table_pos(lo.chunk_tables);
+      auto text_pos(lo.text);
+      for ( typename TextInfo::chunk_index_type i{0U}
+          ; i!=source.number_of_chunks(); ++i
+          )
+        {
+          auto const & ci(source.chunk_data(i));
+          image::chunk & rec(chunk_rec[i]);
+          rec.text_offset = text_pos;
+          rec.char_count = ci.char_count;
+          rec.word_count = ci.word_count;
+          if (ci.compressed_chunk.empty())
+            {
+              std::memcpy(base+text_pos, ci.chunk.data(), ci.chunk.size());
+            }
+          else
+            {
+              auto txt(source.chunk_text(i));
+              std::memcpy(base+text_pos, txt.data(), txt.size());
+            }
+          text_pos += ci.char_count;
+          hdr->char_count += ci.char_count;
+          hdr->word_count += ci.word_count;
+
+          std::vector<std::pair<unsigned char, std::uint64_t>> chars;
+          for (auto const & c : ci.char_occ_map)
+            {
+              chars.push_back(std::make_pair( static_cast<unsigned char>(c.first)
+                                            , std::uint64_t{c.second}
+                                            ));
+            }
+          std::sort(chars.begin(), chars.end());
+          rec.chars_offset = table_pos;
+          rec.number_of_chars = chars.size();
+          auto counts(reinterpret_cast<std::uint64_t*>
+                              (base+table_pos+image::align8(chars.size())));
+          for (std::size_t c{0U}; c!=chars.size(); ++c)
+            {
+              base[table_pos+c] = static_cast<char>(chars[c].first);
+              counts[c] = chars[c].second;
+              char_totals[chars[c].first] += chars[c].second;
+            }
+          table_pos += image::char_table_size(chars.size());
+
+          std::vector<std::pair<std::string, std::uint64_t>> words;
+          for (auto const & w : ci.word_occ_map)
+            {
+              words.push_back(std::make_pair( w.first.str()
+                                            , std::uint64_t{w.second}
+                                            ));
+            }
+          std::sort(words.begin(), words.end()); // tables may be unordered
+          rec.words_offset = table_pos;
+          rec.number_of_words = words.size();
+          auto chunk_word(reinterpret_cast<image::word*>(base+table_pos));
+          for (auto const & w : words)
+            {
+              *chunk_word++ = image::word
+                              { pool_offset(w.first), w.first.size(), w.second };
+            }
+          table_pos += words.size()*sizeof(image::word);
+        }
+      std::atomic_thread_fence(std::memory_order_release);
+      std::memcpy(hdr->magic, image::Magic, sizeof(hdr->magic));
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_TEXT_IMAGE_H
@@ -15,9 +15,8 @@
 /// @author Ralph E. McArdell
 
 #include "text_info.h"
+#include "text_kernels.h"
 
-#include <iostream>
-#include <sstream>
 #include <stdexcept>
 
 namespace dibase { namespace blog {
@@ -26,73 +25,20 @@ namespace dibase { namespace blog {
     std::string 
         split_next_word(std::string const & text, std::string::size_type & pos)
     {
-      char sep_chars[] = " \t\n\r!\"£$%^&*()_-+={}[]:;@'#~?/>.<,\\|¬`";
-      std::string::size_type start_pos{text.find_first_not_of(sep_chars,pos)};
-      if (start_pos==std::string::npos)
+      auto const & kernels(active_text_kernels());
+      auto start_pos(kernels.find_word_start(text.data(), text.size(), pos));
+      if (start_pos>=text.size())
         {
           return "";
         }
-      std::string::size_type end_pos{text.find_first_of(sep_chars,start_pos)};
-      if (end_pos==std::string::npos)
-        {
-          end_pos = text.size();
-        }
-      std::string::size_type len{end_pos - start_pos};
-      pos = start_pos + len;
-      return text.substr(start_pos, len);    
-    }
-
-    static_assert('a'-'A' > 0, "Require 'a'>'A' in character set." );
-    void inplace_tolower(std::string & word)
-    {
-      for (auto & chref : word)
-        {
-          if ('A'<=chref && chref<='Z')
-            {
-              chref += 'a'-'A';
-            }
-        }
-    }
-
-bool DEBUG_SHOW{false};
-    text_info::chunk_info::chunk_info(std::string chunk_text)
-    : chunk{chunk_text}
-    , char_count{chunk_text.size()}
-    , word_count{0U}
-    {
-      for(auto chr : chunk_text)
-        {
-          ++char_occ_map[chr];
-        }
-      std::string word;
-      std::string::size_type pos{0U};
-      do
-        {
-          word = split_next_word(chunk, pos);
-          if (!word.empty())
-            {
-              ++word_count;
-              inplace_tolower(word);
-              ++word_occ_map[word];
-            }
-if (DEBUG_SHOW)
-{
-std::clog << "text_info::chunk_info::chunk_info: word="<<word
-          <<", word_count="<<word_count<<std::endl;
-}
-        }
-      while (!word.empty());
+      auto end_pos(kernels.find_word_end(text.data(), text.size(), start_pos));
+      pos = end_pos;
+      return text.substr(start_pos, end_pos-start_pos);
     }
 
-    bool text_info::chunk_info::operator==(text_info::chunk_info const & other)
-    {
-      return    this->char_count==other.char_count
-            &&  this->word_count==other.word_count
-            &&  this->chunk==other.chunk
-            &&  this->char_occ_map==other.char_occ_map
-            &&  this->word_occ_map==other.word_occ_map
-            ;
-    }
+    std::size_t const text_info_options::DefaultTextCacheCapacity;
+    std::size_t const text_info_options::DefaultParallelAnalysisThreshold;
+    std::size_t const text_info_options::DefaultParallelReductionThreshold;
   } // namespace sies
 }} // namespaces dibase::blog
 
@@ -20,13 +20,34 @@
 # include <map>
 # include <vector>
 # include <numeric>
+# include <algorithm>
+# include "chunk_text_cache.h"
+# include "fingerprint.h"
+# include "gather_write.h"
+# include "lz_codec.h"
+# include "huge_page_region.h"
+# include "occurrence_tables.h"
+# include "packed_word.h"
+# include "text_kernels.h"
+# include "tokenizers.h"
+# include "worker_pool.h"
+# include <cstdint>
+# include <memory>
+# include <limits>
+# include <stdexcept>
+# include <type_traits>
+# include <deque>
+# include <mutex>
+# include <unordered_map>
+# include <functional>
 
 namespace dibase { namespace blog {
   namespace sies // Shared Immutable, Exclusive Setup
   {
   /// @brief Return next word from given position in string
   ///
-  /// 'Word' is a consecutive sequence of [A-Z][a-z][0-9] characters.
+  /// 'Word' is a consecutive sequence of characters that are not word
+  /// separators (see is_word_separator).
   /// @param text   String to return 'next' word from.
   /// @param pos    0-based position to start search in Text for word. 
   ///               Updated and output to position following that of end of
@@ -37,7 +58,16 @@ namespace dibase { namespace blog {
 
   /// @brief Replaces [A-Z] with [a-z] in place within the passed string.
   /// @param [in,out] str  String that will be modified to make lowercase.
-    void inplace_tolower(std::string & str);
+  /// @param Alloc  Allocator type of string.
+    template <class Alloc>
+    void inplace_tolower(std::basic_string<char,std::char_traits<char>,Alloc> & str)
+    {
+      static_assert('a'-'A' > 0, "Require 'a'>'A' in character set." );
+      if (!str.empty())
+        {
+          active_text_kernels().tolower(&str[0], str.size());
+        }
+    }
 
   /// @brief Replaces [A-Z] with [a-z] in a copy of the passed string.
   /// @param str  String to make lowercase.
@@ -50,6 +80,174 @@ namespace dibase { namespace blog {
       return lc_str;
     }
 
+  /// @brief Storage options for text_info objects.
+    struct text_info_options
+    {
+    /// @brief If true chunk text is held compressed, so chunk_text and text
+    /// requests have to decompress the text unless it is cached.
+      bool        compress_text;
+
+    /// @brief Maximum number of chunks' decompressed text to cache when
+    /// compress_text is true. Zero disables caching.
+      std::size_t text_cache_capacity;
+
+    /// @brief If true a text_registry relocates all its data into a single
+    /// contiguous, read-only text image when its setup completes and releases
+    /// the text_info structures built during setup. Chunk text is held
+    /// uncompressed in the image.
+      bool          compact_on_publish;
+
+    /// @brief Most preferred backing for the memory of compacted data.
+      page_backing  compact_backing;
+
+    /// @brief If true each character's per-chunk occurrence counts are also
+    /// held in a contiguous column, one count per chunk per possible char
+    /// value, making char_occurrence a column sum rather than one map lookup
+    /// per chunk at the cost of 256 counts of storage per chunk.
+      bool          char_count_columns;
+
+    /// @brief If true totals over all chunks of each character's and each
+    /// word's occurrences are kept up to date as chunks are added, making
+    /// char_occurrence and word_occurrence single lookups rather than one
+    /// lookup per chunk at the cost of a table of every distinct word.
+      bool          occurrence_totals;
+
+    /// @brief If true adding a chunk only stores its text: the chunk is
+    /// analysed - split into words and its characters and words counted -
+    /// when first queried. Queries of totals over all chunks analyse every
+    /// chunk not yet analysed. Each chunk is analysed once, even if queried
+    /// concurrently.
+      bool          lazy_analysis;
+
+    /// @brief If true a chunk whose text is identical to that of a chunk
+    /// already added shares the earlier chunk's stored text and occurrence
+    /// tables rather than having its own. Identical text is found by content
+    /// fingerprint and verified by comparing the text.
+      bool          deduplicate_chunks;
+
+    /// @brief Chunks of at least this many characters are split at word
+    /// boundaries into segments analysed in parallel by the shared
+    /// worker_pool, their results merged. Zero disables parallel analysis.
+      std::size_t   parallel_analysis_threshold;
+
+    /// @brief Queries reducing over at least this many chunks - range counts
+    /// and occurrences not answered from columns or totals - split the
+    /// chunks into ranges reduced in parallel by the shared worker_pool.
+    /// Zero disables parallel reduction.
+      std::size_t   parallel_reduction_threshold;
+
+      text_info_options()
+      : compress_text{false}
+      , text_cache_capacity{DefaultTextCacheCapacity}
+      , compact_on_publish{false}
+      , compact_backing{page_backing::standard}
+      , char_count_columns{false}
+      , occurrence_totals{false}
+      , lazy_analysis{false}
+      , deduplicate_chunks{false}
+      , parallel_analysis_threshold{DefaultParallelAnalysisThreshold}
+      , parallel_reduction_threshold{DefaultParallelReductionThreshold}
+      {}
+
+      static std::size_t const DefaultTextCacheCapacity{64U};
+      static std::size_t const DefaultParallelAnalysisThreshold{4U<<20U};
+      static std::size_t const DefaultParallelReductionThreshold{1U<<16U};
+    };
+
+  /// @brief Counter types used by a basic_text_info.
+  ///
+  /// Per-chunk counts - of characters, words and of each character and word
+  /// - are held in ChunkCount values, one per count table entry, so a narrow
+  /// ChunkCount shrinks every count table. Chunks too long for ChunkCount
+  /// are rejected when added. Counts totalled over all chunks are returned as
+  /// TotalCount values.
+  ///
+  /// @param ChunkCount   Unsigned type for per-chunk counts.
+  /// @param TotalCount   Unsigned type of at least 64 bits for corpus totals.
+    template <typename ChunkCount, typename TotalCount>
+    struct counter_widths
+    {
+      static_assert( std::is_unsigned<ChunkCount>::value
+                  && std::is_unsigned<TotalCount>::value
+                   , "Counter types must be unsigned integer types."
+                   );
+      static_assert( std::numeric_limits<TotalCount>::digits>=64
+                  && std::numeric_limits<TotalCount>::digits
+                      >=std::numeric_limits<ChunkCount>::digits
+                   , "Total counter type must be at least 64 bits and no "
+                     "narrower than chunk counter type."
+                   );
+      typedef ChunkCount  chunk_size_type;
+      typedef TotalCount  total_size_type;
+    };
+
+  /// @brief Counter widths used by text_info: counts are string sizes.
+    typedef counter_widths<std::string::size_type, std::string::size_type>
+                                                      default_counter_widths;
+
+  /// @brief 32 bit per-chunk counts, 64 bit totals.
+    typedef counter_widths<std::uint32_t, std::uint64_t>
+                                                      compact_counter_widths;
+
+  /// @brief 16 bit per-chunk counts (chunks of up to 65535 characters), 64
+  /// bit totals.
+    typedef counter_widths<std::uint16_t, std::uint64_t>
+                                                      small_counter_widths;
+
+  /// @brief Queries answered together, in a single pass over the chunks, by
+  /// a stats request.
+    struct text_stats_query
+    {
+    /// @brief Characters to return occurrences in all chunks of.
+      std::vector<char>         chars;
+
+    /// @brief Words to return occurrences in all chunks of.
+      std::vector<std::string>  words;
+
+    /// @brief If true the concatenation of all chunks' text is returned.
+      bool                      include_text;
+
+      text_stats_query()
+      : include_text{false}
+      {}
+    };
+
+  /// @brief Results of a stats request.
+  /// @param ChunkCount   Type of number of chunks.
+  /// @param TotalCount   Type of counts totalled over all chunks.
+    template <typename ChunkCount, typename TotalCount>
+    struct basic_text_stats
+    {
+      ChunkCount              number_of_chunks;
+      TotalCount              char_count;
+      TotalCount              word_count;
+
+    /// @brief Occurrences of each text_stats_query::chars entry, in order.
+      std::vector<TotalCount> char_occurrences;
+
+    /// @brief Occurrences of each text_stats_query::words entry, in order.
+      std::vector<TotalCount> word_occurrences;
+
+    /// @brief Concatenated text, empty unless text_stats_query::include_text.
+      std::string             text;
+
+      basic_text_stats()
+      : number_of_chunks{0U}
+      , char_count{0U}
+      , word_count{0U}
+      {}
+    };
+
+  /// @brief Specific exception type for a chunk too large for its counters
+    class chunk_too_large : public std::overflow_error
+    {
+    public:
+    /// @brief Construct from C-string message
+      explicit chunk_too_large(char const * what_arg)
+      : std::overflow_error(what_arg)
+      {}
+    };
+
   /// @brief Object type having various data-fields that should be setup
   /// 
   /// Type contains an vector of structs containing information on chunks of
@@ -59,39 +257,457 @@ namespace dibase { namespace blog {
   ///
   /// Intended as a common provider of vaguely interesting example services
   /// for use by various pattern-implementation examples.
-    class text_info
+  ///
+  /// Per-chunk character and word counts are also held column-wise: in
+  /// contiguous arrays indexed by chunk, separate from the chunk_info
+  /// objects, so totals over all or a range of chunks stream through
+  /// densely packed counts rather than striding across chunk_info objects.
+  /// Per-chunk character occurrence counts may optionally be held the same
+  /// way (see text_info_options::char_count_columns).
+  ///
+  /// Character and word totals over all chunks are kept up to date as chunks
+  /// are added, so char_count and word_count do not scan the chunks. Totals
+  /// of each character's and word's occurrences may optionally be kept too
+  /// (see text_info_options::occurrence_totals).
+  ///
+  /// Chunks may optionally be analysed lazily, on first query, rather than
+  /// when added (see text_info_options::lazy_analysis). Lazy analyses are
+  /// performed under std::call_once and serialised by a mutex, as the
+  /// object's allocator need not be thread safe, so concurrent queries of a
+  /// published object remain safe and give the same answers.
+  ///
+  /// Chunks with identical text may optionally share one stored chunk_info
+  /// (see text_info_options::deduplicate_chunks). Per-chunk counts are still
+  /// held per chunk, so queries answer exactly as if each chunk were stored
+  /// separately.
+  ///
+  /// All of an object's strings, vectors and maps allocate using (rebound
+  /// copies of) the allocator passed on construction. With a stateful
+  /// allocator such as arena_allocator a whole object can be built within a
+  /// monotonic_arena, making setup allocations pointer bumps and tear down a
+  /// single release of the arena's blocks. Keys made for lookups while
+  /// querying use a default constructed allocator, which for arena_allocator
+  /// means the heap, so queries never allocate from the object's arena.
+  ///
+  /// @param Counters   counter_widths specialisation specifying types used to
+  ///                   hold per-chunk counts and to return corpus totals.
+  /// @param Allocator  Allocator type, rebound as necessary for each element
+  ///                   type.
+  /// @param Tables     Occurrence table policy (see occurrence_tables.h)
+  ///                   selecting chunk_info's character and word occurrence
+  ///                   table types.
+  /// @param Tokenizer  Tokenizer policy (see tokenizers.h) splitting chunks
+  ///                   into words.
+    template < class Counters
+             , class Allocator = std::allocator<char>
+             , class Tables = map_occurrence_tables
+             , class Tokenizer = separator_tokenizer
+             >
+    class basic_text_info
     {
+      template <typename T>
+      using rebind_alloc
+            = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
     public:
+      typedef Allocator                                 allocator_type;
+      typedef Tokenizer                                 tokenizer_type;
+      typedef std::basic_string< char, std::char_traits<char>
+                               , rebind_alloc<char>
+                               >                        string_type;
+
+    /// @brief Word occurrence table key: case folded words of up to 15 bytes
+    /// are held packed into two 64 bit integers.
+      typedef basic_packed_word<16U, Allocator>         word_key_type;
+
     /// @brief Internal type used to hold information on one chunk of text
       struct chunk_info
       {
-        typedef std::string::size_type                chunk_size_type;
-        typedef std::map<char,chunk_size_type>        char_occ_map_type;
-        typedef std::map<std::string,chunk_size_type> word_occ_map_type;
-        std::string chunk;
-        std::string::size_type  char_count;
-        std::string::size_type  word_count;
+        typedef typename Counters::chunk_size_type    chunk_size_type;
+        typedef typename Tables::template table_type
+                            < char, chunk_size_type, Allocator
+                            >                         char_occ_map_type;
+        typedef typename Tables::template table_type
+                            < word_key_type, chunk_size_type, Allocator
+                            >                         word_occ_map_type;
+        string_type chunk;            ///< Empty if text held compressed.
+        string_type compressed_chunk; ///< Empty unless text held compressed.
+        chunk_size_type  char_count;
+        chunk_size_type  word_count;
+        std::uint64_t    fingerprint; ///< text_fingerprint of chunk's text.
         char_occ_map_type char_occ_map;
         word_occ_map_type word_occ_map;
 
-        chunk_info()
-        : char_count{0U}
+        explicit chunk_info(allocator_type const & alloc = allocator_type())
+        : chunk(alloc)
+        , compressed_chunk(alloc)
+        , char_count{0U}
         , word_count{0U}
+        , fingerprint{text_fingerprint(nullptr, 0U)}
+        , char_occ_map(alloc)
+        , word_occ_map(alloc)
         {}
-        chunk_info(std::string chunk_text);
-        bool operator==(text_info::chunk_info const & other);
-        bool operator!=(text_info::chunk_info const & other)
+
+      /// @brief Construct from, and optionally analyse, chunk_text.
+      /// @param chunk_text   Text of chunk.
+      /// @param alloc        Allocator for chunk_info's strings and maps.
+      /// @param analyse_text If false only the text and its character count
+      ///                     are stored: call analyse to complete the rest.
+      /// @throws dibase::blog::sies::chunk_too_large if chunk_text has more
+      ///         characters than chunk_size_type can count.
+        chunk_info
+        ( std::string const & chunk_text
+        , allocator_type const & alloc = allocator_type()
+        , bool analyse_text = true
+        );
+
+      /// @brief Construct as above with chunk_text's already computed
+      /// fingerprint, so it is not computed again.
+      /// @param chunk_text       Text of chunk.
+      /// @param text_print       text_fingerprint of chunk_text.
+      /// @param alloc            Allocator for chunk_info's strings and maps.
+      /// @param analyse_text     If false only the text and its character
+      ///                         count are stored.
+      /// @throws dibase::blog::sies::chunk_too_large if chunk_text has more
+      ///         characters than chunk_size_type can count.
+        chunk_info
+        ( std::string const & chunk_text
+        , std::uint64_t text_print
+        , allocator_type const & alloc
+        , bool analyse_text
+        );
+
+      /// @brief Copy other, text and occurrence tables, using alloc.
+      /// @param other  Chunk copied, analysed or not.
+      /// @param alloc  Allocator for chunk_info's strings, maps and keys.
+        chunk_info(chunk_info const & other, allocator_type const & alloc);
+
+      /// @brief Count the chunk's words and occurrences of each character and
+      /// word.
+      /// If size is at least parallel_threshold, which is non-zero, the text
+      /// is analysed in segments in parallel (see analyse_in_parallel).
+      /// @param text   Pointer to first character of chunk's text.
+      /// @param size   Number of characters in chunk's text.
+      /// @param alloc  Allocator for word occurrence table keys.
+      /// @param parallel_threshold Minimum size analysed in parallel, zero
+      ///                           if never.
+        void analyse
+        ( char const * text
+        , std::size_t size
+        , allocator_type const & alloc
+        , std::size_t parallel_threshold = 0U
+        );
+
+      /// @brief Analyse as analyse, splitting the text at word boundaries
+      /// into a segment per thread of pool, analysing the segments in
+      /// parallel then merging their counts. Results are identical to those
+      /// of analysing the text serially.
+      /// @param text   Pointer to first character of chunk's text.
+      /// @param size   Number of characters in chunk's text.
+      /// @param alloc  Allocator for word occurrence table keys.
+      /// @param pool   Pool performing the analysis.
+        void analyse_in_parallel
+        ( char const * text
+        , std::size_t size
+        , allocator_type const & alloc
+        , worker_pool & pool
+        );
+      /// @brief Exact comparison of chunks' text, counts and occurrence
+      /// tables: O(text size) for equal chunks. Chunks with different
+      /// fingerprints are unequal without further comparison. Use matches
+      /// for a constant time check.
+        bool operator==(chunk_info const & other) const;
+
+      /// @brief Constant time comparison of chunks' fingerprints and counts.
+      /// Chunks that are equal always match; unequal chunks match only if
+      /// their text fingerprints collide.
+        bool matches(chunk_info const & other) const
+        {
+          return    fingerprint==other.fingerprint
+                &&  char_count==other.char_count
+                &&  word_count==other.word_count
+                ;
+        }
+        bool operator!=(chunk_info const & other) const
         {
           return !(*this==other);
         }
       };
 
-      typedef chunk_info::chunk_size_type chunk_size_type;
+      typedef typename chunk_info::chunk_size_type  chunk_size_type;
+      typedef typename Counters::total_size_type    total_size_type;
 
     private:
-      typedef std::vector<chunk_info>     chunk_vector;
+      typedef std::vector<chunk_info, rebind_alloc<chunk_info>>  chunk_vector;
+      typedef std::vector< chunk_size_type
+                         , rebind_alloc<chunk_size_type>
+                         >                                  count_column;
+      typedef std::vector<count_column, rebind_alloc<count_column>>
+                                                            count_columns;
+      typedef std::vector< total_size_type
+                         , rebind_alloc<total_size_type>
+                         >                                  total_column;
+      typedef typename Tables::template table_type
+                          < word_key_type, total_size_type, Allocator
+                          >                                 word_total_table;
+      typedef std::deque<std::once_flag, rebind_alloc<std::once_flag>>
+                                                            once_flags;
+      typedef typename chunk_vector::size_type              stored_index_type;
+      typedef std::vector< stored_index_type
+                         , rebind_alloc<stored_index_type>
+                         >                                  stored_index_column;
+      typedef std::unordered_multimap
+              < std::uint64_t, stored_index_type
+              , std::hash<std::uint64_t>, std::equal_to<std::uint64_t>
+              , rebind_alloc<std::pair<std::uint64_t const, stored_index_type>>
+              >                                             fingerprint_index;
+
+    /// @brief Number of char_columns when char_count_columns option set.
+      static std::size_t const NumberOfCharValues
+                                = std::numeric_limits<unsigned char>::max()+1U;
 
       chunk_vector  text_data; ///< The data member - sequence of text chunks
+      stored_index_column stored_indexes; ///< Each chunk's text_data index,
+                                          ///< if deduplicating chunks.
+      fingerprint_index   fingerprints;   ///< text_data indexes by text
+                                          ///< fingerprint.
+      count_column  char_counts;  ///< Each chunk's character count.
+      count_column  word_counts;  ///< Each chunk's word count.
+      count_columns char_columns; ///< Per char value, each chunk's occurrence.
+      total_size_type char_total{0U}; ///< Sum of char_counts.
+      total_size_type word_total{0U}; ///< Sum of word_counts.
+      std::uint64_t text_digest{EmptyDigest}; ///< Digest of chunk fingerprints.
+      total_column  char_totals;  ///< Per char value, total occurrence.
+      word_total_table word_totals; ///< Per word, total occurrence.
+      mutable once_flags analysed;  ///< Per chunk, if analysis is lazy.
+      mutable std::vector<bool, rebind_alloc<bool>> stored_analysed;
+                                ///< Per text_data entry, if analysis is lazy.
+      mutable std::mutex analysis_mutex; ///< Serialises lazy analyses.
+      text_info_options                 options;
+      std::unique_ptr<chunk_text_cache> text_cache;
+
+    /// @brief Helper: validates a chunk range.
+    /// @throws std::out_of_range if range extends beyond the last chunk.
+      void check_range
+      ( typename chunk_vector::size_type first
+      , typename chunk_vector::size_type count
+      , char const * what
+      ) const
+      {
+        if (first>char_counts.size() || count>char_counts.size()-first)
+          {
+            throw std::out_of_range{what};
+          }
+      }
+
+    /// @brief Helper: returns index in text_data of a chunk's chunk_info.
+    /// @param chunk_index  Index of chunk, assumed valid.
+      stored_index_type stored_index
+      ( typename chunk_vector::size_type chunk_index
+      ) const
+      {
+        return stored_indexes.empty() ? chunk_index : stored_indexes[chunk_index];
+      }
+
+    /// @brief Helper: returns a chunk's chunk_info, which may be shared with
+    /// other chunks having identical text.
+    /// @param chunk_index  Index of chunk, assumed valid.
+      chunk_info const & stored_chunk
+      ( typename chunk_vector::size_type chunk_index
+      ) const
+      {
+        return text_data[stored_index(chunk_index)];
+      }
+
+    /// @brief Helper: returns index in text_data of chunk_info of a chunk
+    /// with the same text as text.
+    /// @param text         Text to find.
+    /// @param fingerprint  text_fingerprint of text.
+    /// @returns text_data index, text_data.size() if text is not a duplicate.
+      stored_index_type find_duplicate
+      ( std::string const & text
+      , std::uint64_t fingerprint
+      ) const;
+
+    /// @brief Helper: adds an analysed chunk's counts to the count columns
+    /// and totals.
+      void add_analysis(typename chunk_vector::size_type chunk_index);
+
+    /// @brief Helper: pushes a new chunk_info onto text_data.
+    /// @param ci           Chunk stored.
+    /// @param is_analysed  True if ci has been analysed. Must be true unless
+    ///                     analysis is lazy.
+      void store_chunk(chunk_info && ci, bool is_analysed);
+
+    /// @brief Helper: adds a chunk, held in text_data, to the end of the
+    /// sequence of chunks, updating the count columns, totals and digest.
+    /// The chunk is analysed now unless analysis is lazy.
+    /// @param stored Index in text_data of the chunk's chunk_info.
+      void add_stored_chunk(stored_index_type stored);
+
+    /// @brief Helper: returns a new empty text cache if the object has one,
+    /// otherwise nullptr.
+      std::unique_ptr<chunk_text_cache> new_text_cache() const
+      {
+        return std::unique_ptr<chunk_text_cache>
+                { text_cache
+                  ? new chunk_text_cache{options.text_cache_capacity}
+                  : nullptr
+                };
+      }
+
+    /// @brief Helper: removes all chunks as clear does, replacing the lazy
+    /// analysis flags and text cache with those already allocated, so it
+    /// does not throw.
+    /// @param no_flags Empty flags, swapped with the object's flags.
+    /// @param cache    Result of new_text_cache, swapped with the object's
+    ///                 text cache.
+      void clear_with
+      ( once_flags & no_flags
+      , std::unique_ptr<chunk_text_cache> & cache
+      )
+      {
+        chunk_vector{text_data.get_allocator()}.swap(text_data);
+        stored_index_column{stored_indexes.get_allocator()}.swap(stored_indexes);
+        fingerprints.clear();
+        count_column{char_counts.get_allocator()}.swap(char_counts);
+        count_column{word_counts.get_allocator()}.swap(word_counts);
+        for (auto & column : char_columns)
+          {
+            count_column{column.get_allocator()}.swap(column);
+          }
+        char_total = word_total = 0U;
+        text_digest = EmptyDigest;
+        std::fill(char_totals.begin(), char_totals.end(), 0U);
+        word_totals = word_total_table{word_totals.get_allocator()};
+        no_flags.swap(analysed);
+        stored_analysed.clear();
+        text_cache.swap(cache);
+      }
+
+    /// @brief Helper: appends the chunks of other as append.
+    /// @param other    Object whose chunks are appended.
+    /// @param movable  other's text_data if its chunk_info objects may be
+    ///                 moved rather than copied, otherwise nullptr.
+      void append_chunks(basic_text_info const & other, chunk_vector * movable);
+
+    /// @brief Helper: analyses a chunk, if analysis is lazy and the chunk
+    /// has not already been analysed.
+    /// @param chunk_index  Index of chunk, assumed valid.
+      void analyse_chunk(typename chunk_vector::size_type chunk_index) const;
+
+    /// @brief Helper: analyses a range of chunks as analyse_chunk.
+    /// @param first        Index of first chunk in range, assumed valid.
+    /// @param count        Number of chunks in range, assumed valid.
+      void analyse_chunks
+      ( typename chunk_vector::size_type first
+      , typename chunk_vector::size_type count
+      ) const
+      {
+        if (options.lazy_analysis)
+          {
+            for (auto i(first); i!=first+count; ++i)
+              {
+                analyse_chunk(i);
+              }
+          }
+      }
+
+    /// @brief Helper: returns a chunk's data, analysing the chunk if needed.
+    /// @throws std::out_of_range if chunk_index is not less than the number
+    ///         of chunks.
+      chunk_info const & analysed_chunk
+      ( typename chunk_vector::size_type chunk_index
+      ) const
+      {
+        check_range(chunk_index, 1U, "text_info: chunk index");
+        analyse_chunk(chunk_index);
+        return stored_chunk(chunk_index);
+      }
+
+    /// @brief Helper: reduces a range of chunks, combining the results of
+    /// calling range_fn(first, count) for sub-ranges of the range. Ranges of
+    /// at least options.parallel_reduction_threshold chunks are reduced in
+    /// parallel by the shared worker_pool, so range_fn must be safe to call
+    /// concurrently. Smaller ranges are passed whole to range_fn.
+      template <typename T, typename RangeFn, typename Combine>
+      T reduce_chunks
+      ( typename chunk_vector::size_type first
+      , typename chunk_vector::size_type count
+      , T const & identity
+      , RangeFn const & range_fn
+      , Combine const & combine
+      ) const
+      {
+        if ( options.parallel_reduction_threshold==0U
+          || count<options.parallel_reduction_threshold
+           )
+          {
+            return range_fn(first, count);
+          }
+        return worker_pool::shared().parallel_reduce
+                ( count, identity
+                , [first, &range_fn](std::size_t sub_first, std::size_t sub_count)
+                  {
+                    return range_fn(first+sub_first, sub_count);
+                  }
+                , combine
+                );
+      }
+
+    /// @brief Helper: sums range_fn results for a range of chunks as
+    /// reduce_chunks.
+      template <typename RangeFn>
+      total_size_type sum_chunks
+      ( typename chunk_vector::size_type first
+      , typename chunk_vector::size_type count
+      , RangeFn const & range_fn
+      ) const
+      {
+        return reduce_chunks( first, count, total_size_type{0U}, range_fn
+                            , std::plus<total_size_type>()
+                            );
+      }
+
+    /// @brief Helper: sums a range of a count column, in parallel if the
+    /// range is large enough.
+      total_size_type sum_column
+      ( count_column const & column
+      , typename count_column::size_type first
+      , typename count_column::size_type count
+      ) const
+      {
+        return sum_chunks
+                ( first, count
+                , [&column]( typename count_column::size_type sub_first
+                           , typename count_column::size_type sub_count
+                           )
+                  {
+                    return std::accumulate( column.begin()+sub_first
+                                          , column.begin()+sub_first+sub_count
+                                          , total_size_type{0U}
+                                          );
+                  }
+                );
+      }
+
+    /// @brief Helper: returns text of a chunk held compressed.
+    /// The chunk is identified by its stored_index, so chunks sharing text
+    /// share cached text. Returns cached text if available. If not decompresses the text and,
+    /// if add_to_cache is true, adds it to the cache.
+      std::string expand_chunk_text
+      ( typename chunk_vector::size_type chunk_index
+      , bool add_to_cache
+      ) const;
+
+    /// @brief Helper: returns lowercase copy of word as a word map key.
+    /// The key's allocator is default constructed, not a copy of the
+    /// object's, so making it never allocates from an object's arena. Only
+    /// words too long to pack allocate at all.
+      static word_key_type word_key(std::string const & word)
+      {
+        return word_key_type::folded(word.data(), word.size());
+      }
 
     /// @brief Helper: look up item in map and returns value or zero.
     ///
@@ -99,12 +715,12 @@ namespace dibase { namespace blog {
     /// chunk_info.
     ///
     /// @param occ_map    : Occurrence map to perform lookup on.
-    /// @param key        : Key used (char or std::string) to lookup value.
+    /// @param key        : Key used (char or word_key_type) to lookup value.
     /// @returns occurrence value for key or 0 if no entry for key in occ_map.
-      template <typename KeyT>
-      static chunk_size_type lookup_occurrence
-      ( std::map<KeyT, chunk_size_type> const & occ_map
-      , KeyT key
+      template <typename OccMapT, typename KeyT>
+      static typename OccMapT::mapped_type lookup_occurrence
+      ( OccMapT const & occ_map
+      , KeyT const & key
       )
       {
         auto pos(occ_map.find(key));
@@ -112,27 +728,117 @@ namespace dibase { namespace blog {
       }
 
     public:
-      typedef chunk_vector::size_type     chunk_count_type;
+      typedef typename chunk_vector::size_type  chunk_count_type;
       typedef chunk_count_type            chunk_index_type;
+      typedef basic_text_stats<chunk_count_type, total_size_type>
+                                          stats_type;
 
-      text_info() = default;
-      text_info(text_info const &) = delete;
-      text_info(text_info &&) = delete;
-      text_info & operator=(text_info const &) = delete;
-      text_info & operator=(text_info &&) = delete;
+    /// @brief Construct with default options: chunk text held uncompressed.
+      basic_text_info() = default;
+
+    /// @brief Construct with default options using an allocator.
+    /// @param alloc  Allocator used for all the object's data.
+      explicit basic_text_info(allocator_type const & alloc)
+      : text_data(alloc)
+      , stored_indexes(alloc)
+      , fingerprints(alloc)
+      , char_counts(alloc)
+      , word_counts(alloc)
+      , char_columns(alloc)
+      , char_totals(alloc)
+      , word_totals(alloc)
+      , analysed(alloc)
+      , stored_analysed(alloc)
+      {}
+
+    /// @brief Construct with specified storage options.
+    /// @param opts   Storage options to use.
+    /// @param alloc  Allocator used for all the object's data.
+      explicit basic_text_info
+      ( text_info_options const & opts
+      , allocator_type const & alloc = allocator_type()
+      );
+
+    /// @brief Returns the allocator used for the object's data.
+      allocator_type get_allocator() const { return text_data.get_allocator(); }
+
+    /// @brief Returns the storage options the object was created with.
+      text_info_options const & storage_options() const { return options; }
+
+    /// @brief Mutable operation. Remove all chunks, releasing their memory.
+    /// If an exception is thrown the object is unchanged.
+      void clear()
+      {
+        once_flags no_flags{analysed.get_allocator()};
+        auto cache(new_text_cache());
+        clear_with(no_flags, cache);
+      }
+
+      basic_text_info(basic_text_info const &) = delete;
+      basic_text_info(basic_text_info &&) = delete;
+      basic_text_info & operator=(basic_text_info const &) = delete;
+      basic_text_info & operator=(basic_text_info &&) = delete;
 
     /// @brief Mutable operation. Add a chunk of text to an object.
     /// Creates a chunk_info object from text and pushes to the end of the
     /// sequence of chunks.
+    /// If compressing text the chunk's text is compressed once it has been
+    /// analysed, or stored, if analysis is lazy.
     /// @param text Text string chunk to add to object.
-      void add_text_chunk(std::string const & text)
+    /// @throws dibase::blog::sies::chunk_too_large if text has more
+    ///         characters than chunk_size_type can count.
+      void add_text_chunk(std::string const & text);
+
+    /// @brief Mutable operation. Append another object's chunks to the end
+    /// of the sequence of chunks.
+    /// The other object's character counts, word counts and occurrence
+    /// tables are reused: no text is tokenized again. Chunks the other
+    /// object has not yet analysed are analysed first, unless this object's
+    /// analysis is lazy, in which case they are appended unanalysed. Text is
+    /// compressed, decompressed and deduplicated according to this object's
+    /// storage options. If an exception is thrown, chunks already appended
+    /// remain.
+    /// @param other  Object whose chunks are appended, which may be this
+    ///               object.
+      void append(basic_text_info const & other)
       {
-        text_data.push_back(text_info::chunk_info{text});
+        append_chunks(other, nullptr);
+      }
+
+    /// @brief Mutable operation. Append another object's chunks as append,
+    /// moving rather than copying the other object's chunk data where its
+    /// allocator is equal and its chunks are not deduplicated. other is
+    /// cleared, even if an exception is thrown, as some of its chunks may
+    /// have been moved by then.
+    /// @param other  Object whose chunks are appended.
+      void append(basic_text_info && other)
+      {
+        if (&other==this)
+          {
+            append_chunks(other, nullptr);
+            return;
+          }
+        bool const movable{ !other.options.deduplicate_chunks
+                          && get_allocator()==other.get_allocator()
+                          };
+      // Allocated first so other can be cleared without throwing.
+        once_flags no_flags{other.analysed.get_allocator()};
+        auto cache(other.new_text_cache());
+        try
+          {
+            append_chunks(other, movable ? &other.text_data : nullptr);
+          }
+        catch (...)
+          {
+            other.clear_with(no_flags, cache);
+            throw;
+          }
+        other.clear_with(no_flags, cache);
       }
 
     /// @brief Immutable operation. Returns number of text chunks in object.
     /// @returns Number of entries in chunk sequence.
-      chunk_count_type number_of_chunks() const { return text_data.size(); }
+      chunk_count_type number_of_chunks() const { return char_counts.size(); }
 
     /// @brief Immutable operation. Returns copy the chunk text.
     /// @param chunk_index  Index of chunk in sequence of chunks
@@ -141,9 +847,51 @@ namespace dibase { namespace blog {
     ///         value returned by number_of_chunks.
       std::string  chunk_text(chunk_index_type chunk_index) const
       {
-        return text_data.at(chunk_index).chunk;
+        check_range(chunk_index, 1U, "text_info::chunk_text: chunk index");
+        auto const & ci(stored_chunk(chunk_index));
+        return ci.compressed_chunk.empty()
+                  ? std::string(ci.chunk.data(), ci.chunk.size())
+                  : expand_chunk_text(stored_index(chunk_index),true);
+      }
+
+    /// @brief Immutable operation. Returns bytes used to hold all chunks'
+    /// text, which is less than char_count() if text is held compressed or
+    /// chunks are deduplicated.
+      std::uint64_t stored_text_size() const;
+
+    /// @brief Immutable operation. Returns a chunk's full chunk information.
+    /// Intended for code processing all of a chunk's data in bulk, such as
+    /// making a text image. If text is held compressed the chunk_info's chunk
+    /// member is empty; use chunk_text to obtain the text.
+    /// @param chunk_index  Index of chunk in sequence of chunks
+    /// @returns Reference to the chunk_info of the chunk
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+      chunk_info const & chunk_data(chunk_index_type chunk_index) const
+      {
+        return analysed_chunk(chunk_index);
       }
 
+    /// @brief Immutable operation. Returns a chunk's content fingerprint.
+    /// Chunks with different fingerprints have different text; chunks with
+    /// equal fingerprints almost certainly have the same text.
+    /// @param chunk_index  Index of chunk in sequence of chunks
+    /// @returns text_fingerprint of the chunk's text.
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+      std::uint64_t chunk_fingerprint(chunk_index_type chunk_index) const
+      {
+        check_range(chunk_index, 1U, "text_info::chunk_fingerprint: chunk index");
+        return stored_chunk(chunk_index).fingerprint;
+      }
+
+    /// @brief Immutable operation. Returns digest of all chunks' text.
+    /// Objects with different digests have different chunks; objects with
+    /// equal digests almost certainly have the same chunks.
+    /// @returns combine_fingerprints digest of every chunk's fingerprint in
+    ///          chunk order.
+      std::uint64_t digest() const { return text_digest; }
+
     /// @brief Immutable operation. Returns number of characters in a chunk.
     /// @param chunk_index  Index of chunk in sequence of chunks
     /// @returns Number of characters in specfied chunk
@@ -151,7 +899,7 @@ namespace dibase { namespace blog {
     ///         value returned by number_of_chunks.
       chunk_size_type  chunk_char_count(chunk_index_type chunk_index) const
       {
-        return text_data.at(chunk_index).char_count;
+        return char_counts.at(chunk_index);
       }
 
     /// @brief Immutable operation. Returns number of word in a chunk.
@@ -162,7 +910,8 @@ namespace dibase { namespace blog {
     ///         value returned by number_of_chunks.
       chunk_size_type  chunk_word_count(chunk_index_type chunk_index) const
       {
-        return text_data.at(chunk_index).word_count;
+        analysed_chunk(chunk_index);
+        return word_counts[chunk_index];
       }
 
     /// @brief Immutable operation. Returns occurrence of a character in a chunk.
@@ -176,7 +925,11 @@ namespace dibase { namespace blog {
       , char chr
       ) const
       {
-        auto & occ_map(text_data.at(chunk_index).char_occ_map);
+        auto & occ_map(analysed_chunk(chunk_index).char_occ_map);
+        if (!char_columns.empty())
+          {
+            return char_columns[static_cast<unsigned char>(chr)][chunk_index];
+          }
         return lookup_occurrence(occ_map,chr);
       }
 
@@ -192,85 +945,937 @@ namespace dibase { namespace blog {
       , std::string const & word
       ) const
       {
-        auto & occ_map(text_data.at(chunk_index).word_occ_map);
-        return lookup_occurrence(occ_map,tolower(word));
+        auto & occ_map(analysed_chunk(chunk_index).word_occ_map);
+        return lookup_occurrence(occ_map,word_key(word));
       }
 
     /// @brief Immutable operation. Returns concatenation of all chunks' text.
+    /// Chunk text held compressed that is not cached is decompressed but not
+    /// added to the cache, so a whole text request does not evict the cached
+    /// text of frequently requested chunks.
     /// @returns Concatenated text of all chunks
-      std::string  text() const
+      std::string  text() const;
+
+    /// @brief Immutable operation. Writes text of a range of chunks to a file.
+    /// The chunks' text is written directly from where it is stored using
+    /// scatter-gather writes (writev) - no concatenated copy is made. Chunks
+    /// are written in batches; compressed chunks are decompressed a batch,
+    /// of about a megabyte, at a time into a reused buffer.
+    /// @param fd           File descriptor, in blocking mode, to write to.
+    /// @param first        Index of first chunk to write.
+    /// @param count        Number of chunks to write.
+    /// @returns Number of bytes written.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+    /// @throws std::system_error if writing fails.
+      std::uint64_t write_chunks_text
+      ( int fd
+      , chunk_index_type first
+      , chunk_count_type count
+      ) const;
+
+    /// @brief Immutable operation. Writes concatenation of all chunks' text
+    /// to a file without making a concatenated copy.
+    /// @param fd           File descriptor, in blocking mode, to write to.
+    /// @returns Number of bytes written.
+    /// @throws std::system_error if writing fails.
+      std::uint64_t write_text(int fd) const
       {
-        return std::accumulate(text_data.begin(), text_data.end(), chunk_info()
-                              , [](chunk_info & acc, chunk_info const & v) 
-                                -> chunk_info
-                                {
-                                  acc.chunk += v.chunk;
-                                  return acc;
-                                }
-                              ).chunk; 
+        return write_chunks_text(fd, 0U, number_of_chunks());
       }
 
     /// @brief Immutable operation. Returns number of characters in all chunks.
     /// @returns Cumulative number of characters in all chunks
-      chunk_size_type  char_count() const
+      total_size_type  char_count() const
+      {
+        return char_total;
+      }
+
+    /// @brief Immutable operation. Returns number of characters in a range
+    /// of chunks.
+    /// @param first        Index of first chunk in range.
+    /// @param count        Number of chunks in range.
+    /// @returns Cumulative number of characters in the chunks in the range.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+      total_size_type  char_count
+      ( chunk_index_type first
+      , chunk_count_type count
+      ) const
       {
-        return std::accumulate(text_data.begin(), text_data.end(), chunk_info()
-                              , [](chunk_info & acc, chunk_info const & v) 
-                                -> chunk_info
-                                {
-                                  acc.char_count += v.char_count;
-                                  return acc;
-                                }
-                              ).char_count; 
+        check_range(first, count, "text_info::char_count: chunk range");
+        return sum_column(char_counts, first, count);
       }
 
     /// @brief Immutable operation. Returns number of words in all chunks.
     /// @returns Cumulative number of words in all chunks
-      chunk_size_type  word_count() const
+      total_size_type  word_count() const
+      {
+        analyse_chunks(0U, number_of_chunks());
+        return word_total;
+      }
+
+    /// @brief Immutable operation. Returns number of words in a range of
+    /// chunks.
+    /// @param first        Index of first chunk in range.
+    /// @param count        Number of chunks in range.
+    /// @returns Cumulative number of words in the chunks in the range.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+      total_size_type  word_count
+      ( chunk_index_type first
+      , chunk_count_type count
+      ) const
       {
-        return std::accumulate(text_data.begin(), text_data.end(), chunk_info()
-                              , [](chunk_info & acc, chunk_info const & v) 
-                                -> chunk_info
-                                {
-                                  acc.word_count += v.word_count;
-                                  return acc;
-                                }
-                              ).word_count; 
+        check_range(first, count, "text_info::word_count: chunk range");
+        analyse_chunks(first, count);
+        return sum_column(word_counts, first, count);
       }
 
     /// @brief Immutable operation. Returns occurrence of character in all chunks
     /// @param chr          Character to return occurrence for.
     /// @returns Cumulative occurrence of chr in all chunks.
-      chunk_size_type  char_occurrence(char chr) const
+      total_size_type  char_occurrence(char chr) const
       {
-        return std::accumulate(text_data.begin(), text_data.end(), chunk_info()
-                              , [this,chr](chunk_info & acc, chunk_info const & v) 
-                                -> chunk_info
-                                {
-                                  acc.char_count += 
-                                          lookup_occurrence(v.char_occ_map,chr);
-                                  return acc;
-                                }
-                              ).char_count; 
+        analyse_chunks(0U, number_of_chunks());
+        if (!char_totals.empty())
+          {
+            return char_totals[static_cast<unsigned char>(chr)];
+          }
+        if (!char_columns.empty())
+          {
+            auto const & column(char_columns[static_cast<unsigned char>(chr)]);
+            return sum_column(column, 0U, column.size());
+          }
+        return sum_chunks
+                ( 0U, number_of_chunks()
+                , [this, chr](chunk_index_type first, chunk_count_type count)
+                  {
+                    total_size_type occurrence{0U};
+                    for (auto i(first); i!=first+count; ++i)
+                      {
+                        occurrence += lookup_occurrence( stored_chunk(i).char_occ_map
+                                                       , chr
+                                                       );
+                      }
+                    return occurrence;
+                  }
+                );
       }
 
     /// @brief Immutable operation. Returns occurrence of a word in all chunks
     /// @param word          Word to return occurrence for.
     /// @returns Cumulative occurrence of word in all chunks.
-      chunk_size_type  word_occurrence(std::string const & word) const
+      total_size_type  word_occurrence(std::string const & word) const
       {
-        auto lcword(tolower(word));
-        return std::accumulate(text_data.begin(), text_data.end(), chunk_info()
-                              , [this,lcword](chunk_info & acc, chunk_info const & v) 
-                                -> chunk_info
-                                {
-                                  acc.word_count += 
-                                      lookup_occurrence(v.word_occ_map,lcword);
-                                  return acc;
-                                }
-                              ).word_count; 
+        analyse_chunks(0U, number_of_chunks());
+        auto lcword(word_key(word));
+        if (options.occurrence_totals)
+          {
+            return lookup_occurrence(word_totals, lcword);
+          }
+        return sum_chunks
+                ( 0U, number_of_chunks()
+                , [this, &lcword](chunk_index_type first, chunk_count_type count)
+                  {
+                    total_size_type occurrence{0U};
+                    for (auto i(first); i!=first+count; ++i)
+                      {
+                        occurrence += lookup_occurrence( stored_chunk(i).word_occ_map
+                                                       , lcword
+                                                       );
+                      }
+                    return occurrence;
+                  }
+                );
       }
+
+    /// @brief Immutable operation. Returns the number of chunks, character
+    /// and word counts and the results of a set of queries, all gathered in
+    /// a single pass over the chunks.
+    /// @param query        Character and word occurrences to return and
+    ///                     whether to return the text.
+    /// @returns Statistics of all chunks: as returned by number_of_chunks,
+    ///          char_count, word_count, char_occurrence and word_occurrence
+    ///          for each of the query's characters and words and, if
+    ///          requested, text.
+      stats_type stats(text_stats_query const & query) const;
     };
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    basic_text_info<Counters, Allocator, Tables, Tokenizer>::chunk_info::chunk_info
+    ( std::string const & chunk_text
+    , allocator_type const & alloc
+    , bool analyse_text
+    )
+    : chunk_info
+      { chunk_text, text_fingerprint(chunk_text.data(), chunk_text.size())
+      , alloc, analyse_text
+      }
+    {}
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    basic_text_info<Counters, Allocator, Tables, Tokenizer>::chunk_info::chunk_info
+    ( std::string const & chunk_text
+    , std::uint64_t text_print
+    , allocator_type const & alloc
+    , bool analyse_text
+    )
+    : chunk(chunk_text.data(), chunk_text.size(), alloc)
+    , compressed_chunk(alloc)
+    , char_count{0U}
+    , word_count{0U}
+    , fingerprint{text_print}
+    , char_occ_map(alloc)
+    , word_occ_map(alloc)
+    {
+      if (chunk_text.size()>std::numeric_limits<chunk_size_type>::max())
+        {
+          throw chunk_too_large{"Text chunk too large for chunk counter type."};
+        }
+      char_count = static_cast<chunk_size_type>(chunk_text.size());
+      if (analyse_text)
+        {
+          analyse(chunk_text.data(), chunk_text.size(), alloc);
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    basic_text_info<Counters, Allocator, Tables, Tokenizer>::chunk_info::chunk_info
+    ( chunk_info const & other
+    , allocator_type const & alloc
+    )
+    : chunk(other.chunk.data(), other.chunk.size(), alloc)
+    , compressed_chunk( other.compressed_chunk.data()
+                      , other.compressed_chunk.size(), alloc
+                      )
+    , char_count{other.char_count}
+    , word_count{other.word_count}
+    , fingerprint{other.fingerprint}
+    , char_occ_map(alloc)
+    , word_occ_map(alloc)
+    {
+      for (auto const & occ : other.char_occ_map)
+        {
+          char_occ_map[occ.first] = occ.second;
+        }
+      word_key_type key{alloc};
+      for (auto const & occ : other.word_occ_map)
+        {
+          key = occ.first; // Assignment keeps key's allocator
+          word_occ_map[key] = occ.second;
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::chunk_info::analyse
+    ( char const * text
+    , std::size_t size
+    , allocator_type const & alloc
+    , std::size_t parallel_threshold
+    )
+    {
+      if (parallel_threshold!=0U && size>=parallel_threshold
+                                 && worker_pool::shared().size()!=0U)
+        {
+          analyse_in_parallel(text, size, alloc, worker_pool::shared());
+          return;
+        }
+      std::uint64_t char_counts[NumberOfCharCounts] = {};
+      active_text_kernels().count_chars(text, size, char_counts);
+      for (std::size_t c{0U}; c!=NumberOfCharCounts; ++c)
+        {
+          if (char_counts[c]!=0U)
+            {
+              char_occ_map[static_cast<char>(c)]
+                                = static_cast<chunk_size_type>(char_counts[c]);
+            }
+        }
+      for (std::size_t pos{0U};;)
+        {
+          auto start(Tokenizer::find_word_start(text, size, pos));
+          if (start==size)
+            {
+              break;
+            }
+          pos = Tokenizer::find_word_end(text, size, start);
+          ++word_count;
+          ++word_occ_map[word_key_type::folded(text+start, pos-start, alloc)];
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::chunk_info::analyse_in_parallel
+    ( char const * text
+    , std::size_t size
+    , allocator_type const & alloc
+    , worker_pool & pool
+    )
+    {
+    // Segments' words are keyed using the heap as the object's allocator
+    // need not be thread safe.
+      typedef basic_packed_word<16U>                        segment_key_type;
+      typedef typename Tables::template table_type
+                          < segment_key_type, std::uint64_t
+                          , std::allocator<char>
+                          >                                 segment_word_table;
+      struct segment
+      {
+        std::size_t         first;
+        std::size_t         last;
+        std::uint64_t       char_counts[NumberOfCharCounts];
+        std::uint64_t       word_count;
+        segment_word_table  word_occ_map;
+
+        segment() : first{0U}, last{0U}, char_counts{}, word_count{0U} {}
+      };
+      std::vector<segment> segments(pool.concurrency());
+      for (std::size_t s{0U}; s!=segments.size(); ++s)
+        {
+          segments[s].first = s==0U ? 0U : segments[s-1U].last;
+          segments[s].last = s+1U==segments.size()
+                    ? size
+                    : Tokenizer::find_word_end
+                        ( text, size
+                        , std::max(segments[s].first, size/segments.size()*(s+1U))
+                        );
+        }
+      pool.parallel_for
+        ( segments.size()
+        , [text, &segments](std::size_t s)
+          {
+            auto & seg(segments[s]);
+            auto seg_text(text+seg.first);
+            auto seg_size(seg.last-seg.first);
+            active_text_kernels().count_chars(seg_text, seg_size, seg.char_counts);
+            for (std::size_t pos{0U};;)
+              {
+                auto start(Tokenizer::find_word_start(seg_text, seg_size, pos));
+                if (start==seg_size)
+                  {
+                    break;
+                  }
+                pos = Tokenizer::find_word_end(seg_text, seg_size, start);
+                ++seg.word_count;
+                ++seg.word_occ_map[segment_key_type::folded(seg_text+start, pos-start)];
+              }
+          }
+        );
+      std::uint64_t char_counts[NumberOfCharCounts] = {};
+      std::string word;
+      for (auto const & seg : segments)
+        {
+          for (std::size_t c{0U}; c!=NumberOfCharCounts; ++c)
+            {
+              char_counts[c] += seg.char_counts[c];
+            }
+          word_count += static_cast<chunk_size_type>(seg.word_count);
+          for (auto const & occ : seg.word_occ_map)
+            {
+              word.resize(occ.first.size());
+              occ.first.copy(&word[0]);
+              word_occ_map[word_key_type{word.data(), word.size(), alloc}]
+                                      += static_cast<chunk_size_type>(occ.second);
+            }
+        }
+      for (std::size_t c{0U}; c!=NumberOfCharCounts; ++c)
+        {
+          if (char_counts[c]!=0U)
+            {
+              char_occ_map[static_cast<char>(c)]
+                                = static_cast<chunk_size_type>(char_counts[c]);
+            }
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    bool basic_text_info<Counters, Allocator, Tables, Tokenizer>::chunk_info::operator==
+    ( chunk_info const & other
+    ) const
+    {
+      return    this->fingerprint==other.fingerprint
+            &&  this->char_count==other.char_count
+            &&  this->word_count==other.word_count
+            &&  this->chunk==other.chunk
+            &&  this->compressed_chunk==other.compressed_chunk
+            &&  this->char_occ_map==other.char_occ_map
+            &&  this->word_occ_map==other.word_occ_map
+            ;
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    basic_text_info<Counters, Allocator, Tables, Tokenizer>::basic_text_info
+    ( text_info_options const & opts
+    , allocator_type const & alloc
+    )
+    : text_data(alloc)
+    , stored_indexes(alloc)
+    , fingerprints(alloc)
+    , char_counts(alloc)
+    , word_counts(alloc)
+    , char_columns( opts.char_count_columns ? NumberOfCharValues : 0U
+                  , count_column(alloc), alloc
+                  )
+    , char_totals(opts.occurrence_totals ? NumberOfCharValues : 0U, 0U, alloc)
+    , word_totals(alloc)
+    , analysed(alloc)
+    , stored_analysed(alloc)
+    , options(opts)
+    , text_cache{ opts.compress_text && opts.text_cache_capacity!=0U
+                ? new chunk_text_cache{opts.text_cache_capacity}
+                : nullptr
+                }
+    {}
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::add_text_chunk(std::string const & text)
+    {
+      auto stored(text_data.size());
+      auto const fingerprint(text_fingerprint(text.data(), text.size()));
+      if (options.deduplicate_chunks)
+        {
+          stored = find_duplicate(text, fingerprint);
+        }
+      bool const duplicate{stored!=text_data.size()};
+      if (!duplicate)
+        {
+          chunk_info analysed_ci
+                       {text, fingerprint, text_data.get_allocator(), false};
+          if (!options.lazy_analysis)
+            {
+              analysed_ci.analyse( text.data(), text.size()
+                                 , text_data.get_allocator()
+                                 , options.parallel_analysis_threshold
+                                 );
+            }
+          store_chunk(std::move(analysed_ci), !options.lazy_analysis);
+        }
+      add_stored_chunk(stored);
+      auto & ci(text_data[stored]);
+      if (options.compress_text && !duplicate && !ci.chunk.empty())
+        {
+          auto compressed(lz_compress(text));
+          ci.compressed_chunk.assign(compressed.data(), compressed.size());
+          string_type{ci.chunk.get_allocator()}.swap(ci.chunk);
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::store_chunk
+    ( chunk_info && ci
+    , bool is_analysed
+    )
+    {
+      auto stored(text_data.size());
+      text_data.push_back(std::move(ci));
+      if (options.lazy_analysis)
+        {
+          stored_analysed.push_back(is_analysed);
+        }
+      if (options.deduplicate_chunks)
+        {
+          fingerprints.emplace(text_data.back().fingerprint, stored);
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::add_stored_chunk
+    ( stored_index_type stored
+    )
+    {
+      if (options.deduplicate_chunks)
+        {
+          stored_indexes.push_back(stored);
+        }
+      auto const & ci(text_data[stored]);
+      char_counts.push_back(ci.char_count);
+      char_total += ci.char_count;
+      text_digest = combine_fingerprints(text_digest, ci.fingerprint);
+      word_counts.push_back(0U);
+      for (auto & column : char_columns)
+        {
+          column.push_back(0U);
+        }
+      if (options.lazy_analysis)
+        {
+          analysed.emplace_back();
+        }
+      else
+        {
+          add_analysis(char_counts.size()-1U);
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::append_chunks
+    ( basic_text_info const & other
+    , chunk_vector * movable
+    )
+    {
+      auto const count(other.number_of_chunks());
+      if (!options.lazy_analysis)
+        {
+          other.analyse_chunks(0U, count);
+        }
+    // With room reserved the columns cannot throw while a chunk is added.
+      text_data.reserve(text_data.size()+count);
+      char_counts.reserve(char_counts.size()+count);
+      word_counts.reserve(word_counts.size()+count);
+      for (auto & column : char_columns)
+        {
+          column.reserve(column.size()+count);
+        }
+      if (options.deduplicate_chunks)
+        {
+          stored_indexes.reserve(stored_indexes.size()+count);
+        }
+      if (options.lazy_analysis)
+        {
+          stored_analysed.reserve(stored_analysed.size()+count);
+        }
+      for (chunk_index_type i{0U}; i!=count; ++i)
+        {
+          auto const other_stored(other.stored_index(i));
+          chunk_info const & source(other.text_data[other_stored]);
+        // Everything else that may throw is done before the chunk is taken
+        // from other, so other's chunk is intact if it does.
+          auto stored(text_data.size());
+          if (options.deduplicate_chunks)
+            {
+              stored = find_duplicate
+                        ( source.compressed_chunk.empty()
+                          ? std::string(source.chunk.data(), source.chunk.size())
+                          : lz_decompress( source.compressed_chunk.data()
+                                         , source.compressed_chunk.size()
+                                         , source.char_count
+                                         )
+                        , source.fingerprint
+                        );
+            }
+          if (stored==text_data.size())
+            {
+              bool const compress{ options.compress_text
+                                && !source.chunk.empty()
+                                 };
+              bool const expand{ !options.compress_text
+                              && !source.compressed_chunk.empty()
+                               };
+              string_type recoded{get_allocator()};
+              if (compress)
+                {
+                  auto compressed(lz_compress( source.chunk.data()
+                                             , source.chunk.size()
+                                             ));
+                  recoded.assign(compressed.data(), compressed.size());
+                }
+              else if (expand)
+                {
+                  auto expanded(lz_decompress( source.compressed_chunk.data()
+                                             , source.compressed_chunk.size()
+                                             , source.char_count
+                                             ));
+                  recoded.assign(expanded.data(), expanded.size());
+                }
+              chunk_info ci{get_allocator()};
+              bool is_analysed{true};
+              {
+              // Another thread may be lazily analysing other's chunks.
+                std::unique_lock<std::mutex> lock{other.analysis_mutex, std::defer_lock};
+                if (other.options.lazy_analysis)
+                  {
+                    lock.lock();
+                    is_analysed = other.stored_analysed[other_stored];
+                  }
+                if (movable)
+                  {
+                    ci = std::move((*movable)[other_stored]);
+                  }
+                else
+                  {
+                    ci = chunk_info{source, get_allocator()};
+                  }
+              }
+              if (compress)
+                {
+                  ci.compressed_chunk.swap(recoded);
+                  string_type{ci.chunk.get_allocator()}.swap(ci.chunk);
+                }
+              else if (expand)
+                {
+                  ci.chunk.swap(recoded);
+                  string_type{ci.compressed_chunk.get_allocator()}
+                                                  .swap(ci.compressed_chunk);
+                }
+              store_chunk(std::move(ci), is_analysed);
+            }
+          add_stored_chunk(stored);
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    typename basic_text_info<Counters, Allocator, Tables, Tokenizer>::stored_index_type
+    basic_text_info<Counters, Allocator, Tables, Tokenizer>::find_duplicate
+    ( std::string const & text
+    , std::uint64_t fingerprint
+    ) const
+    {
+      auto candidates(fingerprints.equal_range(fingerprint));
+      for (auto pos(candidates.first); pos!=candidates.second; ++pos)
+        {
+          auto const & ci(text_data[pos->second]);
+          if (ci.char_count==text.size())
+            {
+              if (ci.compressed_chunk.empty()
+                    ? text.compare(0U, text.size(), ci.chunk.data(), ci.chunk.size())==0
+                    : expand_chunk_text(pos->second, false)==text
+                 )
+                {
+                  return pos->second;
+                }
+            }
+        }
+      return text_data.size();
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::add_analysis
+    ( typename chunk_vector::size_type chunk_index
+    )
+    {
+      auto const & ci(stored_chunk(chunk_index));
+      word_counts[chunk_index] = ci.word_count;
+      word_total += ci.word_count;
+      for (auto const & occ : ci.char_occ_map)
+        {
+          if (!char_columns.empty())
+            {
+              char_columns[static_cast<unsigned char>(occ.first)][chunk_index]
+                                                                  = occ.second;
+            }
+          if (!char_totals.empty())
+            {
+              char_totals[static_cast<unsigned char>(occ.first)] += occ.second;
+            }
+        }
+      if (options.occurrence_totals)
+        {
+          for (auto const & occ : ci.word_occ_map)
+            {
+              word_totals[occ.first] += occ.second;
+            }
+        }
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    void basic_text_info<Counters, Allocator, Tables, Tokenizer>::analyse_chunk
+    ( typename chunk_vector::size_type chunk_index
+    ) const
+    {
+      if (!options.lazy_analysis)
+        {
+          return;
+        }
+      std::call_once( analysed[chunk_index]
+                    , [this, chunk_index]()
+                      {
+                      // Analysis completes the object's logical state so is
+                      // performed on behalf of const queries.
+                        auto self(const_cast<basic_text_info *>(this));
+                        auto stored(stored_index(chunk_index));
+                        auto & ci(self->text_data[stored]);
+                        std::lock_guard<std::mutex> lock{analysis_mutex};
+                        if (!stored_analysed[stored])
+                          {
+                            if (ci.compressed_chunk.empty())
+                              {
+                                ci.analyse( ci.chunk.data(), ci.chunk.size()
+                                          , text_data.get_allocator()
+                                          , options.parallel_analysis_threshold
+                                          );
+                              }
+                            else
+                              {
+                                auto expanded(expand_chunk_text(stored, false));
+                                ci.analyse( expanded.data(), expanded.size()
+                                          , text_data.get_allocator()
+                                          , options.parallel_analysis_threshold
+                                          );
+                              }
+                            stored_analysed[stored] = true;
+                          }
+                        self->add_analysis(chunk_index);
+                      }
+                    );
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    std::string basic_text_info<Counters, Allocator, Tables, Tokenizer>::expand_chunk_text
+    ( typename chunk_vector::size_type chunk_index
+    , bool add_to_cache
+    ) const
+    {
+      std::string txt;
+      if (text_cache && text_cache->find(chunk_index, txt))
+        {
+          return txt;
+        }
+      auto const & ci(text_data[chunk_index]);
+      txt = lz_decompress( ci.compressed_chunk.data(), ci.compressed_chunk.size()
+                         , ci.char_count
+                         );
+      if (text_cache && add_to_cache)
+        {
+          text_cache->insert(chunk_index, txt);
+        }
+      return txt;
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    std::uint64_t basic_text_info<Counters, Allocator, Tables, Tokenizer>::stored_text_size() const
+    {
+      std::uint64_t size{0U};
+      for (auto const & ci : text_data)
+        {
+          size += ci.chunk.size() + ci.compressed_chunk.size();
+        }
+      return size;
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    std::string basic_text_info<Counters, Allocator, Tables, Tokenizer>::text() const
+    {
+      std::string txt;
+      txt.reserve(char_count());
+      for (chunk_index_type i{0U}; i!=number_of_chunks(); ++i)
+        {
+          auto const & ci(stored_chunk(i));
+          if (ci.compressed_chunk.empty())
+            {
+              txt.append(ci.chunk.data(), ci.chunk.size());
+            }
+          else
+            {
+              txt += expand_chunk_text(stored_index(i), false);
+            }
+        }
+      return txt;
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    typename basic_text_info<Counters, Allocator, Tables, Tokenizer>::stats_type
+    basic_text_info<Counters, Allocator, Tables, Tokenizer>::stats
+    ( text_stats_query const & query
+    ) const
+    {
+      analyse_chunks(0U, number_of_chunks());
+      stats_type result;
+      result.number_of_chunks = number_of_chunks();
+      result.char_count = char_total;
+      result.word_count = word_total;
+      result.char_occurrences.assign(query.chars.size(), 0U);
+      result.word_occurrences.assign(query.words.size(), 0U);
+      std::vector<word_key_type> keys;
+      keys.reserve(query.words.size());
+      for (auto const & word : query.words)
+        {
+          keys.push_back(word_key(word));
+        }
+      std::vector<char> chars(query.chars);
+      if (!char_totals.empty())
+        {
+          for (std::size_t c{0U}; c!=chars.size(); ++c)
+            {
+              result.char_occurrences[c] = char_occurrence(chars[c]);
+            }
+          chars.clear();
+        }
+      if (options.occurrence_totals)
+        {
+          for (std::size_t w{0U}; w!=keys.size(); ++w)
+            {
+              result.word_occurrences[w] = lookup_occurrence(word_totals, keys[w]);
+            }
+          keys.clear();
+        }
+      if (chars.empty() && keys.empty() && !query.include_text)
+        {
+          return result;
+        }
+      if (!query.include_text)
+        { // Character then word occurrences, reduced in parallel if large
+          typedef std::vector<total_size_type> occurrences;
+          auto sums(reduce_chunks
+                    ( 0U, number_of_chunks()
+                    , occurrences(chars.size()+keys.size(), 0U)
+                    , [this, &chars, &keys]( chunk_index_type first
+                                           , chunk_count_type count
+                                           )
+                      {
+                        occurrences partial(chars.size()+keys.size(), 0U);
+                        for (auto i(first); i!=first+count; ++i)
+                          {
+                            auto const & ci(stored_chunk(i));
+                            for (std::size_t c{0U}; c!=chars.size(); ++c)
+                              {
+                                partial[c]
+                                  += char_columns.empty()
+                                      ? lookup_occurrence(ci.char_occ_map, chars[c])
+                                      : char_columns[static_cast<unsigned char>(chars[c])][i];
+                              }
+                            for (std::size_t w{0U}; w!=keys.size(); ++w)
+                              {
+                                partial[chars.size()+w]
+                                  += lookup_occurrence(ci.word_occ_map, keys[w]);
+                              }
+                          }
+                        return partial;
+                      }
+                    , [](occurrences lhs, occurrences const & rhs)
+                      {
+                        for (std::size_t o{0U}; o!=lhs.size(); ++o)
+                          {
+                            lhs[o] += rhs[o];
+                          }
+                        return lhs;
+                      }
+                    ));
+          for (std::size_t c{0U}; c!=chars.size(); ++c)
+            {
+              result.char_occurrences[c] += sums[c];
+            }
+          for (std::size_t w{0U}; w!=keys.size(); ++w)
+            {
+              result.word_occurrences[w] += sums[chars.size()+w];
+            }
+          return result;
+        }
+      result.text.reserve(char_total);
+      for (chunk_index_type i{0U}; i!=number_of_chunks(); ++i)
+        {
+          auto const & ci(stored_chunk(i));
+          for (std::size_t c{0U}; c!=chars.size(); ++c)
+            {
+              result.char_occurrences[c]
+                    += char_columns.empty()
+                        ? lookup_occurrence(ci.char_occ_map, chars[c])
+                        : char_columns[static_cast<unsigned char>(chars[c])][i];
+            }
+          for (std::size_t w{0U}; w!=keys.size(); ++w)
+            {
+              result.word_occurrences[w]
+                                  += lookup_occurrence(ci.word_occ_map, keys[w]);
+            }
+          if (ci.compressed_chunk.empty())
+            {
+              result.text.append(ci.chunk.data(), ci.chunk.size());
+            }
+          else
+            {
+              result.text += expand_chunk_text(stored_index(i), false);
+            }
+        }
+      return result;
+    }
+
+    template <class Counters, class Allocator, class Tables, class Tokenizer>
+    std::uint64_t basic_text_info<Counters, Allocator, Tables, Tokenizer>::write_chunks_text
+    ( int fd
+    , chunk_index_type first
+    , chunk_count_type count
+    ) const
+    {
+      check_range(first, count, "text_info::write_chunks_text: chunk range");
+    // Chunks are written in batches so that the memory used for the regions
+    // and the decompressed text of compressed chunks is bounded.
+      chunk_count_type const max_batch_chunks{1024U};
+      std::size_t const max_batch_text{1U<<20U};
+      std::vector<iovec> iov;
+      iov.reserve(std::min(count, max_batch_chunks));
+      std::string expanded; // text of batch's compressed chunks
+      std::uint64_t written{0U};
+      auto write_batch([&]()
+                       {
+                         written += gather_write(fd, iov.data(), iov.size());
+                         iov.clear();
+                         expanded.clear();
+                       }
+                      );
+      for (chunk_count_type i{0U}; i!=count; ++i)
+        {
+          auto const & ci(stored_chunk(first+i));
+          iovec region;
+          if (ci.compressed_chunk.empty())
+            {
+              region.iov_base = const_cast<char *>(ci.chunk.data());
+              region.iov_len = ci.chunk.size();
+            }
+          else
+            {
+            // Regions point into expanded, so it must not be reallocated
+            // while the batch holds any.
+              if (expanded.size()+ci.char_count>expanded.capacity())
+                {
+                  if (!expanded.empty())
+                    {
+                      write_batch();
+                    }
+                  expanded.reserve(std::max<std::size_t>( max_batch_text
+                                                        , ci.char_count
+                                                        ));
+                }
+              auto offset(expanded.size());
+              lz_decompress( ci.compressed_chunk.data()
+                           , ci.compressed_chunk.size(), ci.char_count
+                           , expanded
+                           );
+              region.iov_base = const_cast<char *>(expanded.data()+offset);
+              region.iov_len = ci.char_count;
+            }
+          iov.push_back(region);
+          if (iov.size()==max_batch_chunks)
+            {
+              write_batch();
+            }
+        }
+      if (!iov.empty())
+        {
+          write_batch();
+        }
+      return written;
+    }
+
+  /// @brief Returns indexes of chunks whose fingerprints differ between two
+  /// objects, each having number_of_chunks and chunk_fingerprint operations,
+  /// such as text_info or text_registry objects.
+  /// @param lhs    First object compared.
+  /// @param rhs    Second object compared.
+  /// @returns Ascending indexes of chunks with different fingerprints,
+  ///          including those of chunks only one object has.
+    template <class LhsTextInfo, class RhsTextInfo>
+    std::vector<std::uint64_t> differing_chunks
+    ( LhsTextInfo const & lhs
+    , RhsTextInfo const & rhs
+    )
+    {
+      std::uint64_t lhs_chunks{lhs.number_of_chunks()};
+      std::uint64_t rhs_chunks{rhs.number_of_chunks()};
+      std::vector<std::uint64_t> differing;
+      for (std::uint64_t i{0U}; i!=std::min(lhs_chunks, rhs_chunks); ++i)
+        {
+          if (lhs.chunk_fingerprint(i)!=rhs.chunk_fingerprint(i))
+            {
+              differing.push_back(i);
+            }
+        }
+      for (auto i(std::min(lhs_chunks, rhs_chunks)); i!=std::max(lhs_chunks, rhs_chunks); ++i)
+        {
+          differing.push_back(i);
+        }
+      return differing;
+    }
+
+  /// @brief Text information type using default counter widths.
+    typedef basic_text_info<default_counter_widths> text_info;
   } // namespace sies
 }} // namespaces dibase::blog
 #endif // DIBASE_BLOG_SIES_TEXT_INFO_H
@@ -0,0 +1,576 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file text_kernels.cpp
+/// @brief Text processing kernels selected at run time for the host CPU.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// Word separators are those of separator_word_chars (see tokenizers.h).
+/// Vector variants classify 16, 32 or 64 bytes at a time as separators or
+/// not using two 16 entry nibble lookup tables: each separator's high and
+/// low nibble entries share a set bit, so a byte is a separator if the
+/// entries for its nibbles have a set bit in common. Character counting does
+/// not vectorise; the vector variants use four interleaved count tables to
+/// avoid the store to load dependencies of runs of equal characters.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "text_kernels.h"
+#include "tokenizers.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+# define DIBASE_BLOG_SIES_X86_KERNELS
+# include <immintrin.h>
+#endif
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    char const * const TextKernelsEnvVar{"SIES_TEXT_KERNELS"};
+
+    namespace
+    {
+    /// @brief Returns true if chr separates words: compile time table lookup.
+      inline bool is_separator(unsigned char chr)
+      {
+        return !char_class::table<separator_word_chars>::is_word_char[chr];
+      }
+
+    /// @brief Separator nibble classification tables built from the
+    /// separator_word_chars table. The 16 entry nibble tables are repeated
+    /// to fill 64 bytes so they can be loaded directly into vector registers
+    /// of any width.
+      struct separator_tables
+      {
+        unsigned char low_nibble_bits[64];
+        unsigned char high_nibble_bits[64];
+
+        separator_tables()
+        {
+          std::memset(this, 0, sizeof(*this));
+        // Each distinct set of separator low nibbles among the high nibbles
+        // gets its own bit.
+          std::vector<unsigned> low_sets;
+          for (unsigned high{0U}; high!=16U; ++high)
+            {
+              unsigned lows{0U};
+              for (unsigned low{0U}; low!=16U; ++low)
+                {
+                  lows |= is_separator(high*16U+low) ? 1U<<low : 0U;
+                }
+              if (lows==0U)
+                {
+                  continue;
+                }
+              unsigned bit{0U};
+              while (bit!=low_sets.size() && low_sets[bit]!=lows)
+                {
+                  ++bit;
+                }
+              if (bit==low_sets.size())
+                {
+                  if (bit==8U)
+                    {
+                      throw std::logic_error{"Too many separator classes."};
+                    }
+                  low_sets.push_back(lows);
+                }
+              high_nibble_bits[high] |= 1U<<bit;
+              for (unsigned low{0U}; low!=16U; ++low)
+                {
+                  low_nibble_bits[low] |= (lows>>low & 1U) << bit;
+                }
+            }
+          for (unsigned i{16U}; i!=64U; ++i)
+            {
+              low_nibble_bits[i] = low_nibble_bits[i%16U];
+              high_nibble_bits[i] = high_nibble_bits[i%16U];
+            }
+        }
+      };
+
+      separator_tables const & separators()
+      {
+        static separator_tables const tables;
+        return tables;
+      }
+
+      std::size_t scalar_find
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      , bool separator
+      )
+      {
+        while (pos<size && is_separator(static_cast<unsigned char>(text[pos]))==separator)
+          {
+            ++pos;
+          }
+        return pos;
+      }
+
+      std::size_t scalar_find_word_start
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return scalar_find(text, size, pos, true);
+      }
+
+      std::size_t scalar_find_word_end
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return scalar_find(text, size, pos, false);
+      }
+
+      void scalar_tolower(char * text, std::size_t size)
+      {
+        for (auto p=text; p!=text+size; ++p)
+          {
+            if ('A'<=*p && *p<='Z')
+              {
+                *p += 'a'-'A';
+              }
+          }
+      }
+
+      void scalar_count_chars
+      ( char const * text
+      , std::size_t size
+      , std::uint64_t * counts
+      )
+      {
+        auto first(reinterpret_cast<unsigned char const *>(text));
+        for (auto p=first; p!=first+size; ++p)
+          {
+            ++counts[*p];
+          }
+      }
+
+    /// @brief Texts shorter than this are counted by scalar_count_chars.
+      std::size_t const InterleavedCountMinSize{1024U};
+
+    /// @brief Bytes counted in 32 bit interleaved counts between flushes.
+      std::size_t const InterleavedCountBlockSize{std::size_t{1U}<<30U};
+
+      void interleaved_count_chars
+      ( char const * text
+      , std::size_t size
+      , std::uint64_t * counts
+      )
+      {
+        if (size<InterleavedCountMinSize)
+          {
+            scalar_count_chars(text, size, counts);
+            return;
+          }
+        auto p(reinterpret_cast<unsigned char const *>(text));
+        auto last(p+size);
+        std::uint32_t part[4][NumberOfCharCounts];
+        while (p!=last)
+          {
+            std::memset(part, 0, sizeof(part));
+            auto block_size(std::min<std::size_t>(last-p, InterleavedCountBlockSize));
+            auto block_end(p+block_size);
+            for (; block_end-p>=4; p+=4)
+              {
+                ++part[0][p[0]];
+                ++part[1][p[1]];
+                ++part[2][p[2]];
+                ++part[3][p[3]];
+              }
+            for (; p!=block_end; ++p)
+              {
+                ++part[0][*p];
+              }
+            for (std::size_t c{0U}; c!=NumberOfCharCounts; ++c)
+              {
+                counts[c] += std::uint64_t{part[0][c]} + part[1][c]
+                           + part[2][c] + part[3][c];
+              }
+          }
+      }
+
+#if defined(DIBASE_BLOG_SIES_X86_KERNELS)
+      __attribute__((target("sse4.2")))
+      inline unsigned sse42_separator_bits
+      ( char const * text
+      , __m128i low_table
+      , __m128i high_table
+      )
+      {
+        auto const nibble(_mm_set1_epi8(0x0f));
+        auto v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(text)));
+        auto lo(_mm_and_si128(v, nibble));
+        auto hi(_mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        auto bits(_mm_and_si128( _mm_shuffle_epi8(low_table, lo)
+                               , _mm_shuffle_epi8(high_table, hi)
+                               ));
+        return ~static_cast<unsigned>
+                  (_mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128())))
+               & 0xffffU;
+      }
+
+      __attribute__((target("sse4.2")))
+      std::size_t sse42_find
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      , bool separator
+      )
+      {
+        auto const & t(separators());
+        auto const low_table(_mm_loadu_si128
+                      (reinterpret_cast<__m128i const *>(t.low_nibble_bits)));
+        auto const high_table(_mm_loadu_si128
+                      (reinterpret_cast<__m128i const *>(t.high_nibble_bits)));
+        for (; size-pos>=16U; pos+=16U)
+          {
+            auto bits(sse42_separator_bits(text+pos, low_table, high_table));
+            bits = (separator ? ~bits : bits) & 0xffffU;
+            if (bits!=0U)
+              {
+                return pos + __builtin_ctz(bits);
+              }
+          }
+        return scalar_find(text, size, pos, separator);
+      }
+
+      __attribute__((target("sse4.2")))
+      std::size_t sse42_find_word_start
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return pos>=size ? pos : sse42_find(text, size, pos, true);
+      }
+
+      __attribute__((target("sse4.2")))
+      std::size_t sse42_find_word_end
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return pos>=size ? pos : sse42_find(text, size, pos, false);
+      }
+
+      __attribute__((target("sse4.2")))
+      void sse42_tolower(char * text, std::size_t size)
+      {
+        auto const before_a(_mm_set1_epi8('A'-1));
+        auto const after_z(_mm_set1_epi8('Z'+1));
+        auto const difference(_mm_set1_epi8('a'-'A'));
+        std::size_t pos{0U};
+        for (; size-pos>=16U; pos+=16U)
+          {
+            auto p(reinterpret_cast<__m128i *>(text+pos));
+            auto v(_mm_loadu_si128(p));
+            auto upper(_mm_and_si128( _mm_cmpgt_epi8(v, before_a)
+                                    , _mm_cmpgt_epi8(after_z, v)
+                                    ));
+            _mm_storeu_si128(p, _mm_add_epi8(v, _mm_and_si128(upper, difference)));
+          }
+        scalar_tolower(text+pos, size-pos);
+      }
+
+      __attribute__((target("avx2")))
+      inline std::uint32_t avx2_separator_bits
+      ( char const * text
+      , __m256i low_table
+      , __m256i high_table
+      )
+      {
+        auto const nibble(_mm256_set1_epi8(0x0f));
+        auto v(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(text)));
+        auto lo(_mm256_and_si256(v, nibble));
+        auto hi(_mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        auto bits(_mm256_and_si256( _mm256_shuffle_epi8(low_table, lo)
+                                  , _mm256_shuffle_epi8(high_table, hi)
+                                  ));
+        return ~static_cast<std::uint32_t>(_mm256_movemask_epi8
+                          (_mm256_cmpeq_epi8(bits, _mm256_setzero_si256())));
+      }
+
+      __attribute__((target("avx2")))
+      std::size_t avx2_find
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      , bool separator
+      )
+      {
+        auto const & t(separators());
+        auto const low_table(_mm256_loadu_si256
+                      (reinterpret_cast<__m256i const *>(t.low_nibble_bits)));
+        auto const high_table(_mm256_loadu_si256
+                      (reinterpret_cast<__m256i const *>(t.high_nibble_bits)));
+        for (; size-pos>=32U; pos+=32U)
+          {
+            auto bits(avx2_separator_bits(text+pos, low_table, high_table));
+            bits = separator ? ~bits : bits;
+            if (bits!=0U)
+              {
+                return pos + __builtin_ctz(bits);
+              }
+          }
+        return scalar_find(text, size, pos, separator);
+      }
+
+      __attribute__((target("avx2")))
+      std::size_t avx2_find_word_start
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return pos>=size ? pos : avx2_find(text, size, pos, true);
+      }
+
+      __attribute__((target("avx2")))
+      std::size_t avx2_find_word_end
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return pos>=size ? pos : avx2_find(text, size, pos, false);
+      }
+
+      __attribute__((target("avx2")))
+      void avx2_tolower(char * text, std::size_t size)
+      {
+        auto const before_a(_mm256_set1_epi8('A'-1));
+        auto const after_z(_mm256_set1_epi8('Z'+1));
+        auto const difference(_mm256_set1_epi8('a'-'A'));
+        std::size_t pos{0U};
+        for (; size-pos>=32U; pos+=32U)
+          {
+            auto p(reinterpret_cast<__m256i *>(text+pos));
+            auto v(_mm256_loadu_si256(p));
+            auto upper(_mm256_and_si256( _mm256_cmpgt_epi8(v, before_a)
+                                       , _mm256_cmpgt_epi8(after_z, v)
+                                       ));
+            _mm256_storeu_si256
+                      (p, _mm256_add_epi8(v, _mm256_and_si256(upper, difference)));
+          }
+        scalar_tolower(text+pos, size-pos);
+      }
+
+      __attribute__((target("avx512f,avx512bw")))
+      inline std::uint64_t avx512_separator_bits
+      ( char const * text
+      , __m512i low_table
+      , __m512i high_table
+      )
+      {
+        auto const nibble(_mm512_set1_epi8(0x0f));
+        auto v(_mm512_loadu_si512(text));
+        auto lo(_mm512_and_si512(v, nibble));
+        auto hi(_mm512_and_si512(_mm512_srli_epi16(v, 4), nibble));
+        return _mm512_test_epi8_mask( _mm512_shuffle_epi8(low_table, lo)
+                                    , _mm512_shuffle_epi8(high_table, hi)
+                                    );
+      }
+
+      __attribute__((target("avx512f,avx512bw")))
+      std::size_t avx512_find
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      , bool separator
+      )
+      {
+        auto const & t(separators());
+        auto const low_table(_mm512_loadu_si512(t.low_nibble_bits));
+        auto const high_table(_mm512_loadu_si512(t.high_nibble_bits));
+        for (; size-pos>=64U; pos+=64U)
+          {
+            auto bits(avx512_separator_bits(text+pos, low_table, high_table));
+            bits = separator ? ~bits : bits;
+            if (bits!=0U)
+              {
+                return pos + __builtin_ctzll(bits);
+              }
+          }
+        return scalar_find(text, size, pos, separator);
+      }
+
+      __attribute__((target("avx512f,avx512bw")))
+      std::size_t avx512_find_word_start
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return pos>=size ? pos : avx512_find(text, size, pos, true);
+      }
+
+      __attribute__((target("avx512f,avx512bw")))
+      std::size_t avx512_find_word_end
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return pos>=size ? pos : avx512_find(text, size, pos, false);
+      }
+
+      __attribute__((target("avx512f,avx512bw")))
+      void avx512_tolower(char * text, std::size_t size)
+      {
+        auto const before_a(_mm512_set1_epi8('A'-1));
+        auto const after_z(_mm512_set1_epi8('Z'+1));
+        auto const difference(_mm512_set1_epi8('a'-'A'));
+        std::size_t pos{0U};
+        for (; size-pos>=64U; pos+=64U)
+          {
+            auto v(_mm512_loadu_si512(text+pos));
+            auto upper( _mm512_cmpgt_epi8_mask(v, before_a)
+                      & _mm512_cmpgt_epi8_mask(after_z, v)
+                      );
+            _mm512_storeu_si512
+                      (text+pos, _mm512_mask_add_epi8(v, upper, v, difference));
+          }
+        scalar_tolower(text+pos, size-pos);
+      }
+#endif // DIBASE_BLOG_SIES_X86_KERNELS
+
+      text_kernels const Variants[] =
+      { { text_kernel_isa::scalar
+        , scalar_find_word_start, scalar_find_word_end
+        , scalar_tolower, scalar_count_chars
+        }
+#if defined(DIBASE_BLOG_SIES_X86_KERNELS)
+      , { text_kernel_isa::sse42
+        , sse42_find_word_start, sse42_find_word_end
+        , sse42_tolower, interleaved_count_chars
+        }
+      , { text_kernel_isa::avx2
+        , avx2_find_word_start, avx2_find_word_end
+        , avx2_tolower, interleaved_count_chars
+        }
+      , { text_kernel_isa::avx512
+        , avx512_find_word_start, avx512_find_word_end
+        , avx512_tolower, interleaved_count_chars
+        }
+#endif
+      };
+
+      text_kernel_isa const AllVariants[] = { text_kernel_isa::scalar
+                                            , text_kernel_isa::sse42
+                                            , text_kernel_isa::avx2
+                                            , text_kernel_isa::avx512
+                                            };
+
+      text_kernels const & select_kernels()
+      {
+        auto forced(std::getenv(TextKernelsEnvVar));
+        if (forced!=nullptr && *forced!='\0')
+          {
+            return text_kernels_named(forced);
+          }
+        auto best(text_kernel_isa::scalar);
+        for (auto isa : AllVariants)
+          {
+            if (text_kernel_isa_supported(isa))
+              {
+                best = isa;
+              }
+          }
+        return text_kernels_for(best);
+      }
+    } // namespace
+
+    char const * to_string(text_kernel_isa isa)
+    {
+      switch (isa)
+        {
+        case text_kernel_isa::scalar: return "scalar";
+        case text_kernel_isa::sse42:  return "sse4.2";
+        case text_kernel_isa::avx2:   return "avx2";
+        case text_kernel_isa::avx512: return "avx512";
+        }
+      return "unknown";
+    }
+
+    bool text_kernel_isa_supported(text_kernel_isa isa)
+    {
+#if defined(DIBASE_BLOG_SIES_X86_KERNELS)
+      __builtin_cpu_init();
+      switch (isa)
+        {
+        case text_kernel_isa::scalar:
+          return true;
+        case text_kernel_isa::sse42:
+          return __builtin_cpu_supports("sse4.2");
+        case text_kernel_isa::avx2:
+          return __builtin_cpu_supports("avx2");
+        case text_kernel_isa::avx512:
+          return __builtin_cpu_supports("avx512f")
+              && __builtin_cpu_supports("avx512bw");
+        }
+      return false;
+#else
+      return isa==text_kernel_isa::scalar;
+#endif
+    }
+
+    text_kernels const & text_kernels_for(text_kernel_isa isa)
+    {
+      if (!text_kernel_isa_supported(isa))
+        {
+          throw std::invalid_argument{ std::string{"Text kernel variant "}
+                                     + to_string(isa) + " not supported."
+                                     };
+        }
+      for (auto const & k : Variants)
+        {
+          if (k.isa==isa)
+            {
+              return k;
+            }
+        }
+      throw std::invalid_argument{"Text kernel variant unknown."};
+    }
+
+    text_kernels const & text_kernels_named(char const * name)
+    {
+      for (auto isa : AllVariants)
+        {
+          if (std::strcmp(name, to_string(isa))==0)
+            {
+              return text_kernels_for(isa);
+            }
+        }
+      throw std::invalid_argument{ std::string{"Text kernel variant "}
+                                 + name + " unknown."
+                                 };
+    }
+
+    text_kernels const & active_text_kernels()
+    {
+      static text_kernels const & active(select_kernels());
+      return active;
+    }
+
+    bool is_word_separator(char chr)
+    {
+      return is_separator(static_cast<unsigned char>(chr));
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
@@ -0,0 +1,96 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file text_kernels.h
+/// @brief Text processing kernels selected at run time for the host CPU.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// The library's inner text loops - finding word boundaries, lowercasing and
+/// counting characters - are provided in scalar, SSE4.2, AVX2 and AVX-512
+/// variants. On first use the most capable variant the host CPU supports is
+/// selected, unless the environment variable named by TextKernelsEnvVar
+/// names a (supported) variant - one of scalar, sse4.2, avx2 or avx512 - in
+/// which case that variant is used. All variants produce identical results.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_TEXT_KERNELS_H
+# define DIBASE_BLOG_SIES_TEXT_KERNELS_H
+# include <cstddef>
+# include <cstdint>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Instruction set variants of the text kernels.
+    enum class text_kernel_isa
+    { scalar
+    , sse42
+    , avx2
+    , avx512
+    };
+
+  /// @brief Returns name of a text kernel variant, as used in the
+  /// environment variable named by TextKernelsEnvVar.
+    char const * to_string(text_kernel_isa isa);
+
+  /// @brief Name of environment variable that may force a kernel variant.
+    extern char const * const TextKernelsEnvVar;
+
+  /// @brief Number of entries in a count_chars counts array.
+    std::size_t const NumberOfCharCounts{256U};
+
+  /// @brief Set of text kernel functions of one instruction set variant.
+    struct text_kernels
+    {
+      text_kernel_isa isa;
+
+    /// @brief Returns position of first non-separator character at or after
+    /// pos in text, or size if none.
+      std::size_t (*find_word_start)
+                      (char const * text, std::size_t size, std::size_t pos);
+
+    /// @brief Returns position of first separator character at or after pos
+    /// in text, or size if none.
+      std::size_t (*find_word_end)
+                      (char const * text, std::size_t size, std::size_t pos);
+
+    /// @brief Replaces [A-Z] with [a-z] in place.
+      void (*tolower)(char * text, std::size_t size);
+
+    /// @brief Adds the number of occurrences of each char value in text to
+    /// counts, an array of NumberOfCharCounts counts indexed by char value
+    /// as an unsigned char.
+      void (*count_chars)
+                  (char const * text, std::size_t size, std::uint64_t * counts);
+    };
+
+  /// @brief Returns true if a text kernel variant is supported by the host.
+    bool text_kernel_isa_supported(text_kernel_isa isa);
+
+  /// @brief Returns kernels of a specific variant.
+  /// @throws std::invalid_argument if the variant is not supported by the host.
+    text_kernels const & text_kernels_for(text_kernel_isa isa);
+
+  /// @brief Returns kernels of the variant named name, as by to_string.
+  /// @throws std::invalid_argument if no variant is called name or the
+  ///         variant is not supported by the host.
+    text_kernels const & text_kernels_named(char const * name);
+
+  /// @brief Returns the kernels selected for use by the library: those
+  /// named by the environment variable named by TextKernelsEnvVar if set
+  /// and not empty, otherwise the most capable supported variant.
+  /// @throws std::invalid_argument if the environment variable names an
+  ///         unknown or unsupported variant.
+    text_kernels const & active_text_kernels();
+
+  /// @brief Returns true if chr separates words.
+  ///
+  /// Separators are the characters of WordSeparatorChars (see tokenizers.h)
+  /// as UTF-8 bytes, so the bytes 0xC2, 0xA3 and 0xAC also separate words.
+    bool is_word_separator(char chr);
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_TEXT_KERNELS_H
@@ -17,6 +17,11 @@
 # define DIBASE_BLOG_SIES_TEXT_REGISRTY_H
 # include "call_context_validator.h"
 # include "text_info.h"
+# include "frozen_text_image.h"
+# include "chunk_staging.h"
+# include <memory>
+# include <vector>
+# include <stdexcept>
 # include <atomic>
 
 namespace dibase { namespace blog {
@@ -31,47 +36,109 @@ namespace dibase { namespace blog {
   /// call (thread) context as well as a setup_complete operation that stores
   /// some cached calculated values and then 'publishes' the object.
   ///
+  /// If the text_info_options passed on construction request compaction,
+  /// setup_complete also relocates all data into one contiguous read-only
+  /// text image (a frozen_text_image), releasing the text_info's chunks, and
+  /// all queries are then answered from the image.
+  ///
+  /// Chunks may also be supplied by other producer threads through staging
+  /// handles opened by the creator thread. Staged chunks are added, in
+  /// sequence number order, after any directly added chunks when setup
+  /// completes, so only the creator thread ever mutates the text_info.
+  ///
+  /// @param TextInfo   basic_text_info specialisation wrapped, determining the
+  ///                   counter widths and allocator used.
   /// @param SyncPolicy Atomic synchronisation policy type template
   ///                   (e.g.non_atomic, atomic)
   /// @param M          0+ (typically 0, 1 or 2) std::memory_oder values
   ///                   passed to the SyncPolicy template type.
     template 
-    < template <class T, std::memory_order...> class SyncPolicy
+    < class TextInfo
+    , template <class T, std::memory_order...> class SyncPolicy
     , std::memory_order... M
     >
-    class text_registry
+    class basic_text_registry
     {
-      call_context_validator<SyncPolicy, text_registry, M...>
-                  validate_usage;
-      text_info   data;
+    public:
+      typedef TextInfo                                  text_info_type;
+      typedef typename text_info_type::allocator_type   allocator_type;
+
+    private:
+      call_context_validator<SyncPolicy, basic_text_registry, M...>
+                      validate_usage;
+      text_info_type  data;
+      chunk_staging   staging;
       
     public:
-      typedef text_info::chunk_size_type      chunk_size_type;
-      typedef text_info::chunk_count_type     chunk_count_type;
-      typedef text_info::chunk_index_type     chunk_index_type;
+      typedef typename text_info_type::chunk_size_type  chunk_size_type;
+      typedef typename text_info_type::total_size_type  total_size_type;
+      typedef typename text_info_type::chunk_count_type chunk_count_type;
+      typedef typename text_info_type::chunk_index_type chunk_index_type;
+      typedef typename text_info_type::stats_type       stats_type;
+      typedef chunk_staging::handle                     staging_handle;
 
   private:
   // Cached data values - only valid once object setup complete
-      chunk_size_type  final_char_count;
-      chunk_size_type  final_word_count;
+      total_size_type  final_char_count;
+      total_size_type  final_word_count;
+      std::uint64_t    final_digest;
+      std::vector<std::uint64_t> compacted_fingerprints; ///< If compacted.
+      std::unique_ptr<frozen_text_image> compacted;
 
   public:
-      text_registry() = default;
-      text_registry(text_registry const &) = delete;
-      text_registry & operator=(text_registry const &) = delete;
-      text_registry(text_registry &&) = delete;
-      text_registry & operator=(text_registry &&) = delete;
+      basic_text_registry() = default;
+
+    /// @brief Construct with default text_info options using an allocator.
+    /// @param alloc      Allocator passed to the wrapped text_info.
+      explicit basic_text_registry(allocator_type const & alloc)
+      : data{alloc}
+      {}
+
+    /// @brief Construct with specified text_info storage options.
+    /// @param options    Storage options passed to the wrapped text_info.
+    /// @param alloc      Allocator passed to the wrapped text_info.
+      explicit basic_text_registry
+      ( text_info_options const & options
+      , allocator_type const & alloc = allocator_type()
+      )
+      : data{options, alloc}
+      {}
+
+      basic_text_registry(basic_text_registry const &) = delete;
+      basic_text_registry & operator=(basic_text_registry const &) = delete;
+      basic_text_registry(basic_text_registry &&) = delete;
+      basic_text_registry & operator=(basic_text_registry &&) = delete;
 
     /// @brief Called when all mutating calls setting up the object are done.
     /// Completing setup is considered a mutable operation as it publishes
     /// all updates and may perform final cached value calculating operations.
+    /// Chunks staged by producers are first added in sequence number order.
     /// @throws dibase::blog::sies::call_context_violation if called by
     ///         thread other than the creator thread or if the object
     ///         has completed its setup and has become immutable.
+    /// @throws std::logic_error if any staging handle is still open.
+    /// @throws std::invalid_argument if staged chunks share a sequence number.
       void setup_complete()
       {
+        validate_usage(this);
+        for (auto const & chunk : staging.take_ordered())
+          {
+            data.add_text_chunk(chunk.second);
+          }
         final_char_count = char_count(); // Set cached values then publish
         final_word_count = word_count();
+        final_digest = data.digest();
+        if (data.storage_options().compact_on_publish)
+          {
+            compacted_fingerprints.reserve(data.number_of_chunks());
+            for (chunk_index_type i{0U}; i!=data.number_of_chunks(); ++i)
+              {
+                compacted_fingerprints.push_back(data.chunk_fingerprint(i));
+              }
+            compacted.reset(new frozen_text_image
+                                { data, data.storage_options().compact_backing });
+            data.clear();
+          }
         validate_usage.publish(this);
       }
 
@@ -82,12 +149,53 @@ namespace dibase { namespace blog {
     /// @throws dibase::blog::sies::call_context_violation if called by
     ///         thread other than the creator thread or if the object
     ///         has completed its setup and has become immutable.
+    /// @throws dibase::blog::sies::chunk_too_large if text has more
+    ///         characters than chunk_size_type can count.
       void add_text_chunk(std::string const & text)
       {
         validate_usage(this);
         data.add_text_chunk(text);
       }
 
+    /// @brief Mutable operation. Append the chunks of a separately built
+    /// text_info, reusing its counts and occurrence tables.
+    /// See basic_text_info::append.
+    /// @param other  text_info whose chunks are appended.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread or if the object
+    ///         has completed its setup and has become immutable.
+      void append(text_info_type const & other)
+      {
+        validate_usage(this);
+        data.append(other);
+      }
+
+    /// @brief Mutable operation. Append the chunks of a separately built
+    /// text_info as append, moving its chunk data where possible.
+    /// @param other  text_info whose chunks are appended. It is cleared.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread or if the object
+    ///         has completed its setup and has become immutable.
+      void append(text_info_type && other)
+      {
+        validate_usage(this);
+        data.append(std::move(other));
+      }
+
+    /// @brief Mutable operation. Opens a handle through which another
+    /// producer thread may stage chunks to be added when setup completes.
+    /// The handle must be submitted or destroyed before setup_complete is
+    /// called.
+    /// @returns Open staging handle, which may be moved to a producer thread.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread or if the object
+    ///         has completed its setup and has become immutable.
+      staging_handle open_staging()
+      {
+        validate_usage(this);
+        return staging.open();
+      }
+
     /// @brief Immutable operation. Returns number of text chunks in object.
     /// @returns Number of entries in chunk sequence.
     /// @throws dibase::blog::sies::call_context_violation if called by
@@ -96,7 +204,8 @@ namespace dibase { namespace blog {
       chunk_count_type number_of_chunks() const 
       {
         validate_usage(this);
-        return data.number_of_chunks(); 
+        return compacted ? compacted->view().number_of_chunks()
+                         : data.number_of_chunks(); 
       }
 
     /// @brief Immutable operation. Returns text of a chunk.
@@ -110,7 +219,8 @@ namespace dibase { namespace blog {
       std::string  chunk_text(chunk_index_type chunk_index) const
       {
         validate_usage(this);
-        return data.chunk_text(chunk_index);
+        return compacted ? compacted->view().chunk_text(chunk_index)
+                         : data.chunk_text(chunk_index);
       }
 
     /// @brief Immutable operation. Returns number of characters in a chunk.
@@ -124,7 +234,9 @@ namespace dibase { namespace blog {
       chunk_size_type  chunk_char_count(chunk_index_type chunk_index) const
       {
         validate_usage(this);
-        return data.chunk_char_count(chunk_index);
+        return compacted ? static_cast<chunk_size_type>
+                              (compacted->view().chunk_char_count(chunk_index))
+                         : data.chunk_char_count(chunk_index);
       }
 
     /// @brief Immutable operation. Returns number of word in a chunk.
@@ -134,7 +246,9 @@ namespace dibase { namespace blog {
       chunk_size_type  chunk_word_count(chunk_index_type chunk_index) const
       {
         validate_usage(this);
-        return data.chunk_word_count(chunk_index);
+        return compacted ? static_cast<chunk_size_type>
+                              (compacted->view().chunk_word_count(chunk_index))
+                         : data.chunk_word_count(chunk_index);
       }
 
     /// @brief Immutable operation. Returns occurrence of a character in a chunk.
@@ -152,7 +266,11 @@ namespace dibase { namespace blog {
       ) const
       {
         validate_usage(this);
-        return data.chunk_char_occurrence(chunk_index,chr);
+        return compacted ? static_cast<chunk_size_type>
+                              ( compacted->view()
+                                  .chunk_char_occurrence(chunk_index,chr)
+                              )
+                         : data.chunk_char_occurrence(chunk_index,chr);
       }
 
     /// @brief Immutable operation. Returns occurrence of a word in a chunk.
@@ -171,7 +289,11 @@ namespace dibase { namespace blog {
       ) const
       {
         validate_usage(this);
-        return data.chunk_word_occurrence(chunk_index,word);
+        return compacted ? static_cast<chunk_size_type>
+                              ( compacted->view()
+                                  .chunk_word_occurrence(chunk_index,word)
+                              )
+                         : data.chunk_word_occurrence(chunk_index,word);
       }
 
     /// @brief Immutable operation. Returns concatenation of all chunks' text.
@@ -182,7 +304,110 @@ namespace dibase { namespace blog {
       std::string  text() const
       {
         validate_usage(this);
-        return data.text(); 
+        return compacted ? compacted->view().text()
+                         : data.text(); 
+      }
+
+    /// @brief Immutable operation. Writes text of a range of chunks to a file.
+    /// The text is written directly from the registry's storage using
+    /// scatter-gather writes - no concatenated copy is made.
+    /// @param fd           File descriptor, in blocking mode, to write to.
+    /// @param first        Index of first chunk to write.
+    /// @param count        Number of chunks to write.
+    /// @returns Number of bytes written.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+    /// @throws std::system_error if writing fails.
+      std::uint64_t write_chunks_text
+      ( int fd
+      , chunk_index_type first
+      , chunk_count_type count
+      ) const
+      {
+        validate_usage(this);
+        return compacted ? compacted->view().write_chunks_text(fd, first, count)
+                         : data.write_chunks_text(fd, first, count);
+      }
+
+    /// @brief Immutable operation. Writes text of all chunks to a file.
+    /// @param fd           File descriptor, in blocking mode, to write to.
+    /// @returns Number of bytes written.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+    /// @throws std::system_error if writing fails.
+      std::uint64_t write_text(int fd) const
+      {
+        validate_usage(this);
+        return compacted ? compacted->view().write_text(fd)
+                         : data.write_text(fd);
+      }
+
+    /// @brief Immutable operation. Returns the wrapped text_info object.
+    /// Intended for read-only processing of all the registry's data in bulk,
+    /// such as exporting it as a text image. A compacted registry no longer
+    /// has its text_info data: use compacted_image instead.
+    /// @returns Reference to the registry's text_info object.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+    /// @throws std::logic_error if the registry has been compacted.
+      text_info_type const & text_data() const
+      {
+        validate_usage(this);
+        if (compacted)
+          {
+            throw std::logic_error
+                    {"text_registry::text_data: registry compacted, "
+                     "use compacted_image"
+                    };
+          }
+        return data;
+      }
+
+    /// @brief Immutable operation. Returns the compacted image of the
+    /// registry's data.
+    /// @returns Pointer to the frozen image, nullptr if setup is not complete
+    ///          or compaction was not requested.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+      frozen_text_image const * compacted_image() const
+      {
+        validate_usage(this);
+        return compacted.get();
+      }
+
+    /// @brief Immutable operation. Returns a chunk's content fingerprint.
+    /// @param chunk_index  Index of chunk in sequence of chunks
+    /// @returns text_fingerprint of the chunk's text.
+    /// @throws std::out_of_range if chunk_index is greater or equal to the
+    ///         value returned by number_of_chunks.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+      std::uint64_t chunk_fingerprint(chunk_index_type chunk_index) const
+      {
+        validate_usage(this);
+        return compacted ? compacted_fingerprints.at(chunk_index)
+                         : data.chunk_fingerprint(chunk_index);
+      }
+
+    /// @brief Immutable operation. Returns digest of all chunks' text, as
+    /// text_info::digest. Comparing digests compares whole registries with
+    /// a single integer comparison: use differing_chunks to find chunks
+    /// that differ.
+    /// @returns Digest of every chunk's fingerprint in chunk order.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+      std::uint64_t digest() const
+      {
+        validate_usage(this);
+        return validate_usage.published() ? final_digest : data.digest();
       }
 
     /// @brief Immutable operation. Returns number of characters in all chunks.
@@ -190,7 +415,7 @@ namespace dibase { namespace blog {
     /// @throws dibase::blog::sies::call_context_violation if called by
     ///         thread other than the creator thread while the object
     ///         is still being setup and is still mutable.
-      chunk_size_type  char_count() const
+      total_size_type  char_count() const
       {
         validate_usage(this);
         return validate_usage.published() ? final_char_count
@@ -203,7 +428,7 @@ namespace dibase { namespace blog {
     /// @throws dibase::blog::sies::call_context_violation if called by
     ///         thread other than the creator thread while the object
     ///         is still being setup and is still mutable.
-      chunk_size_type  word_count() const
+      total_size_type  word_count() const
       {
         validate_usage(this);
         return validate_usage.published() ? final_word_count
@@ -211,16 +436,57 @@ namespace dibase { namespace blog {
                                           ;
       }
 
+    /// @brief Immutable operation. Returns number of characters in a range
+    /// of chunks.
+    /// @param first        Index of first chunk in range.
+    /// @param count        Number of chunks in range.
+    /// @returns Cumulative number of characters in the chunks in the range.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+      total_size_type  char_count
+      ( chunk_index_type first
+      , chunk_count_type count
+      ) const
+      {
+        validate_usage(this);
+        return compacted ? compacted->view().char_count(first, count)
+                         : data.char_count(first, count);
+      }
+
+    /// @brief Immutable operation. Returns number of words in a range of
+    /// chunks.
+    /// @param first        Index of first chunk in range.
+    /// @param count        Number of chunks in range.
+    /// @returns Cumulative number of words in the chunks in the range.
+    /// @throws std::out_of_range if the range extends beyond the value
+    ///         returned by number_of_chunks.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+      total_size_type  word_count
+      ( chunk_index_type first
+      , chunk_count_type count
+      ) const
+      {
+        validate_usage(this);
+        return compacted ? compacted->view().word_count(first, count)
+                         : data.word_count(first, count);
+      }
+
     /// @brief Immutable operation. Returns occurrence of character in all chunks
     /// @param chr          Character to return occurrence for.
     /// @returns Cumulative occurrence of chr in all chunks.
     /// @throws dibase::blog::sies::call_context_violation if called by
     ///         thread other than the creator thread while the object
     ///         is still being setup and is still mutable.
-      chunk_size_type  char_occurrence(char chr) const
+      total_size_type  char_occurrence(char chr) const
       {
         validate_usage(this);
-        return data.char_occurrence(chr); 
+        return compacted ? compacted->view().char_occurrence(chr)
+                         : data.char_occurrence(chr); 
       }
 
     /// @brief Immutable operation. Returns occurrence of a word in all chunks
@@ -229,12 +495,62 @@ namespace dibase { namespace blog {
     /// @throws dibase::blog::sies::call_context_violation if called by
     ///         thread other than the creator thread while the object
     ///         is still being setup and is still mutable.
-      chunk_size_type  word_occurrence(std::string const & word) const
+      total_size_type  word_occurrence(std::string const & word) const
       {
         validate_usage(this);
-        return data.word_occurrence(word); 
+        return compacted ? compacted->view().word_occurrence(word)
+                         : data.word_occurrence(word); 
+      }
+
+    /// @brief Immutable operation. Returns the number of chunks, character
+    /// and word counts and the results of a set of queries, validating the
+    /// call context once and gathering them in a single pass over the chunks.
+    /// @param query        Character and word occurrences to return and
+    ///                     whether to return the text.
+    /// @returns Statistics of all chunks: as returned by number_of_chunks,
+    ///          char_count, word_count, char_occurrence and word_occurrence
+    ///          for each of the query's characters and words and, if
+    ///          requested, text.
+    /// @throws dibase::blog::sies::call_context_violation if called by
+    ///         thread other than the creator thread while the object
+    ///         is still being setup and is still mutable.
+      stats_type stats(text_stats_query const & query) const
+      {
+        validate_usage(this);
+        if (!compacted)
+          {
+            return data.stats(query);
+          }
+        auto const & view(compacted->view());
+        stats_type result;
+        result.number_of_chunks = view.number_of_chunks();
+        result.char_count = final_char_count;
+        result.word_count = final_word_count;
+        result.char_occurrences.reserve(query.chars.size());
+        for (auto chr : query.chars)
+          {
+            result.char_occurrences.push_back(view.char_occurrence(chr));
+          }
+        result.word_occurrences.reserve(query.words.size());
+        for (auto const & word : query.words)
+          {
+            result.word_occurrences.push_back(view.word_occurrence(word));
+          }
+        if (query.include_text)
+          {
+            result.text = view.text();
+          }
+        return result;
       }
     };
+
+  /// @brief Shared Immutable, Exclusive Setup wrapper around text_info object
+    template 
+    < template <class T, std::memory_order...> class SyncPolicy
+    , std::memory_order... M
+    >
+    using text_registry
+              = basic_text_registry<text_info, SyncPolicy, M...>;
   } // namespace sies
 }} // namespaces dibase::blog
 #endif // DIBASE_BLOG_SIES_TEXT_REGISRTY_H
@@ -0,0 +1,239 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file tokenizers.h
+/// @brief Tokenizer policies splitting text_info chunks into words.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// A tokenizer policy is a type providing static member functions:
+///
+///     bool is_word_char(char chr);
+///     std::size_t find_word_start(char const * text, std::size_t size, std::size_t pos);
+///     std::size_t find_word_end(char const * text, std::size_t size, std::size_t pos);
+///
+/// A word is a maximal run of word characters. find_word_start returns the
+/// position of the first word character at or after pos, find_word_end the
+/// position of the first non-word character at or after pos, either
+/// returning size if there is none.
+///
+/// Word character classes are types with a constexpr static member function
+/// is_word_char(unsigned char) from which basic_tokenizer generates a 256
+/// entry table at compile time, so classifying a character is a single
+/// inlined table lookup.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_TOKENIZERS_H
+# define DIBASE_BLOG_SIES_TOKENIZERS_H
+# include "text_kernels.h"
+# include <cstddef>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Characters separating words for separator_word_chars, as UTF-8,
+  /// so the bytes 0xC2, 0xA3 and 0xAC of '£' and '¬' also separate words.
+    constexpr char WordSeparatorChars[]
+                            = " \t\n\r!\"£$%^&*()_-+={}[]:;@'#~?/>.<,\\|¬`";
+
+    namespace char_class
+    {
+    /// @brief Compile time sequence of indices.
+      template <std::size_t... I>
+      struct indices {};
+
+    /// @brief Appends Second's indices, offset by the size of First, to First.
+      template <class First, class Second>
+      struct join_indices;
+
+      template <std::size_t... I, std::size_t... J>
+      struct join_indices<indices<I...>, indices<J...>>
+      {
+        typedef indices<I..., (sizeof...(I)+J)...> type;
+      };
+
+    /// @brief Makes indices<0,...,N-1>. Halves N at each step so the
+    /// instantiation depth is logarithmic in N.
+      template <std::size_t N>
+      struct make_indices
+      : join_indices< typename make_indices<N/2U>::type
+                    , typename make_indices<N-N/2U>::type
+                    >
+      {};
+
+      template <>
+      struct make_indices<0U>
+      {
+        typedef indices<> type;
+      };
+
+      template <>
+      struct make_indices<1U>
+      {
+        typedef indices<0U> type;
+      };
+
+    /// @brief Returns true if chr is in the zero terminated set.
+      constexpr bool in_set(char const * set, unsigned char chr)
+      {
+        return *set!='\0'
+            && (static_cast<unsigned char>(*set)==chr || in_set(set+1, chr));
+      }
+
+    /// @brief Returns true if chr is one of [0-9][A-Z][a-z].
+      constexpr bool is_ascii_alnum(unsigned char chr)
+      {
+        return ('0'<=chr && chr<='9')
+            || ('A'<=chr && chr<='Z')
+            || ('a'<=chr && chr<='z');
+      }
+
+    /// @brief Compile time list of characters.
+      template <char... C>
+      struct char_list;
+
+      template <>
+      struct char_list<>
+      {
+        static constexpr bool contains(unsigned char) { return false; }
+      };
+
+      template <char Head, char... Tail>
+      struct char_list<Head, Tail...>
+      {
+        static constexpr bool contains(unsigned char chr)
+        {
+          return static_cast<unsigned char>(Head)==chr
+              || char_list<Tail...>::contains(chr);
+        }
+      };
+
+    /// @brief Word character table, indexed by char value as unsigned char,
+    /// generated at compile time from WordChars::is_word_char.
+      template < class WordChars
+               , class Indices = typename make_indices<256U>::type
+               >
+      struct table;
+
+      template <class WordChars, std::size_t... I>
+      struct table<WordChars, indices<I...>>
+      {
+        static constexpr bool is_word_char[sizeof...(I)]
+                      = { WordChars::is_word_char(static_cast<unsigned char>(I))... };
+      };
+
+      template <class WordChars, std::size_t... I>
+      constexpr bool table<WordChars, indices<I...>>::is_word_char[sizeof...(I)];
+    } // namespace char_class
+
+  /// @brief Word characters: all but those of WordSeparatorChars.
+  /// Note that this includes control characters and most non-ASCII bytes.
+    struct separator_word_chars
+    {
+      static constexpr bool is_word_char(unsigned char chr)
+      {
+        return !char_class::in_set(WordSeparatorChars, chr);
+      }
+    };
+
+  /// @brief Word characters: [0-9][A-Z][a-z].
+    struct ascii_alnum_word_chars
+    {
+      static constexpr bool is_word_char(unsigned char chr)
+      {
+        return char_class::is_ascii_alnum(chr);
+      }
+    };
+
+  /// @brief Word characters: [0-9][A-Z][a-z] plus the Extra characters.
+    template <char... Extra>
+    struct ascii_alnum_plus_word_chars
+    {
+      static constexpr bool is_word_char(unsigned char chr)
+      {
+        return char_class::is_ascii_alnum(chr)
+            || char_class::char_list<Extra...>::contains(chr);
+      }
+    };
+
+  /// @brief Word characters: [0-9][A-Z][a-z] and apostrophe, so contractions
+  /// such as "don't" are single words.
+    typedef ascii_alnum_plus_word_chars<'\''>   alnum_apostrophe_word_chars;
+
+  /// @brief Tokenizer policy classifying characters with a compile time
+  /// generated table.
+  /// @param WordChars  Word character class.
+    template <class WordChars>
+    struct basic_tokenizer
+    {
+      static bool is_word_char(char chr)
+      {
+        return char_class::table<WordChars>::is_word_char
+                                          [static_cast<unsigned char>(chr)];
+      }
+
+      static std::size_t find_word_start
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        while (pos<size && !is_word_char(text[pos]))
+          {
+            ++pos;
+          }
+        return pos;
+      }
+
+      static std::size_t find_word_end
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        while (pos<size && is_word_char(text[pos]))
+          {
+            ++pos;
+          }
+        return pos;
+      }
+    };
+
+    typedef basic_tokenizer<ascii_alnum_word_chars>       ascii_alnum_tokenizer;
+    typedef basic_tokenizer<alnum_apostrophe_word_chars>  alnum_apostrophe_tokenizer;
+
+  /// @brief Default tokenizer policy: words are runs of characters other than
+  /// WordSeparatorChars, as split by split_next_word.
+  ///
+  /// Uses the run time selected text kernels (see text_kernels.h) to scan
+  /// for word boundaries many bytes at a time.
+    struct separator_tokenizer
+    {
+      static bool is_word_char(char chr)
+      {
+        return basic_tokenizer<separator_word_chars>::is_word_char(chr);
+      }
+
+      static std::size_t find_word_start
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return active_text_kernels().find_word_start(text, size, pos);
+      }
+
+      static std::size_t find_word_end
+      ( char const * text
+      , std::size_t size
+      , std::size_t pos
+      )
+      {
+        return active_text_kernels().find_word_end(text, size, pos);
+      }
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_TOKENIZERS_H
@@ -0,0 +1,188 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file worker_pool.cpp
+/// @brief Fixed pool of worker threads running parallel loops.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#include "worker_pool.h"
+
+#include <atomic>
+#include <exception>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+    namespace
+    {
+    /// @brief True on a thread while it runs a parallel_for function.
+      thread_local bool in_parallel_for{false};
+    } // namespace
+
+  /// @brief One parallel_for call's shared state. Shared by the caller and
+  /// the workers so workers may finish with it after the caller returns.
+    struct worker_pool::job
+    {
+      std::function<void(std::size_t)> const & fn;
+      std::size_t               count;
+      std::atomic<std::size_t>  next;
+      std::mutex                mutex;      ///< Protects following members.
+      std::condition_variable   all_done;
+      std::size_t               done;
+      std::exception_ptr        error;
+
+      job(std::function<void(std::size_t)> const & f, std::size_t n)
+      : fn(f)
+      , count{n}
+      , next{0U}
+      , done{0U}
+      {}
+
+    /// @brief Runs fn for unclaimed indexes until none remain.
+      void run()
+      {
+        std::size_t ran{0U};
+        std::exception_ptr caught;
+        in_parallel_for = true;
+        for (auto i(next++); i<count; i=next++)
+          {
+            try
+              {
+                fn(i);
+              }
+            catch (...)
+              {
+                caught = std::current_exception();
+              }
+            ++ran;
+          }
+        in_parallel_for = false;
+        if (ran!=0U)
+          {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (caught && !error)
+              {
+                error = caught;
+              }
+            done += ran;
+            if (done==count)
+              {
+                all_done.notify_all();
+              }
+          }
+      }
+    };
+
+    worker_pool::worker_pool(std::size_t number_of_workers)
+    : generation{0U}
+    , stopping{false}
+    {
+      workers.reserve(number_of_workers);
+      for (std::size_t i{0U}; i!=number_of_workers; ++i)
+        {
+          workers.emplace_back(&worker_pool::work, this);
+        }
+    }
+
+    worker_pool::~worker_pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+      }
+      work_available.notify_all();
+      for (auto & worker : workers)
+        {
+          worker.join();
+        }
+    }
+
+    void worker_pool::work()
+    {
+      std::uint64_t seen{0U};
+      for (;;)
+        {
+          std::shared_ptr<job> j;
+          {
+            std::unique_lock<std::mutex> lock{mutex};
+            work_available.wait( lock
+                               , [this, seen]()
+                                 {
+                                   return stopping || generation!=seen;
+                                 }
+                               );
+            if (stopping)
+              {
+                return;
+              }
+            seen = generation;
+            j = current;
+          }
+          if (j)
+            {
+              j->run();
+            }
+        }
+    }
+
+    void worker_pool::parallel_for
+    ( std::size_t count
+    , std::function<void(std::size_t)> const & fn
+    )
+    {
+      auto run_serially([count, &fn]()
+                        {
+                          for (std::size_t i{0U}; i!=count; ++i)
+                            {
+                              fn(i);
+                            }
+                        });
+      if (workers.empty() || count<2U || in_parallel_for)
+        {
+          run_serially();
+          return;
+        }
+    // Rather than wait for another thread's call, which may be long, run
+    // serially if the pool is busy.
+      std::unique_lock<std::mutex> run_lock{run_mutex, std::try_to_lock};
+      if (!run_lock.owns_lock())
+        {
+          run_serially();
+          return;
+        }
+      auto j(std::make_shared<job>(fn, count));
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        current = j;
+        ++generation;
+      }
+      work_available.notify_all();
+      j->run();
+      {
+        std::unique_lock<std::mutex> lock{j->mutex};
+        j->all_done.wait(lock, [&j]() { return j->done==j->count; });
+      }
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        current.reset();
+      }
+      if (j->error)
+        {
+          std::rethrow_exception(j->error);
+        }
+    }
+
+    worker_pool & worker_pool::shared()
+    {
+      static worker_pool pool{ std::thread::hardware_concurrency()>1U
+                             ? std::thread::hardware_concurrency()-1U
+                             : 0U
+                             };
+      return pool;
+    }
+  } // namespace sies
+}} // namespaces dibase::blog
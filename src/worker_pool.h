@@ -0,0 +1,143 @@
+// Project: Shared immutable, exclusive setup blog support code C++ library
+/// @file worker_pool.h
+/// @brief Fixed pool of worker threads running parallel loops.
+///
+/// Code accompanying the
+/// "Comments on comments to Herb Sutter's updated GotW #6b solution" series of
+/// Dibase blog postings.
+///
+/// @copyright Copyright (c) Dibase Limited 2013
+/// @author Ralph E. McArdell
+
+#ifndef DIBASE_BLOG_SIES_WORKER_POOL_H
+# define DIBASE_BLOG_SIES_WORKER_POOL_H
+# include <functional>
+# include <algorithm>
+# include <condition_variable>
+# include <mutex>
+# include <thread>
+# include <memory>
+# include <vector>
+# include <cstddef>
+# include <cstdint>
+
+namespace dibase { namespace blog {
+  namespace sies // Shared Immutable, Exclusive Setup
+  {
+  /// @brief Fixed size pool of worker threads executing parallel loops.
+  ///
+  /// A parallel_for call runs a function for each index of a range, the
+  /// calling thread working alongside the pool's workers, and returns once
+  /// all have been run. The pool runs one call at a time: a call made while
+  /// the pool runs another thread's call is run by the calling thread alone
+  /// rather than waiting. A parallel_for called by a function run by a
+  /// parallel_for is also run by the calling thread alone, so nested
+  /// parallel loops do not deadlock.
+    class worker_pool
+    {
+      struct job;
+
+      std::mutex                run_mutex;  ///< Held by the running call.
+      std::mutex                mutex;      ///< Protects following members.
+      std::condition_variable   work_available;
+      std::shared_ptr<job>      current;
+      std::uint64_t             generation;
+      bool                      stopping;
+      std::vector<std::thread>  workers;
+
+      void work();
+
+    /// @brief Returns first index of part of [0, count) split into parts
+    /// parts of sizes differing by at most one.
+      static std::size_t part_start
+      ( std::size_t count
+      , std::size_t parts
+      , std::size_t part
+      )
+      {
+        return count/parts*part + std::min(part, count%parts);
+      }
+
+    public:
+    /// @brief Construct with a number of worker threads.
+    /// @param number_of_workers  Number of threads started. A pool of no
+    ///                           workers runs parallel_for on the calling
+    ///                           thread.
+      explicit worker_pool(std::size_t number_of_workers);
+
+    /// @brief Stops and joins the worker threads.
+      ~worker_pool();
+
+      worker_pool(worker_pool const &) = delete;
+      worker_pool(worker_pool &&) = delete;
+      worker_pool & operator=(worker_pool const &) = delete;
+      worker_pool & operator=(worker_pool &&) = delete;
+
+    /// @brief Returns the number of worker threads.
+      std::size_t size() const { return workers.size(); }
+
+    /// @brief Returns number of threads running a parallel_for: the workers
+    /// and the calling thread.
+      std::size_t concurrency() const { return workers.size()+1U; }
+
+    /// @brief Calls fn(i) for each i in [0, count), in parallel.
+    /// @param count  Number of indexes.
+    /// @param fn     Function called for each index.
+    /// @throws Any exception thrown by fn, after all calls have completed. If
+    ///         several calls throw, the exception of one of them.
+      void parallel_for
+      ( std::size_t count
+      , std::function<void(std::size_t)> const & fn
+      );
+
+    /// @brief Reduces [0, count) by splitting it into a sub-range per
+    /// thread, calling range_fn for each sub-range in parallel and combining
+    /// the results in sub-range order.
+    /// @param count    Number of indexes.
+    /// @param identity Value combined with the first sub-range's result.
+    /// @param range_fn Called as range_fn(first, count) for a sub-range,
+    ///                 returning the sub-range's result. Called for the whole
+    ///                 range if it is not split.
+    /// @param combine  Called as combine(lhs, rhs) to combine results.
+    /// @returns Combined result.
+    /// @throws Any exception thrown by range_fn or combine.
+      template <typename T, typename RangeFn, typename Combine>
+      T parallel_reduce
+      ( std::size_t count
+      , T const & identity
+      , RangeFn const & range_fn
+      , Combine const & combine
+      )
+      {
+        std::size_t const parts{std::min(concurrency(), count)};
+        if (parts<2U)
+          {
+            return combine(identity, range_fn(std::size_t{0U}, count));
+          }
+        std::vector<T> partial(parts, identity);
+        parallel_for( parts
+                    , [&](std::size_t part)
+                      {
+                        auto first(part_start(count, parts, part));
+                        partial[part] = range_fn
+                                          ( first
+                                          , part_start(count, parts, part+1U)
+                                              - first
+                                          );
+                      }
+                    );
+        T result(identity);
+        for (auto const & r : partial)
+          {
+            result = combine(result, r);
+          }
+        return result;
+      }
+
+    /// @brief Returns process wide pool having a worker for each hardware
+    /// thread but one, started on first use.
+      static worker_pool & shared();
+    };
+  } // namespace sies
+}} // namespaces dibase::blog
+#endif // DIBASE_BLOG_SIES_WORKER_POOL_H